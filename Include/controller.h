@@ -11,6 +11,7 @@
 #include "trace.h"
 #include "hid.h"
 #include "spb.h"
+#include "resolutions.h"
 
 //
 // Memory tags
@@ -18,6 +19,7 @@
 #define TOUCH_POOL_TAG                  (ULONG)'cuoT'
 #define TOUCH_POOL_TAG_F12              (ULONG)'21oT'
 #define TOUCH_POWER_POOL_TAG            (ULONG)'PuoT'
+#define TOUCH_REPORT_POOL_TAG           (ULONG)'RuoT'
 
 //
 // Constants
@@ -26,6 +28,15 @@
 #define MAX_TOUCH_COORD                 0x0FFF
 #define FINGER_STATUS                   0x01 // finger down
 
+//
+// Controller family limits. FocalTech touch IDs are 4 bits wide with 0xF
+// marking an unused record, and a frame holds up to 10 records. Only the
+// FT5x46 fills all 10, an unidentified controller is read as the 6
+// record frame this driver was first sized for.
+//
+#define TOUCH_MAX_CONTACT_SLOTS         16
+#define TOUCH_MAX_FRAME_CONTACTS        10
+
 //
 // Structures
 //
@@ -204,12 +215,58 @@ typedef struct _TOUCH_SCREEN_SETTINGS
 	UINT32 Vendor03AbsSenseRawCapMinLimit;
 	UINT32 Vendor03AbsSenseRawCapMaxLimit;
 	UINT32 Vendor03IncludeShortTest;
+	UINT32 AdaptiveFrameRead;
+	UINT32 AsyncFrameRead;
+	UINT32 ParallelReportMode;
+	UINT32 CoalesceInterrupts;
+	UINT32 StationaryThreshold;
+	UINT32 StationaryKeepaliveMs;
+	UINT32 MonitorIdleTimeoutMs;
+	UINT32 WakeupGestureMask;
+	UINT32 FrameRecorderEnabled;
+	UINT32 InterruptWatchdogMs;
+	UINT32 ServiceThreadEnabled;
+	UINT32 ServiceThreadPriority;
+	UINT32 ServiceThreadAffinityMask;
+	UINT32 CtrlRegister;
+	UINT32 TimeEnterMonitorRegister;
+	UINT32 PeriodActiveRegister;
+	UINT32 PeriodMonitorRegister;
+	UINT32 InterruptModeRegister;
 } TOUCH_SCREEN_SETTINGS, * PTOUCH_SCREEN_SETTINGS;
 
+//
+// Optional REG_BINARY value under TOUCH_REG_KEY holding the controller
+// settings followed by the registry-backed part of the screen properties.
+// It is taken instead of the per-value tables only if its header matches
+// this build's layout, so any change to either structure invalidates it.
+//
+#define TOUCH_CONFIGURATION_BLOB_VALUE      L"ConfigurationBlob"
+#define TOUCH_CONFIGURATION_BLOB_SIGNATURE  (ULONG)'BCuT'
+#define TOUCH_CONFIGURATION_BLOB_VERSION    1
+
+#define TOUCH_CONFIGURATION_BLOB_PROPERTIES_SIZE \
+	FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, Transform)
+
+typedef struct _TOUCH_CONFIGURATION_BLOB_HEADER
+{
+	ULONG Signature;
+	USHORT Version;
+	USHORT HeaderSize;
+	ULONG SettingsSize;
+	ULONG PropertiesSize;
+} TOUCH_CONFIGURATION_BLOB_HEADER;
+
+#define TOUCH_CONFIGURATION_BLOB_SIZE \
+	(ULONG)(sizeof(TOUCH_CONFIGURATION_BLOB_HEADER) + \
+	 sizeof(TOUCH_SCREEN_SETTINGS) + \
+	 TOUCH_CONFIGURATION_BLOB_PROPERTIES_SIZE)
+
 NTSTATUS 
 TchAllocateContext(
     OUT VOID **ControllerContext,
-    IN WDFDEVICE FxDevice
+    IN WDFDEVICE FxDevice,
+    IN const TOUCH_CONFIGURATION_BLOB_HEADER *ConfigurationBlob OPTIONAL
     );
 
 NTSTATUS 
@@ -233,7 +290,9 @@ NTSTATUS
 TchStandbyDevice(
 	IN VOID* ControllerContext,
 	IN SPB_CONTEXT* SpbContext,
-	IN VOID* ReportContext
+	IN VOID* ReportContext,
+	IN BOOLEAN RuntimeIdle,
+	IN BOOLEAN Hibernate
 	);
 
 NTSTATUS 
@@ -259,7 +318,26 @@ TchRegistryGetControllerSettings(
 
 VOID
 TchGetTouchSettings(
-	IN PTOUCH_SCREEN_SETTINGS TouchSettings
+	OUT PTOUCH_SCREEN_SETTINGS TouchSettings,
+	IN const TOUCH_CONFIGURATION_BLOB_HEADER* ConfigurationBlob OPTIONAL
+);
+
+TOUCH_CONFIGURATION_BLOB_HEADER*
+TchLoadConfigurationBlob(
+	VOID
+);
+
+VOID
+TchFreeConfigurationBlob(
+	IN TOUCH_CONFIGURATION_BLOB_HEADER* ConfigurationBlob
+);
+
+ULONG
+TchBuildConfigurationBlob(
+	IN PTOUCH_SCREEN_SETTINGS TouchSettings,
+	IN PTOUCH_SCREEN_PROPERTIES Props,
+	OUT PVOID Buffer OPTIONAL,
+	IN ULONG BufferLength
 );
 
 NTSTATUS
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "HidCommon.h"
+
 //
 // Global Data Declarations
 //
@@ -60,9 +62,17 @@ typedef struct _HID_TOUCH_FINGER {
 
 typedef struct _HID_TOUCH_REPORT {
 	HID_TOUCH_FINGER Contacts[2];
+	USHORT           ScanTime;
 	UCHAR            ContactCount;
 } HID_TOUCH_REPORT, * PHID_TOUCH_REPORT;
 
+// REPORTID_FINGER (parallel mode)
+typedef struct _HID_TOUCH_REPORT_PARALLEL {
+	HID_TOUCH_FINGER Contacts[PTP_MAX_CONTACT_POINTS];
+	USHORT           ScanTime;
+	UCHAR            ContactCount;
+} HID_TOUCH_REPORT_PARALLEL, * PHID_TOUCH_REPORT_PARALLEL;
+
 // REPORTID_KEYPAD
 typedef struct _HID_KEY_REPORT {
 	UCHAR  SystemPowerDown : 1;
@@ -98,9 +108,10 @@ typedef struct _HID_INPUT_REPORT
 	UCHAR ReportID;
 	union
 	{
-		HID_TOUCH_REPORT TouchReport;
-		HID_PEN_REPORT   PenReport;
-		HID_KEY_REPORT   KeyReport;
+		HID_TOUCH_REPORT          TouchReport;
+		HID_TOUCH_REPORT_PARALLEL ParallelTouchReport;
+		HID_PEN_REPORT            PenReport;
+		HID_KEY_REPORT            KeyReport;
 	};
 #ifdef _TIMESTAMP_
 	LARGE_INTEGER TimeStamp;
@@ -110,14 +121,130 @@ typedef struct _HID_INPUT_REPORT
 #include <poppack.h>
 #pragma warning(pop)
 
+//
+// Bounded multi-producer/multi-consumer ring of input reports waiting for
+// a HIDClass read request. Every cell carries a sequence number so
+// producers and consumers claim cells with a single interlocked operation
+// on their position and never block each other.
+//
+#define HID_REPORT_RING_SIZE    16
+#define HID_REPORT_RING_MASK    (HID_REPORT_RING_SIZE - 1)
+
+//
+// Slots kept free for reports that must not be lost (lift-ups, pen and
+// keypad state changes). Once the ring fills past this point the oldest
+// move-only finger frames are coalesced away, all of their reports at
+// once, as the newer frames supersede them.
+//
+#define HID_REPORT_RING_RESERVE 4
+
+C_ASSERT((HID_REPORT_RING_SIZE & HID_REPORT_RING_MASK) == 0);
+C_ASSERT(HID_REPORT_RING_RESERVE < HID_REPORT_RING_SIZE);
+
+//
+// The reports of a frame take consecutive cells. FrameReports is the
+// number of reports of the frame in its first cell and 0 in the others,
+// Coalescable is set in every cell of a move-only frame.
+//
+typedef struct _HID_REPORT_RING_CELL
+{
+	volatile LONG Sequence;
+	UCHAR FrameReports;
+	BOOLEAN Coalescable;
+	HID_INPUT_REPORT Report;
+} HID_REPORT_RING_CELL, * PHID_REPORT_RING_CELL;
+
+typedef struct _HID_REPORT_RING
+{
+	volatile LONG EnqueuePosition;
+	volatile LONG DequeuePosition;
+	volatile LONG DrainRequests;
+	volatile LONG CoalescedReports;
+	volatile LONG DroppedReports;
+	HID_REPORT_RING_CELL Cells[HID_REPORT_RING_SIZE];
+} HID_REPORT_RING, * PHID_REPORT_RING;
+
+//
+// Context of every request the framework hands the driver. For HIDClass
+// read requests, Report is the output buffer, validated once when
+// TchReadReport parks the request, which reports are written into.
+//
+typedef struct _HID_READ_REQUEST_CONTEXT
+{
+	PHID_INPUT_REPORT Report;
+} HID_READ_REQUEST_CONTEXT, * PHID_READ_REQUEST_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(HID_READ_REQUEST_CONTEXT, GetReadRequestContext)
+
+//
+// The report descriptor handed to HIDClass, built from one of the templates
+// when the hardware is prepared. The offsets of the values patched into the
+// template are found once per template, later builds only rewrite them.
+//
+#define HID_REPORT_DESCRIPTOR_MAX_LENGTH    1536
+#define HID_REPORT_DESCRIPTOR_MAX_PATCHES   64
+
+typedef enum _HID_REPORT_DESCRIPTOR_PATCH_KIND
+{
+	HidPatchLogicalWidth,
+	HidPatchLogicalHeight,
+	HidPatchPhysicalWidth,
+	HidPatchPhysicalHeight,
+	HidPatchMaximumContacts
+} HID_REPORT_DESCRIPTOR_PATCH_KIND;
+
+typedef struct _HID_REPORT_DESCRIPTOR_PATCH
+{
+	USHORT Offset;
+	USHORT Kind;
+} HID_REPORT_DESCRIPTOR_PATCH;
+
+typedef struct _HID_REPORT_DESCRIPTOR_CACHE
+{
+	const UCHAR* Template;
+	ULONG Length;
+	ULONG PatchCount;
+	HID_REPORT_DESCRIPTOR_PATCH Patches[HID_REPORT_DESCRIPTOR_MAX_PATCHES];
+
+	//
+	// Values the descriptor was last built with
+	//
+	BOOLEAN Built;
+	USHORT Values[HidPatchMaximumContacts + 1];
+
+	UCHAR Descriptor[HID_REPORT_DESCRIPTOR_MAX_LENGTH];
+} HID_REPORT_DESCRIPTOR_CACHE, * PHID_REPORT_DESCRIPTOR_CACHE;
+
 //
 // Function prototypes
 //
 
+VOID
+TchInitializeReportRing(
+	IN PHID_REPORT_RING ReportRing
+);
+
+VOID
+TchDrainReportRing(
+	IN WDFQUEUE PingPongQueue,
+	IN PHID_REPORT_RING ReportRing
+);
+
 NTSTATUS
 TchSendReport(
 	IN WDFQUEUE PingPongQueue,
-	IN PHID_INPUT_REPORT hidReportFromDriver
+	IN PHID_REPORT_RING ReportRing,
+	IN PHID_INPUT_REPORT hidReportFromDriver,
+	IN BOOLEAN Coalescable
+);
+
+NTSTATUS
+TchSendReportFrame(
+	IN WDFQUEUE PingPongQueue,
+	IN PHID_REPORT_RING ReportRing,
+	IN PHID_INPUT_REPORT Reports,
+	IN ULONG ReportCount,
+	IN BOOLEAN Coalescable
 );
 
 NTSTATUS
@@ -131,6 +258,16 @@ TchGetFeatureReport(
     IN WDFREQUEST Request
     );
 
+NTSTATUS
+TchBuildReportDescriptor(
+    IN WDFDEVICE Device
+    );
+
+UCHAR
+TchGetMaximumContacts(
+    IN WDFDEVICE Device
+    );
+
 NTSTATUS
 TchGetHidDescriptor(
     IN WDFDEVICE Device,
@@ -172,7 +309,6 @@ TchReadReport(
 //
 // HID collections
 // 
-#include "HidCommon.h"
 
 #define X_MASK 0xFE, 0xFE
 #define Y_MASK 0xFD, 0xFD
@@ -378,6 +514,23 @@ TchReadReport(
 		FEATURE, 0x02, /* Feature: (Data, Var, Abs) */ \
 	END_COLLECTION /* End Collection */
 
+//
+// Time of the frame in 100us units, wrapping at 16 bits. Every report of
+// a frame carries the same value.
+//
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_SCAN_TIME \
+	UNIT_EXPONENT, 0x0C, /* Unit Exponent (-4) */ \
+	UNIT_2, 0x01, 0x10, /* Unit (System: SI Linear, Time: Seconds) */ \
+	LOGICAL_MAXIMUM_3, 0xFF, 0xFF, 0x00, 0x00, /* Logical Maximum (65535) */ \
+	PHYSICAL_MAXIMUM_3, 0xFF, 0xFF, 0x00, 0x00, /* Physical Maximum (65535) */ \
+	USAGE, 0x56, /* Usage (Scan Time) */ \
+	REPORT_SIZE, 0x10, /* Report Size (16) */ \
+	REPORT_COUNT, 0x01, /* Report Count (1) */ \
+	INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
+	PHYSICAL_MAXIMUM, 0x00, /* Physical Maximum: 0 */ \
+	UNIT_EXPONENT, 0x00, /* Unit exponent: 0 */ \
+	UNIT, 0x00 /* Unit: None */
+
 #define FOCALTECH_FT5X_DIGITIZER_FINGER \
 	USAGE_PAGE, 0x0D, /* Usage Page (Digitizer) */ \
 	USAGE, 0x04, /* Usage (Touch Screen) */ \
@@ -388,7 +541,9 @@ TchReadReport(
 		USAGE, 0x00, /* Usage (Undefined) */ \
 		FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_2, /* Finger Contact (2) */ \
 		USAGE_PAGE, 0x0D, /* Usage Page (Digitizer) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_SCAN_TIME, /* Scan Time */ \
 		USAGE, 0x54, /* Usage (Contact Count) */ \
+		LOGICAL_MAXIMUM, 0x7F, /* Logical Maximum (127) */ \
 		REPORT_SIZE, 0x08, /* Report Size (8) */ \
 		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
 		REPORT_ID, REPORTID_DEVICE_CAPS, /* Report ID (8) */ \
@@ -405,6 +560,51 @@ TchReadReport(
 		FEATURE, 0x02, \
 	END_COLLECTION /* End Collection */
 
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT \
+	USAGE_PAGE, 0x0D, /* Usage Page (Digitizer) */ \
+	USAGE, 0x22, /* Usage (Finger) */ \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_2
+
+//
+// Parallel mode: every contact of a frame is carried in a single input
+// report, so one frame costs one IOCTL_HID_READ_REPORT completion.
+//
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL \
+	USAGE_PAGE, 0x0D, /* Usage Page (Digitizer) */ \
+	USAGE, 0x04, /* Usage (Touch Screen) */ \
+	BEGIN_COLLECTION, 0x01, /* Collection (Application) */ \
+		REPORT_ID, REPORTID_FINGER, /* Report ID (1) */ \
+		USAGE, 0x22, /* Usage (Finger) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_1, /* Finger Contact (1) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT, /* Finger Contact (2) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT, /* Finger Contact (3) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT, /* Finger Contact (4) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT, /* Finger Contact (5) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT, /* Finger Contact (6) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT, /* Finger Contact (7) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT, /* Finger Contact (8) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT, /* Finger Contact (9) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL_CONTACT, /* Finger Contact (10) */ \
+		USAGE_PAGE, 0x0D, /* Usage Page (Digitizer) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_SCAN_TIME, /* Scan Time */ \
+		USAGE, 0x54, /* Usage (Contact Count) */ \
+		LOGICAL_MAXIMUM, 0x7F, /* Logical Maximum (127) */ \
+		REPORT_SIZE, 0x08, /* Report Size (8) */ \
+		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
+		REPORT_ID, REPORTID_DEVICE_CAPS, /* Report ID (8) */ \
+		USAGE, 0x55, /* Usage (Maximum Contacts) */ \
+		LOGICAL_MAXIMUM, PTP_MAX_CONTACT_POINTS, /* Logical Maximum (10) */ \
+		FEATURE, 0x02, /* Feature: (Data, Var, Abs) */ \
+		USAGE_PAGE_1, 0x00, 0xff, \
+		REPORT_ID, REPORTID_PTPHQA, \
+		USAGE, 0xc5, \
+		LOGICAL_MINIMUM, 0x00, \
+		LOGICAL_MAXIMUM_2, 0xff, 0x00, \
+		REPORT_SIZE, 0x08, \
+		REPORT_COUNT_2, 0x00, 0x01, \
+		FEATURE, 0x02, \
+	END_COLLECTION /* End Collection */
+
 #define FOCALTECH_FT5X_DIGITIZER_REPORTMODE \
 	USAGE_PAGE, 0x0D, /* Usage Page (Digitizer) */ \
 	USAGE, 0x0E, /* Usage (Configuration) */ \
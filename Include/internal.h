@@ -35,9 +35,21 @@ DEFINE_GUID2(GUID_ACDC_POWER_SOURCE, 0x5D3E9A59, 0xE9D5, 0x4B00, 0xA6, 0xBD, 0xF
 //
 DEFINE_GUID2(GUID_CONSOLE_DISPLAY_STATE, 0x6fe69556, 0x704a, 0x47a0, 0x8f, 0x24, 0xc2, 0x8d, 0x93, 0x6f, 0xda, 0x47);
 
+//
+// Both in microseconds. The reset line is held low for the rail stable
+// time; the delay to communicate is the upper bound on polling the
+// controller for readiness once it is released.
+//
 #define TOUCH_DELAY_TO_COMMUNICATE 200000
 #define TOUCH_POWER_RAIL_STABLE_TIME 2000
 
+//
+// Interval, in 100ns units, at which the lost-interrupt watchdog keeps
+// polling the controller once it found interrupts stalled: about the
+// controller's own report period
+//
+#define TOUCH_WATCHDOG_POLL_INTERVAL 100000
+
 typedef struct _TOUCH_POWER_CONTEXT
 {
     WDFIOTARGET TouchPowerIOTarget;
@@ -46,27 +58,150 @@ typedef struct _TOUCH_POWER_CONTEXT
 } TOUCH_POWER_CONTEXT;
 
 //
-// Device context
+// Settings consumed by callbacks at run time. They are read once and then
+// again whenever their key changes, into the buffer readers are not
+// pointed at, so callbacks read them without registry I/O or a lock.
 //
 
-typedef struct _DEVICE_EXTENSION
+#define TOUCH_WAKEUP_GESTURE_KEY L"\\Registry\\Machine\\SOFTWARE\\OEM\\Nokia\\Touch\\WakeupGesture"
+
+typedef struct _TOUCH_SETTINGS_SNAPSHOT
+{
+    UINT32 WakeupGestureEnabled;
+} TOUCH_SETTINGS_SNAPSHOT;
+
+typedef struct _TOUCH_SETTINGS_WATCH
+{
+    TOUCH_SETTINGS_SNAPSHOT Snapshots[2];
+    volatile LONG Current;
+
+    WDFWAITLOCK Lock;
+    HANDLE Key;
+    IO_STATUS_BLOCK IoStatus;
+    WORK_QUEUE_ITEM WorkItem;
+    volatile LONG Stopping;
+    KEVENT Stopped;
+} TOUCH_SETTINGS_WATCH;
+
+//
+// Raw frame stream into a ring owned by a pending self-test request. The
+// lock is held only to hand the ring between the interrupt routine, which
+// reads frames into it without the lock, and the request's cancellation.
+//
+
+typedef struct _TOUCH_RAW_STREAM
+{
+    WDFSPINLOCK Lock;
+    WDFREQUEST Request;
+    WDFFILEOBJECT FileObject;
+    PUCHAR Slots;
+    volatile LONG* ProducerIndex;
+    volatile LONG* ConsumerIndex;
+    volatile LONG* DroppedFrames;
+    ULONG SlotSize;
+    ULONG SlotCount;
+    ULONG FrameLength;
+    ULONG Produced;
+    ULONG Sequence;
+    UCHAR Address;
+    BOOLEAN InUse;
+    BOOLEAN Canceled;
+} TOUCH_RAW_STREAM;
+
+//
+// Driver-owned thread servicing latched frames in place of the interrupt's
+// work item, at a priority and on processors of the driver's choosing.
+// The ISR latches FramePending and sets Wake.
+//
+
+typedef struct _TOUCH_SERVICE_THREAD
+{
+    PKTHREAD Thread;
+    KEVENT Wake;
+    KPRIORITY Priority;
+    GROUP_AFFINITY Affinity;
+    volatile LONG Stopping;
+} TOUCH_SERVICE_THREAD;
+
+//
+// Device configuration kept out of the way of the members the interrupt
+// path reads. The controller settings are the controller context's.
+//
+
+typedef struct _TOUCH_DEVICE_CONFIGURATION
 {
     //
-    // HID Touch input mode (touch vs. mouse)
-    // 
-    UCHAR InputMode;
+    // Reset GPIO line in case it exists used for power up sequence of the controller
+    //
+    LARGE_INTEGER ResetGpioId;
+    WDFIOTARGET ResetGpio;
+    BOOLEAN HasResetGpio;
 
     //
-    // Device related
+    // HID report descriptor, built in PrepareHardware
+    //
+    HID_REPORT_DESCRIPTOR_CACHE ReportDescriptor;
+
+    //
+    // PoFx
+    //
+    PVOID PoFxPowerSettingCallbackHandle1;
+    PVOID PoFxPowerSettingCallbackHandle2;
+
+    //
+    // Touch Power
+    //
+    TOUCH_POWER_CONTEXT TouchPowerContext;
+} TOUCH_DEVICE_CONFIGURATION;
+
+//
+// Device context
+//
+
+typedef struct _DEVICE_EXTENSION
+{
+    //
+    // Members read on every interrupt lead the extension, the per-frame
+    // report state lives in the separately allocated ReportContext
     //
-    WDFDEVICE FxDevice;
-    WDFQUEUE DefaultQueue;
 
     //
     // Interrupt servicing
     //
     WDFINTERRUPT InterruptObject;
+    VOID *TouchContext;
+    PREPORT_CONTEXT ReportContext;
     BOOLEAN ServiceInterruptsAfterD0Entry;
+
+    //
+    // Interrupt coalescing: the ISR only latches FramePending and the
+    // work item services the latest frame once for all latched interrupts
+    //
+    BOOLEAN CoalesceInterrupts;
+    volatile LONG FramePending;
+    volatile LONG InterruptsReceived;
+    volatile LONG InterruptsCollapsed;
+    volatile LONG FramesServiced;
+
+    //
+    // Optional dedicated thread servicing latched frames
+    //
+    TOUCH_SERVICE_THREAD ServiceThread;
+
+    //
+    // Lost-interrupt watchdog: while contacts are down and no interrupt
+    // arrived for WatchdogTimeout, the timer polls the controller, every
+    // TOUCH_WATCHDOG_POLL_INTERVAL until interrupts come back or the
+    // contacts are up. WatchdogPollTime is the frame time stamped by the
+    // last poll.
+    //
+    WDFTIMER WatchdogTimer;
+    LONG64 WatchdogTimeout;
+    LONG64 WatchdogPollTime;
+    volatile LONG WatchdogArmed;
+    volatile LONG WatchdogStopped;
+    volatile LONG WatchdogStalls;
+    volatile LONG WatchdogPolls;
     
     //
     // Spb (I2C) related members used for the lifetime of the device
@@ -74,11 +209,15 @@ typedef struct _DEVICE_EXTENSION
     SPB_CONTEXT I2CContext;
 
     //
-    // Reset GPIO line in case it exists used for power up sequence of the controller
+    // HID Touch input mode (touch vs. mouse)
+    // 
+    UCHAR InputMode;
+
     //
-    LARGE_INTEGER ResetGpioId;
-    WDFIOTARGET ResetGpio;
-    BOOLEAN HasResetGpio;
+    // Device related
+    //
+    WDFDEVICE FxDevice;
+    WDFQUEUE DefaultQueue;
 
     //
     // Test related
@@ -86,26 +225,17 @@ typedef struct _DEVICE_EXTENSION
     WDFQUEUE TestQueue;
     volatile LONG TestSessionRefCnt;
     BOOLEAN DiagnosticMode;
+    TOUCH_RAW_STREAM RawStream;
 
     // 
     // Power related
     //
     WDFQUEUE IdleQueue;
 
-    //
-    // Touch related members used for the lifetime of the device
-    //
-    VOID *TouchContext;
-
     //
     // Settings
     //
-    TOUCH_SCREEN_SETTINGS TouchSettings;
-
-    //
-    // Report
-    //
-    REPORT_CONTEXT ReportContext;
+    TOUCH_SETTINGS_WATCH SettingsWatch;
 
 	//
 	// PTP New
@@ -113,15 +243,30 @@ typedef struct _DEVICE_EXTENSION
 	BOOLEAN PtpInputOn;
 
     //
-    // PoFx
-    //
-    PVOID PoFxPowerSettingCallbackHandle1;
-    PVOID PoFxPowerSettingCallbackHandle2;
-
-    //
-    // Touch Power
+    // Configuration set up at start and only used again on power
+    // transitions and HIDClass requests
     //
-    TOUCH_POWER_CONTEXT TouchPowerContext;
+    TOUCH_DEVICE_CONFIGURATION Configuration;
 } DEVICE_EXTENSION, *PDEVICE_EXTENSION;
 
 WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(DEVICE_EXTENSION, GetDeviceContext)
+
+NTSTATUS
+TchStartSettingsWatch(
+    IN PDEVICE_EXTENSION DeviceContext
+    );
+
+VOID
+TchStopSettingsWatch(
+    IN PDEVICE_EXTENSION DeviceContext
+    );
+
+FORCEINLINE
+const TOUCH_SETTINGS_SNAPSHOT*
+TchGetSettingsSnapshot(
+    IN PDEVICE_EXTENSION DeviceContext
+    )
+{
+    return &DeviceContext->SettingsWatch.Snapshots[
+        ReadAcquire(&DeviceContext->SettingsWatch.Current) & 1];
+}
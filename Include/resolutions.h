@@ -26,6 +26,68 @@
 #define TOUCH_DEVICE_RESOLUTION_X   1440
 #define TOUCH_DEVICE_RESOLUTION_Y   2560
 
+//
+// Rate in Hz at which the last frame is repeated for panels with
+// TouchHardwareLacksContinuousReporting, when TouchContinuousReportRate
+// is not set or out of range
+//
+#define TOUCH_DEFAULT_CONTINUOUS_REPORT_RATE    60
+#define TOUCH_MAX_CONTINUOUS_REPORT_RATE        1000
+
+//
+// Contact filter defaults, taken when the registry leaves a value at 0.
+// Cutoffs are in mHz, beta raises the cutoff by that many mHz per display
+// pixel per second of contact speed.
+//
+#define TOUCH_FILTER_DEFAULT_MIN_CUTOFF         1000
+#define TOUCH_FILTER_DEFAULT_BETA               7
+#define TOUCH_FILTER_DEFAULT_DERIVATIVE_CUTOFF  1000
+#define TOUCH_FILTER_MAX_CUTOFF                 1000000
+#define TOUCH_FILTER_MAX_BETA                   100000
+#define TOUCH_FILTER_MAX_PREDICTION_US          20000
+
+//
+// Per-axis coordinate transform compiled from the screen properties. The
+// clip stages reduce to max/min pairs and the division by the touch extent
+// becomes a multiply by a 32-bit reciprocal and a shift.
+//
+typedef struct _TOUCH_AXIS_TRANSFORM
+{
+    UINT32 Invert;
+    UINT32 InvertBase;
+    UINT32 ClipLow;
+    UINT32 ClipHigh;
+    UINT32 ClipBias;
+    UINT32 Scale;
+    UINT32 Reciprocal;
+    UINT32 Shift;
+    UINT32 DisplayClipLow;
+    UINT32 DisplayClipHigh;
+    UINT32 DisplayClipBias;
+} TOUCH_AXIS_TRANSFORM, * PTOUCH_AXIS_TRANSFORM;
+
+typedef struct _TOUCH_COORDINATE_TRANSFORM
+{
+    BOOLEAN Compiled;
+    BOOLEAN SwapAxes;
+    TOUCH_AXIS_TRANSFORM X;
+    TOUCH_AXIS_TRANSFORM Y;
+} TOUCH_COORDINATE_TRANSFORM, * PTOUCH_COORDINATE_TRANSFORM;
+
+//
+// Contact filter compiled from the screen properties: a 1 euro low-pass
+// whose cutoff rises with the contact's speed, then an optional
+// constant-velocity extrapolation over Prediction (seconds, Q16)
+//
+typedef struct _TOUCH_CONTACT_FILTER
+{
+    BOOLEAN Enabled;
+    UINT32 MinCutoff;
+    UINT32 Beta;
+    UINT32 DerivativeCutoff;
+    UINT32 Prediction;
+} TOUCH_CONTACT_FILTER, * PTOUCH_CONTACT_FILTER;
+
 typedef struct _TOUCH_SCREEN_PROPERTIES
 {
     UINT32 TouchSwapAxes;
@@ -49,10 +111,35 @@ typedef struct _TOUCH_SCREEN_PROPERTIES
     UINT32 DisplayHeight10um;
     UINT32 DisplayWidth10um;
     UINT32 TouchHardwareLacksContinuousReporting;
+    UINT32 TouchContinuousReportRate;
+    UINT32 TouchFilterEnabled;
+    UINT32 TouchFilterMinCutoffMilliHz;
+    UINT32 TouchFilterBeta;
+    UINT32 TouchFilterDerivativeCutoffMilliHz;
+    UINT32 TouchPredictionUs;
+
+    //
+    // Built by TchGetScreenProperties, not read from the registry
+    //
+    TOUCH_COORDINATE_TRANSFORM Transform;
+    TOUCH_CONTACT_FILTER Filter;
 } TOUCH_SCREEN_PROPERTIES, * PTOUCH_SCREEN_PROPERTIES;
 
+struct _TOUCH_CONFIGURATION_BLOB_HEADER;
+
 VOID
 TchGetScreenProperties(
+	OUT PTOUCH_SCREEN_PROPERTIES Props,
+	IN const struct _TOUCH_CONFIGURATION_BLOB_HEADER* ConfigurationBlob OPTIONAL
+);
+
+VOID
+TchCompileCoordinateTransform(
+	IN PTOUCH_SCREEN_PROPERTIES Props
+);
+
+VOID
+TchCompileContactFilter(
 	IN PTOUCH_SCREEN_PROPERTIES Props
 );
 
@@ -62,3 +149,18 @@ TchTranslateToDisplayCoordinates(
 	IN PUSHORT Y,
 	IN PTOUCH_SCREEN_PROPERTIES Props
 );
+
+VOID
+TchTranslateToDisplayCoordinatesBatch(
+	IN PTOUCH_SCREEN_PROPERTIES Props,
+	IN ULONG Count,
+	IN PUSHORT X,
+	IN PUSHORT Y
+);
+
+VOID
+TchTranslateToDisplayCoordinatesReference(
+	IN PUSHORT X,
+	IN PUSHORT Y,
+	IN PTOUCH_SCREEN_PROPERTIES Props
+);
@@ -35,9 +35,102 @@ typedef struct _SPB_CONTEXT
     LARGE_INTEGER I2cResHubId;
     WDFMEMORY WriteMemory;
     WDFMEMORY ReadMemory;
+    WDFREQUEST WriteRequest;
+    WDFREQUEST ReadRequest;
     WDFWAITLOCK SpbLock;
+    BOOLEAN SequenceSupported;
 } SPB_CONTEXT;
 
+//
+// Single register write, several of them can be sent as one sequence
+//
+
+#define SPB_MAX_REGISTER_WRITES 8
+
+typedef struct _SPB_REGISTER_WRITE
+{
+    UCHAR Address;
+    UCHAR Value;
+} SPB_REGISTER_WRITE;
+
+//
+// One transfer of a batch. Writes carry the register address as the first
+// byte of Buffer, reads name it in Address. The descriptors and buffers
+// must be non-paged as the transfers point into them.
+//
+
+#define SPB_MAX_BATCH_TRANSFERS     256
+
+#define SPB_BATCH_TRANSFER_READ     0
+#define SPB_BATCH_TRANSFER_WRITE    1
+
+typedef struct _SPB_BATCH_TRANSFER
+{
+    ULONG Type;
+    ULONG DelayInUs;
+    UCHAR Address;
+    PUCHAR Buffer;
+    ULONG Length;
+} SPB_BATCH_TRANSFER;
+
+//
+// Asynchronous register read, each instance owns the request and the
+// transfer list it sends so several can be in flight at once
+//
+
+typedef struct _SPB_ASYNC_READ *PSPB_ASYNC_READ;
+
+typedef
+VOID
+SPB_ASYNC_READ_COMPLETION(
+    IN PSPB_ASYNC_READ AsyncRead,
+    IN NTSTATUS Status,
+    IN PVOID Context
+    );
+
+typedef SPB_ASYNC_READ_COMPLETION *PFN_SPB_ASYNC_READ_COMPLETION;
+
+typedef struct _SPB_ASYNC_READ
+{
+    SPB_CONTEXT *SpbContext;
+    WDFREQUEST Request;
+    WDFMEMORY SequenceMemory;
+    PVOID Buffer;
+    ULONG Length;
+    PFN_SPB_ASYNC_READ_COMPLETION Completion;
+    PVOID Context;
+} SPB_ASYNC_READ;
+
+VOID
+SpbAsyncReadDeinitialize(
+    IN SPB_ASYNC_READ *AsyncRead
+    );
+
+NTSTATUS
+SpbAsyncReadInitialize(
+    IN WDFDEVICE FxDevice,
+    IN SPB_CONTEXT *SpbContext,
+    IN SPB_ASYNC_READ *AsyncRead,
+    IN PVOID Buffer,
+    IN ULONG Length,
+    IN PFN_SPB_ASYNC_READ_COMPLETION Completion,
+    IN PVOID Context
+    );
+
+NTSTATUS
+SpbReadDataAsynchronously(
+    IN SPB_ASYNC_READ *AsyncRead,
+    IN UCHAR Address
+    );
+
+NTSTATUS
+SpbExecuteBatchSynchronously(
+    IN SPB_CONTEXT *SpbContext,
+    IN SPB_BATCH_TRANSFER *Transfers,
+    IN ULONG Count,
+    OUT ULONG *Completed
+    );
+
 NTSTATUS 
 SpbReadDataSynchronously(
     _In_ SPB_CONTEXT *SpbContext,
@@ -46,6 +139,14 @@ SpbReadDataSynchronously(
     _In_ ULONG Length
     );
 
+NTSTATUS
+SpbReadDataDirectSynchronously(
+    _In_ SPB_CONTEXT *SpbContext,
+    _In_ UCHAR Address,
+    _Out_writes_bytes_(Length) PVOID Data,
+    _In_ ULONG Length
+    );
+
 VOID
 SpbTargetDeinitialize(
     IN WDFDEVICE FxDevice,
@@ -65,3 +166,10 @@ SpbWriteDataSynchronously(
     IN PVOID Data,
     IN ULONG Length
     );
+
+NTSTATUS
+SpbWriteRegistersSynchronously(
+    IN SPB_CONTEXT *SpbContext,
+    IN const SPB_REGISTER_WRITE *Writes,
+    IN ULONG Count
+    );
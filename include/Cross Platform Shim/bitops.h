@@ -38,4 +38,7 @@ int bitmap_weight(const unsigned long *bitmap, unsigned int bits);
 unsigned long find_first_bit(const unsigned long *addr, unsigned long size);
 unsigned long find_next_bit(const unsigned long *addr, unsigned long size, unsigned long offset);
 
+unsigned long find_first_bit_generic(const unsigned long *addr, unsigned long size);
+unsigned long find_next_bit_generic(const unsigned long *addr, unsigned long size, unsigned long offset);
+
 #endif
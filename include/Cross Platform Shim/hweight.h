@@ -5,6 +5,9 @@
 unsigned int hweight32(unsigned int w);
 ULONGLONG hweight64(ULONGLONG w);
 
+unsigned int hweight32_generic(unsigned int w);
+ULONGLONG hweight64_generic(ULONGLONG w);
+
 static inline unsigned long hweight_long(unsigned long w)
 {
 	return sizeof(w) == 4 ? hweight32(w) : hweight64(w);
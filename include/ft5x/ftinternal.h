@@ -53,6 +53,26 @@ typedef enum _FOCAL_TECH_GESTURE_ID
       FOCAL_TECH_GESTURE_ZOOM_OUT = 0x49
 } FOCAL_TECH_GESTURE_ID;
 
+//
+// Gesture IDs reported in FT5X_REGISTER_GESTURE_ID while the gesture engine
+// runs with the screen off. The bit enabling each in
+// FT5X_REGISTER_GESTURE_MASK is 1 << (ID - FOCAL_TECH_WAKE_GESTURE_FIRST).
+//
+typedef enum _FOCAL_TECH_WAKE_GESTURE_ID
+{
+      FOCAL_TECH_WAKE_GESTURE_SWIPE_LEFT = 0x20,
+      FOCAL_TECH_WAKE_GESTURE_SWIPE_RIGHT = 0x21,
+      FOCAL_TECH_WAKE_GESTURE_SWIPE_UP = 0x22,
+      FOCAL_TECH_WAKE_GESTURE_SWIPE_DOWN = 0x23,
+      FOCAL_TECH_WAKE_GESTURE_DOUBLE_TAP = 0x24
+} FOCAL_TECH_WAKE_GESTURE_ID;
+
+#define FOCAL_TECH_WAKE_GESTURE_FIRST   FOCAL_TECH_WAKE_GESTURE_SWIPE_LEFT
+#define FOCAL_TECH_WAKE_GESTURE_LAST    FOCAL_TECH_WAKE_GESTURE_DOUBLE_TAP
+
+#define FOCAL_TECH_WAKE_GESTURE_MASK_DEFAULT \
+      (1u << (FOCAL_TECH_WAKE_GESTURE_DOUBLE_TAP - FOCAL_TECH_WAKE_GESTURE_FIRST))
+
 typedef enum _FOCAL_TECH_DEVICE_MODE
 {
       FOCAL_TECH_MODE_WORKING = 0,
@@ -67,6 +87,62 @@ typedef enum _FOCAL_TECH_EVENT_FLAG
       FOCAL_TECH_EVENT_NONE = 3
 } FOCAL_TECH_EVENT_FLAG;
 
+//
+// Most contact records any supported controller exposes in its event
+// registers, each variant reads and parses only as many as it has
+//
+#define FT5X_MAX_TOUCH_POINTS           10
+
+#define FT5X_TOUCH_EVENT_PRESS_DOWN     0
+#define FT5X_TOUCH_EVENT_LIFT_UP        1
+#define FT5X_TOUCH_EVENT_CONTACT        2
+#define FT5X_TOUCH_EVENT_NO_EVENT       3
+
+#define FT5X_TOUCH_ID_INVALID           0xF
+
+//
+// Chip ID register, polled to find out when the controller answers
+// after reset or power up. Intervals are in microseconds.
+//
+#define FT5X_REGISTER_CHIP_ID           0xA3
+
+//
+// Configuration registers written at start and restored on wake
+//
+#define FT5X_REGISTER_CTRL              0x86
+#define FT5X_REGISTER_TIME_ENTER_MONITOR 0x87
+#define FT5X_REGISTER_PERIOD_ACTIVE     0x88
+#define FT5X_REGISTER_PERIOD_MONITOR    0x89
+#define FT5X_REGISTER_INTERRUPT_MODE    0xA4
+#define FT5X_REGISTER_FIRMWARE_VERSION  0xA6
+
+//
+// Default of the register settings (CtrlRegister and the like), which
+// hold the raw value of their register. Any value above 0xFF leaves the
+// register at its firmware default.
+//
+#define FT5X_REGISTER_SETTING_UNSET     0xFFFFFFFF
+
+//
+// Power mode register. In monitor mode the controller scans at its
+// monitor period until touched. Only a reset brings the controller out of
+// hibernate, so it is only used where there is a reset line.
+//
+#define FT5X_REGISTER_POWER_MODE        0xA5
+#define FT5X_POWER_MODE_ACTIVE          0
+#define FT5X_POWER_MODE_MONITOR         1
+#define FT5X_POWER_MODE_HIBERNATE       3
+
+//
+// Gesture engine registers
+//
+#define FT5X_REGISTER_GESTURE_ENABLE    0xD0
+#define FT5X_REGISTER_GESTURE_MASK      0xD1
+#define FT5X_REGISTER_GESTURE_MASK_EXT  0xD2
+#define FT5X_REGISTER_GESTURE_ID        0xD3
+#define FT5X_READY_POLL_MIN_INTERVAL    1000
+#define FT5X_READY_POLL_MAX_INTERVAL    8000
+
 typedef struct _FOCAL_TECH_TOUCH_DATA
 {
 	BYTE PositionX_High : 4;
@@ -97,10 +173,68 @@ typedef struct _FOCAL_TECH_EVENT_DATA
 	BYTE NumberOfTouchPoints : 4;
 	BYTE Reserved2 : 4;
 
-	FOCAL_TECH_TOUCH_DATA TouchData[6];
+	FOCAL_TECH_TOUCH_DATA TouchData[FT5X_MAX_TOUCH_POINTS];
 } FOCAL_TECH_EVENT_DATA, * PFOCAL_TECH_EVENT_DATA;
 
-#define TOUCH_POOL_TAG_F12              (ULONG)'21oT'
+//
+// Controller variant picked by chip ID at start. FrameLength covers the
+// frame header and the variant's MaxTouchPoints records, ParseEventData
+// is Ft5xParseEventData specialized for that many records.
+//
+typedef
+VOID
+FT5X_PARSE_EVENT_DATA(
+	IN PFOCAL_TECH_EVENT_DATA EventData,
+	IN PTOUCH_FRAME Frame
+);
+
+typedef FT5X_PARSE_EVENT_DATA* PFT5X_PARSE_EVENT_DATA;
+
+typedef struct _FT5X_VARIANT
+{
+	UCHAR ChipId;
+	UCHAR MaxTouchPoints;
+	ULONG FrameLength;
+	PFT5X_PARSE_EVENT_DATA ParseEventData;
+	PCSTR Name;
+} FT5X_VARIANT;
+
+//
+// Number of frame buffers the asynchronous read pipeline rotates through
+//
+#define FT5X_ASYNC_FRAME_COUNT          2
+
+typedef struct _FT5X_ASYNC_FRAME
+{
+	SPB_ASYNC_READ Read;
+	FOCAL_TECH_EVENT_DATA EventData;
+	LONG Sequence;
+	ULONG64 Timestamp;
+	volatile LONG Busy;
+	struct _FT5X_CONTROLLER_CONTEXT* Controller;
+} FT5X_ASYNC_FRAME;
+
+//
+// Last frames read from the controller, kept for field captures when
+// FrameRecorderEnabled is set. A slot's Sequence is zero while it is
+// being written and otherwise the number of the frame it holds.
+//
+#define FT5X_FRAME_RECORDER_DEPTH       64
+
+typedef struct _FT5X_RECORDED_FRAME
+{
+	ULONG64 Timestamp;
+	volatile LONG Sequence;
+	ULONG Length;
+	FOCAL_TECH_EVENT_DATA EventData;
+} FT5X_RECORDED_FRAME;
+
+typedef struct _FT5X_FRAME_RECORDER
+{
+	BOOLEAN Enabled;
+	volatile LONG Next;
+	FT5X_RECORDED_FRAME Frames[FT5X_FRAME_RECORDER_DEPTH];
+} FT5X_FRAME_RECORDER;
 
 //
 // Logical structure for getting registry config settings
@@ -179,21 +313,87 @@ typedef struct _FT5X_CONFIGURATION
 	UINT32 PepRemovesVoltageInD3;
 } FT5X_CONFIGURATION;
 
+//
+// Register writes built from FT5X_CONFIGURATION by the first successful
+// configuration, replayed as one SPB sequence on later wakes
+//
+typedef struct _FT5X_REGISTER_IMAGE
+{
+	BOOLEAN Valid;
+	UCHAR FirmwareVersion;
+	ULONG Count;
+	SPB_REGISTER_WRITE Writes[SPB_MAX_REGISTER_WRITES];
+} FT5X_REGISTER_IMAGE;
+
 typedef struct _FT5X_CONTROLLER_CONTEXT
 {
 	WDFDEVICE FxDevice;
 	WDFWAITLOCK ControllerLock;
 
 	//
-	// Power state
+	// Power state: D0 operating, D2 left in monitor mode with its
+	// configuration, D3 hibernated. PowerRailOff is set while the rail
+	// was cut since the configuration was last restored.
 	//
 	DEVICE_POWER_STATE DevicePowerState;
+	volatile LONG PowerRailOff;
+
+	//
+	// Controller variant, the generic one until the chip is identified
+	//
+	const FT5X_VARIANT* Variant;
 
 	//
 	// Register configuration programmed to chip
 	//
 	TOUCH_SCREEN_SETTINGS TouchSettings;
 	FT5X_CONFIGURATION Config;
+	FT5X_REGISTER_IMAGE RegisterImage;
+
+	//
+	// Frame buffer filled by the interrupt path, lives in non-paged
+	// pool with the rest of the context
+	//
+	FOCAL_TECH_EVENT_DATA EventData;
+
+	//
+	// Asynchronous frame read pipeline, frames are parsed and reported
+	// from the read completion under AsyncReportLock. The pipeline is
+	// only used when InterruptLatched, set by the device before start.
+	//
+	BOOLEAN InterruptLatched;
+	BOOLEAN AsyncReadEnabled;
+	volatile LONG AsyncReadStopped;
+	volatile LONG AsyncReadPending;
+	volatile LONG AsyncSequence;
+	LONG AsyncReportedSequence;
+	WDFSPINLOCK AsyncReportLock;
+	PREPORT_CONTEXT AsyncReportContext;
+	FT5X_ASYNC_FRAME AsyncFrames[FT5X_ASYNC_FRAME_COUNT];
+
+	//
+	// Raw frame capture
+	//
+	FT5X_FRAME_RECORDER Recorder;
+
+	//
+	// Monitor mode entered after MonitorIdleTimeoutMs without contacts and
+	// left on the next interrupt
+	//
+	WDFTIMER MonitorIdleTimer;
+	SPB_CONTEXT* MonitorSpbContext;
+	LONG64 MonitorIdleTimeout;
+	volatile LONG64 LastContactTime;
+	volatile LONG MonitorIdleTimerArmed;
+	volatile LONG MonitorIdleTimerStopped;
+	volatile LONG MonitorModeActive;
+
+	//
+	// Set while the gesture engine runs, interrupts then only carry a
+	// gesture ID and are not reported to HIDClass
+	//
+	volatile LONG GestureModeActive;
+	UCHAR GestureMask;
 
 	UCHAR Data1Offset;
 
@@ -221,6 +421,18 @@ Ft5xConfigureFunctions(
 	IN SPB_CONTEXT* SpbContext
 );
 
+NTSTATUS
+Ft5xRestoreConfiguration(
+	IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+	IN SPB_CONTEXT* SpbContext
+);
+
+NTSTATUS
+Ft5xWaitForReady(
+	IN SPB_CONTEXT* SpbContext,
+	IN ULONG TimeoutMicroseconds
+);
+
 NTSTATUS
 Ft5xServiceInterrupts(
 	IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
@@ -228,8 +440,65 @@ Ft5xServiceInterrupts(
 	IN PREPORT_CONTEXT ReportContext
 );
 
+NTSTATUS
+Ft5xInitializeAsyncFrameRead(
+	IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+	IN SPB_CONTEXT* SpbContext
+);
+
+VOID
+Ft5xDeinitializeAsyncFrameRead(
+	IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+);
+
+VOID
+Ft5xStopAsyncFrameRead(
+	IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+);
+
+VOID
+Ft5xResumeAsyncFrameRead(
+	IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+);
+
+VOID
+Ft5xParseEventData(
+	IN PFOCAL_TECH_EVENT_DATA EventData,
+	IN PTOUCH_FRAME Frame
+);
+
+const FT5X_VARIANT*
+Ft5xFindVariant(
+	IN UCHAR ChipId
+);
+
+ULONG
+Ft5xCopyRecordedFrames(
+	IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+	OUT FT5X_RECORDED_FRAME* Frames,
+	IN ULONG MaxFrames
+);
+
 #define FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_OPERATING  0
 #define FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_SLEEPING   1
+#define FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_MONITOR    2
+#define FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_HIBERNATE  3
+
+NTSTATUS
+Ft5xInitializeMonitorMode(
+	IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+	IN SPB_CONTEXT* SpbContext
+);
+
+VOID
+Ft5xRestartMonitorIdleTimer(
+	IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+);
+
+VOID
+Ft5xStopMonitorIdleTimer(
+	IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+);
 
 #pragma pack(push)
 #pragma pack(1)
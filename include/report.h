@@ -28,32 +28,81 @@
 #include <HidCommon.h>
 #include <spb.h>
 
-#define MAX_TOUCHES                32
+#define MAX_TOUCHES                TOUCH_MAX_CONTACT_SLOTS
 #define MAX_BUTTONS                3
 
+#define REPORT_DEFAULT_STATIONARY_KEEPALIVE_MS  250
+
+//
+// Most finger reports a frame takes, hybrid mode fits 2 contacts in each.
+// A move-only frame must fit the report ring next to its reserve.
+//
+#define REPORT_MAX_FRAME_REPORTS   ((MAX_TOUCHES + 1) / 2)
+
+C_ASSERT(REPORT_MAX_FRAME_REPORTS + HID_REPORT_RING_RESERVE <= HID_REPORT_RING_SIZE);
+
+//
+// Stages of the frame pipeline timed from ISR entry, and the log2
+// microsecond buckets of their histograms
+//
+#define REPORT_LATENCY_STAGE_SPB_READ       0
+#define REPORT_LATENCY_STAGE_CACHE_UPDATE   1
+#define REPORT_LATENCY_STAGE_REPORT_SENT    2
+#define REPORT_LATENCY_STAGES               3
+#define REPORT_LATENCY_BUCKETS              24
+
 typedef struct _OBJECT_INFO
 {
-	int x;
-	int y;
+	USHORT x;
+	USHORT y;
+	USHORT DisplayX;
+	USHORT DisplayY;
+	USHORT ReportedX;
+	USHORT ReportedY;
 	UCHAR status;
+	UCHAR ReportedStatus;
 } OBJECT_INFO;
 
+//
+// Contact filter state of a slot: the smoothed position in display pixels
+// and its velocity in display pixels per second, both Q8
+//
+typedef struct _OBJECT_FILTER
+{
+	LONG X;
+	LONG Y;
+	LONG DX;
+	LONG DY;
+} OBJECT_FILTER;
+
+//
+// Slots are indexed by the controller's touch ID. Down contacts are kept
+// in first-down order on a doubly linked list threaded through DownNext
+// and DownPrev; links hold slot + 1 so that 0 terminates the list and a
+// zeroed cache is empty. DownOrder is the list flattened once per frame.
+// SlotNew and SlotDirty hold the contacts that went down and up in the
+// last frame, the Reported fields what was last sent to HIDClass.
+// Filter holds the contact filter state of each slot and FilterTime the
+// interrupt time of the frame it last ran on.
+//
 typedef struct _OBJECT_CACHE
 {
 	OBJECT_INFO Slot[MAX_TOUCHES];
 	UINT32 SlotValid;
 	UINT32 SlotDirty;
-	int DownOrder[MAX_TOUCHES];
+	UINT32 SlotNew;
+	UCHAR DownNext[MAX_TOUCHES];
+	UCHAR DownPrev[MAX_TOUCHES];
+	UCHAR DownHead;
+	UCHAR DownTail;
+	UCHAR DownOrder[MAX_TOUCHES];
 	int DownCount;
 	ULONG64 ScanTime;
+	LONG64 LastReportTime;
+	OBJECT_FILTER Filter[MAX_TOUCHES];
+	ULONG64 FilterTime;
 } OBJECT_CACHE;
 
-typedef struct _DETECTED_OBJECT_POSITION
-{
-	int X;
-	int Y;
-} DETECTED_OBJECT_POSITION;
-
 typedef enum _OBJECT_STATE
 {
 	OBJECT_STATE_NOT_PRESENT = 0,
@@ -64,26 +113,117 @@ typedef enum _OBJECT_STATE
 	OBJECT_STATE_RESERVED = 5
 } OBJECT_STATE;
 
-typedef struct _DETECTED_OBJECTS
+//
+// A touch frame only carries the contacts the controller reported, each
+// tagged with its touch ID, and is passed by pointer down to the report
+// code. Present holds a bit per touch ID listed in Contacts. Timestamp is
+// the interrupt time (100ns units) of the interrupt that raised the frame,
+// 0 if unknown.
+//
+#define TOUCH_FRAME_MAX_CONTACTS   TOUCH_MAX_FRAME_CONTACTS
+
+typedef struct _TOUCH_FRAME_CONTACT
 {
-	OBJECT_STATE States[MAX_TOUCHES];
-	DETECTED_OBJECT_POSITION Positions[MAX_TOUCHES];
-} DETECTED_OBJECTS;
+	UCHAR TouchId;
+	UCHAR State;
+	USHORT X;
+	USHORT Y;
+} TOUCH_FRAME_CONTACT;
+
+typedef struct _TOUCH_FRAME
+{
+	ULONG64 Timestamp;
+	UINT32 Present;
+	ULONG ContactCount;
+	TOUCH_FRAME_CONTACT Contacts[TOUCH_FRAME_MAX_CONTACTS];
+} TOUCH_FRAME, * PTOUCH_FRAME;
+
+#define TOUCH_FRAME_SIZE(Frame) \
+	(FIELD_OFFSET(TOUCH_FRAME, Contacts) + \
+	 (Frame)->ContactCount * sizeof(TOUCH_FRAME_CONTACT))
+
+FORCEINLINE
+VOID
+TchInitializeTouchFrame(
+	OUT PTOUCH_FRAME Frame
+)
+{
+	Frame->Timestamp = 0;
+	Frame->Present = 0;
+	Frame->ContactCount = 0;
+}
+
+//
+// Updated with interlocked operations only, readers tolerate a sample
+// being counted in a bucket before it shows in the total
+//
+typedef struct _REPORT_LATENCY_STATS
+{
+	volatile LONG Buckets[REPORT_LATENCY_STAGES][REPORT_LATENCY_BUCKETS];
+	volatile LONG64 TotalMicroseconds[REPORT_LATENCY_STAGES];
+	volatile LONG FailedReads;
+} REPORT_LATENCY_STATS;
 
 typedef struct _BUTTON_CACHE
 {
 	BOOLEAN ButtonSlots[MAX_BUTTONS];
 } BUTTON_CACHE;
 
+//
+// The report context is the state touched on every frame. It is allocated
+// cache-aligned on its own, the per-frame fields lead and the report ring,
+// which is also written from the read path, starts on its own cache line.
+// InterruptTime is sampled on entry to the ISR and stamps the frame the
+// interrupt raises.
+//
+#pragma warning(push)
+#pragma warning(disable:4324) // structure padded due to alignment specifier
+
 typedef struct _REPORT_CONTEXT
 {
-	BUTTON_CACHE ButtonCache;
+	WDFQUEUE PingPongQueue;
+	volatile LONG64 InterruptTime;
+	BOOLEAN ParallelMode;
 	BOOLEAN PenPresent;
+	BUTTON_CACHE ButtonCache;
 	OBJECT_CACHE Cache;
 	TOUCH_SCREEN_PROPERTIES Props;
-	WDFQUEUE PingPongQueue;
+
+	//
+	// Frames in which no contact moved StationaryThreshold display pixels
+	// or more and none went down or up are not reported, unless
+	// StationaryKeepalive (100ns units) passed since the last report.
+	// A zero threshold reports every frame.
+	//
+	ULONG StationaryThreshold;
+	LONG64 StationaryKeepalive;
+	volatile LONG StationaryFramesSuppressed;
+
+	//
+	// Continuous reporting for panels that only interrupt on changes,
+	// the lock serializes the timer with frames read from hardware.
+	// Times are interrupt time in 100ns units.
+	//
+	WDFTIMER ContinuousTimer;
+	WDFSPINLOCK ContinuousLock;
+	BOOLEAN ContinuousActive;
+	LONG64 ContinuousPeriod;
+	LONG64 ContinuousLastFrameTime;
+	TOUCH_FRAME ContinuousFrame;
+
+	//
+	// Finger reports of the frame being reported, handed to the report
+	// ring all at once
+	//
+	HID_INPUT_REPORT FrameReports[REPORT_MAX_FRAME_REPORTS];
+
+	DECLSPEC_CACHEALIGN HID_REPORT_RING ReportRing;
+
+	DECLSPEC_CACHEALIGN REPORT_LATENCY_STATS Latency;
 } REPORT_CONTEXT, * PREPORT_CONTEXT;
 
+#pragma warning(pop)
+
 NTSTATUS
 ReportWakeup(
 	IN PREPORT_CONTEXT ReportContext
@@ -112,13 +252,31 @@ ReportPen(
 	IN USHORT YTilt
 );
 
+VOID
+ReportRecordLatency(
+	IN PREPORT_CONTEXT ReportContext,
+	IN ULONG Stage,
+	IN ULONG64 InterruptTime
+);
+
+VOID
+ReportRecordFailedRead(
+	IN PREPORT_CONTEXT ReportContext
+);
+
+VOID
+ReportResetObjectCache(
+	IN PREPORT_CONTEXT ReportContext
+);
+
 NTSTATUS
 ReportObjects(
 	IN PREPORT_CONTEXT ReportContext,
-	IN DETECTED_OBJECTS data
+	IN PTOUCH_FRAME Frame
 );
 
 NTSTATUS
 ReportConfigureContinuousSimulationTimer(
-	IN WDFDEVICE DeviceHandle
+	IN WDFDEVICE DeviceHandle,
+	IN PREPORT_CONTEXT ReportContext
 );
\ No newline at end of file
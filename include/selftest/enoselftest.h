@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <selftest\selftestbatch.h>
+
 
 //
 // This GUID is used to access the touch self-test virtual device from user-mode
@@ -38,6 +40,11 @@ DEFINE_GUID(GUID_TOUCH_ENOSELFTEST_INTERFACE,
 #define IOCTL_TOUCH_ENOSELFTEST_MODE           TOUCH_ENOTEST_BUFFER_CTL_CODE(102)
 #define IOCTL_TOUCH_ENOSELFTEST_CHANGE_PAGE    TOUCH_ENOTEST_BUFFER_CTL_CODE(103)
 
+//
+// Same request as IOCTL_TOUCH_SELFTEST_BATCH
+//
+#define IOCTL_TOUCH_ENOSELFTEST_BATCH          TOUCH_ENOTEST_BUFFER_CTL_CODE(104)
+
 typedef struct _TOUCH_ENOTEST_I2C_HEADER
 {
     UCHAR AddressLength;
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <selftest\selftestbatch.h>
+
 
 //
 // This GUID is used to access the touch self-test virtual device from user-mode
@@ -37,6 +39,40 @@ DEFINE_GUID(GUID_TOUCH_SELFTEST_INTERFACE,
 #define IOCTL_TOUCH_SELFTEST_WRITE          TOUCH_TEST_BUFFER_CTL_CODE(101)
 #define IOCTL_TOUCH_SELFTEST_MODE           TOUCH_TEST_BUFFER_CTL_CODE(102)
 #define IOCTL_TOUCH_SELFTEST_CHANGE_PAGE    TOUCH_TEST_BUFFER_CTL_CODE(103)
+#define IOCTL_TOUCH_SELFTEST_INTERRUPT_STATS TOUCH_TEST_BUFFER_CTL_CODE(104)
+#define IOCTL_TOUCH_SELFTEST_LATENCY_STATS  TOUCH_TEST_BUFFER_CTL_CODE(105)
+
+//
+// Returns the effective configuration as a TOUCH_CONFIGURATION_BLOB_VALUE
+// blob. A buffer holding only the header receives the header, whose sizes
+// give the length of the whole blob, and STATUS_BUFFER_OVERFLOW.
+//
+#define IOCTL_TOUCH_SELFTEST_CONFIGURATION_BLOB TOUCH_TEST_BUFFER_CTL_CODE(106)
+
+//
+// Runs a list of reads, writes and delays under one SPB lock acquisition,
+// see selftestbatch.h for the buffer layout
+//
+#define IOCTL_TOUCH_SELFTEST_BATCH          TOUCH_TEST_BUFFER_CTL_CODE(107)
+
+//
+// Streams raw frames into a ring passed as the output buffer of a request
+// that stays pending until it is canceled. While the driver is in
+// diagnostic mode every interrupt reads FrameLength bytes from Address
+// straight into the next slot, so the controller must have been switched
+// to the frame data in question, e.g. FOCAL_TECH_MODE_TEST, beforehand.
+// One stream runs at a time.
+//
+#define TOUCH_TEST_DIRECT_CTL_CODE(id)  \
+    CTL_CODE(FILE_DEVICE_KEYBOARD, (id), METHOD_OUT_DIRECT, FILE_ANY_ACCESS)
+
+#define IOCTL_TOUCH_SELFTEST_RAW_STREAM     TOUCH_TEST_DIRECT_CTL_CODE(108)
+
+//
+// Returns the frames kept by the frame recorder, oldest first, when the
+// FrameRecorderEnabled setting is on
+//
+#define IOCTL_TOUCH_SELFTEST_RECORDED_FRAMES TOUCH_TEST_BUFFER_CTL_CODE(109)
 
 typedef struct _TOUCH_TEST_I2C_HEADER
 {
@@ -45,12 +81,108 @@ typedef struct _TOUCH_TEST_I2C_HEADER
     ULONG RequestedTransferLength;
 } TOUCH_TEST_I2C_HEADER;
 
+typedef struct _TOUCH_TEST_INTERRUPT_STATS
+{
+    ULONG InterruptsReceived;
+    ULONG InterruptsCollapsed;
+    ULONG FramesServiced;
+    ULONG WatchdogStalls;
+    ULONG WatchdogPolls;
+    ULONG StationaryFramesSuppressed;
+} TOUCH_TEST_INTERRUPT_STATS;
+
+//
+// Latency from ISR entry to the end of each stage. Bucket 0 counts
+// samples under 1us, bucket n samples in [2^(n-1), 2^n) us and the last
+// bucket every longer sample.
+//
+#define TOUCH_TEST_LATENCY_STAGE_SPB_READ       0
+#define TOUCH_TEST_LATENCY_STAGE_CACHE_UPDATE   1
+#define TOUCH_TEST_LATENCY_STAGE_REPORT_SENT    2
+#define TOUCH_TEST_LATENCY_STAGES               3
+#define TOUCH_TEST_LATENCY_BUCKETS              24
+
+typedef struct _TOUCH_TEST_LATENCY_STATS
+{
+    ULONG Buckets[TOUCH_TEST_LATENCY_STAGES][TOUCH_TEST_LATENCY_BUCKETS];
+    ULONG64 TotalMicroseconds[TOUCH_TEST_LATENCY_STAGES];
+    ULONG CoalescedReports;
+    ULONG DroppedReports;
+    ULONG FailedReads;
+} TOUCH_TEST_LATENCY_STATS;
+
+#define TOUCH_TEST_RAW_STREAM_MAX_FRAME_LENGTH  4096
+
+typedef struct _TOUCH_TEST_RAW_STREAM_PARAMETERS
+{
+    UCHAR Address;
+    ULONG FrameLength;
+} TOUCH_TEST_RAW_STREAM_PARAMETERS;
+
+//
+// The ring starts with this header, filled in by the driver, and is
+// followed by SlotCount slots of SlotSize bytes. Frame n lands in slot
+// n % SlotCount and is published by advancing ProducerIndex past it. The
+// client advances ConsumerIndex once done with a slot, a frame that would
+// overwrite one not yet consumed is dropped.
+//
+typedef struct _TOUCH_TEST_RAW_RING_HEADER
+{
+    ULONG HeaderSize;
+    ULONG SlotSize;
+    ULONG SlotCount;
+    ULONG FrameLength;
+    volatile LONG ProducerIndex;
+    volatile LONG ConsumerIndex;
+    volatile LONG DroppedFrames;
+    ULONG Reserved;
+} TOUCH_TEST_RAW_RING_HEADER;
+
+//
+// Slot header, InterruptTime is the interrupt time of the frame in 100ns
+// units and Sequence counts frames including the dropped ones
+//
+typedef struct _TOUCH_TEST_RAW_FRAME
+{
+    ULONG64 InterruptTime;
+    ULONG Sequence;
+    ULONG Length;
+} TOUCH_TEST_RAW_FRAME;
+
+//
+// Data holds Length bytes of the frame exactly as read from register 0 on,
+// InterruptTime is in 100ns units. The output buffer receives a
+// TOUCH_TEST_RECORDED_FRAMES header followed by FrameCount frames.
+//
+#define TOUCH_TEST_RECORDED_FRAME_DATA_SIZE 64
+
+typedef struct _TOUCH_TEST_RECORDED_FRAME
+{
+    ULONG64 InterruptTime;
+    ULONG Sequence;
+    ULONG Length;
+    UCHAR Data[TOUCH_TEST_RECORDED_FRAME_DATA_SIZE];
+} TOUCH_TEST_RECORDED_FRAME;
+
+typedef struct _TOUCH_TEST_RECORDED_FRAMES
+{
+    ULONG FrameCount;
+    ULONG Reserved;
+} TOUCH_TEST_RECORDED_FRAMES;
+
 EVT_WDF_IO_QUEUE_IO_DEVICE_CONTROL TchSelfTestOnDeviceControl;
 
 EVT_WDF_DEVICE_FILE_CREATE TchSelfTestOnCreate;
 
+EVT_WDF_FILE_CLEANUP TchSelfTestOnCleanup;
+
 EVT_WDF_FILE_CLOSE TchSelfTestOnClose;
 
+VOID
+TchSelfTestServiceRawStream(
+    IN PDEVICE_EXTENSION DeviceContext
+    );
+
 NTSTATUS
 TchSelfTestInitialize(
     IN WDFDEVICE Device
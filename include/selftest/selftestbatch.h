@@ -0,0 +1,72 @@
+/*++
+    Copyright (c) Microsoft Corporation. All Rights Reserved.
+    Copyright (c) Bingxing Wang. All Rights Reserved.
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        selftestbatch.h
+
+    Abstract:
+
+        Contains the batched I2C request layout shared by the self-test
+        and ENO self-test interfaces.
+
+    Environment:
+
+        Kernel mode
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+//
+// The input buffer holds a TOUCH_TEST_BATCH_HEADER, OperationCount
+// operations and then the data of the write operations in their order.
+// The output buffer receives a TOUCH_TEST_BATCH_RESULT followed by the
+// data of the completed read operations in their order. The request
+// completes successfully once the input is accepted, the outcome of the
+// transfers is in the result.
+//
+#define TOUCH_TEST_BATCH_OP_READ            0
+#define TOUCH_TEST_BATCH_OP_WRITE           1
+#define TOUCH_TEST_BATCH_OP_DELAY           2
+
+#define TOUCH_TEST_BATCH_MAX_OPERATIONS     256
+#define TOUCH_TEST_BATCH_MAX_LENGTH         4096
+#define TOUCH_TEST_BATCH_MAX_DELAY_US       100000
+
+//
+// The SPB lock is held for the whole batch, its delays may not add up to
+// more than a single delay may be
+//
+#define TOUCH_TEST_BATCH_MAX_TOTAL_DELAY_US TOUCH_TEST_BATCH_MAX_DELAY_US
+
+typedef struct _TOUCH_TEST_BATCH_OPERATION
+{
+    UCHAR Operation;
+    UCHAR Address;
+    USHORT Reserved;
+    ULONG Length;   // Bytes read or written, microseconds for a delay
+} TOUCH_TEST_BATCH_OPERATION;
+
+typedef struct _TOUCH_TEST_BATCH_HEADER
+{
+    ULONG OperationCount;
+} TOUCH_TEST_BATCH_HEADER;
+
+typedef struct _TOUCH_TEST_BATCH_RESULT
+{
+    ULONG TransfersCompleted;   // Reads and writes, delays are not counted
+    LONG Status;
+} TOUCH_TEST_BATCH_RESULT;
+
+NTSTATUS
+TchSelfTestExecuteBatch(
+    IN PDEVICE_EXTENSION DeviceContext,
+    IN WDFREQUEST Request,
+    IN size_t OutputBufferLength,
+    IN size_t InputBufferLength
+    );
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All Rights Reserved.
+// Copyright (c) Bingxing Wang. All Rights Reserved.
+
+#pragma once
+
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
+
+//
+// TraceLogging provider for events raised on every interrupt or report.
+// Unlike the WPP traces in trace.h, which also feed the in-flight
+// recorder, an event costs a single enabled check while no session has
+// the provider and keyword enabled. Errors keep going through Trace.
+//
+// Provider name: FocalTechTouch
+// Provider GUID: {31C8E366-68CA-5ECC-86BB-95D10EAEE764}
+//
+TRACELOGGING_DECLARE_PROVIDER(gTouchTraceLoggingProvider);
+
+#define TOUCH_KEYWORD_INTERRUPT     0x0000000000000001ULL
+#define TOUCH_KEYWORD_REPORT        0x0000000000000002ULL
+#define TOUCH_KEYWORD_CONTINUOUS    0x0000000000000004ULL
+
+//
+// Replaces the EventWriteTouchIsr marker
+//
+#define TchTraceInterrupt(InterruptTime) \
+	TraceLoggingWrite( \
+		gTouchTraceLoggingProvider, \
+		"Interrupt", \
+		TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), \
+		TraceLoggingKeyword(TOUCH_KEYWORD_INTERRUPT), \
+		TraceLoggingUInt64((InterruptTime), "InterruptTime"))
+
+//
+// The finger report layout depends on the hybrid or parallel descriptor,
+// so the report is logged as is
+//
+#define TchTraceFingerReport(Report) \
+	TraceLoggingWrite( \
+		gTouchTraceLoggingProvider, \
+		"FingerReport", \
+		TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), \
+		TraceLoggingKeyword(TOUCH_KEYWORD_REPORT), \
+		TraceLoggingBinary((Report), (UINT16)sizeof(HID_INPUT_REPORT), "Report"))
+
+#define TchTracePenReport(PenReport) \
+	TraceLoggingWrite( \
+		gTouchTraceLoggingProvider, \
+		"PenReport", \
+		TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), \
+		TraceLoggingKeyword(TOUCH_KEYWORD_REPORT), \
+		TraceLoggingUInt8((UINT8)(PenReport)->TipSwitch, "TipSwitch"), \
+		TraceLoggingUInt8((UINT8)(PenReport)->BarrelSwitch, "BarrelSwitch"), \
+		TraceLoggingUInt8((UINT8)(PenReport)->Invert, "Invert"), \
+		TraceLoggingUInt8((UINT8)(PenReport)->Eraser, "Eraser"), \
+		TraceLoggingUInt8((UINT8)(PenReport)->InRange, "InRange"), \
+		TraceLoggingUInt16((PenReport)->X, "X"), \
+		TraceLoggingUInt16((PenReport)->Y, "Y"), \
+		TraceLoggingUInt16((PenReport)->TipPressure, "TipPressure"), \
+		TraceLoggingUInt16((PenReport)->XTilt, "XTilt"), \
+		TraceLoggingUInt16((PenReport)->YTilt, "YTilt"))
+
+#define TchTraceContinuousRepeat(ContactCount, Repeated) \
+	TraceLoggingWrite( \
+		gTouchTraceLoggingProvider, \
+		"ContinuousRepeat", \
+		TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), \
+		TraceLoggingKeyword(TOUCH_KEYWORD_CONTINUOUS), \
+		TraceLoggingUInt32((ContactCount), "ContactCount"), \
+		TraceLoggingBoolean((Repeated), "Repeated"))
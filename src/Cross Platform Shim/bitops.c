@@ -1,6 +1,11 @@
 /* BitOps Linux Port */
+#ifdef TCH_USER_MODE
+#include <windows.h>
+#else
 #include <wdm.h>
 #include <wdf.h>
+#endif
+#include <intrin.h>
 #include <Cross Platform Shim\bitops.h>
 #include <Cross Platform Shim\hweight.h>
 
@@ -41,7 +46,7 @@ int bitmap_weight(const unsigned long *bitmap, unsigned int bits)
 	return w;
 }
 
-static inline unsigned long __ffs(unsigned long word)
+static inline unsigned long __ffs_generic(unsigned long word)
 {
 	int num = 0;
 
@@ -72,13 +77,31 @@ static inline unsigned long __ffs(unsigned long word)
 	return num;
 }
 
-unsigned long find_first_bit(const unsigned long *addr, unsigned long size)
+/*
+ * BSF on x86/x64, RBIT+CLZ on ARM64. word must be non-zero, as for the
+ * generic version.
+ */
+static inline unsigned long __ffs(unsigned long word)
+{
+	unsigned long index;
+
+	_BitScanForward(&index, word);
+	return index;
+}
+
+static inline unsigned long _ffs_select(unsigned long word, int generic)
+{
+	return generic ? __ffs_generic(word) : __ffs(word);
+}
+
+static inline unsigned long _find_first_bit(const unsigned long *addr,
+	unsigned long size, int generic)
 {
 	unsigned long idx;
 
 	for (idx = 0; idx * BITS_PER_LONG < size; idx++) {
 		if (addr[idx])
-			return min(idx * BITS_PER_LONG + __ffs(addr[idx]), size);
+			return min(idx * BITS_PER_LONG + _ffs_select(addr[idx], generic), size);
 	}
 
 	return size;
@@ -93,7 +116,7 @@ unsigned long find_first_bit(const unsigned long *addr, unsigned long size)
 */
 static inline unsigned long _find_next_bit(const unsigned long *addr1,
 	const unsigned long *addr2, unsigned long nbits,
-	unsigned long start, unsigned long invert)
+	unsigned long start, unsigned long invert, int generic)
 {
 	unsigned long tmp;
 
@@ -119,11 +142,27 @@ static inline unsigned long _find_next_bit(const unsigned long *addr1,
 		tmp ^= invert;
 	}
 
-	return min(start + __ffs(tmp), nbits);
+	return min(start + _ffs_select(tmp, generic), nbits);
+}
+
+unsigned long find_first_bit(const unsigned long *addr, unsigned long size)
+{
+	return _find_first_bit(addr, size, 0);
 }
 
 unsigned long find_next_bit(const unsigned long *addr, unsigned long size,
 	unsigned long offset)
 {
-	return _find_next_bit(addr, NULL, size, offset, 0UL);
+	return _find_next_bit(addr, NULL, size, offset, 0UL, 0);
+}
+
+unsigned long find_first_bit_generic(const unsigned long *addr, unsigned long size)
+{
+	return _find_first_bit(addr, size, 1);
+}
+
+unsigned long find_next_bit_generic(const unsigned long *addr, unsigned long size,
+	unsigned long offset)
+{
+	return _find_next_bit(addr, NULL, size, offset, 0UL, 1);
 }
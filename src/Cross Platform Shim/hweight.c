@@ -1,10 +1,18 @@
 /* HWeight Linux Port */
+#ifdef TCH_USER_MODE
+#include <windows.h>
+#else
 #include <wdm.h>
 #include <wdf.h>
+#endif
+#include <intrin.h>
 #include <Cross Platform Shim\hweight.h>
 
-
-unsigned int hweight32(unsigned int w)
+/*
+ * Portable population counts, kept as the fallback for processors without
+ * a population count instruction and as the baseline for benchmarks.
+ */
+unsigned int hweight32_generic(unsigned int w)
 {
 	unsigned int res = w - ((w >> 1) & 0x55555555);
 	res = (res & 0x33333333) + ((res >> 2) & 0x33333333);
@@ -13,11 +21,11 @@ unsigned int hweight32(unsigned int w)
 	return (res + (res >> 16)) & 0x000000FF;
 }
 
-ULONGLONG hweight64(ULONGLONG w)
+ULONGLONG hweight64_generic(ULONGLONG w)
 {
 #if ARM || X86
-	return hweight32((unsigned int)(w >> 32)) +
-		hweight32((unsigned int)w);
+	return hweight32_generic((unsigned int)(w >> 32)) +
+		hweight32_generic((unsigned int)w);
 #else
 	ULONGLONG res = w - ((w >> 1) & 0x5555555555555555ul);
 	res = (res & 0x3333333333333333ul) + ((res >> 2) & 0x3333333333333333ul);
@@ -27,3 +35,59 @@ ULONGLONG hweight64(ULONGLONG w)
 	return (res + (res >> 32)) & 0x00000000000000FFul;
 #endif
 }
+
+#if defined(_M_IX86) || defined(_M_AMD64)
+/*
+ * POPCNT is not part of the x86/x64 baseline, CPUID.01H:ECX bit 23 tells
+ * whether it can be used. 0 = not probed yet, 1 = absent, 2 = present.
+ */
+static volatile LONG gPopcntSupport;
+
+static int hweight_has_popcnt(void)
+{
+	LONG support = gPopcntSupport;
+
+	if (support == 0) {
+		int info[4];
+
+		__cpuid(info, 1);
+		support = (info[2] & (1 << 23)) ? 2 : 1;
+		gPopcntSupport = support;
+	}
+
+	return support == 2;
+}
+#endif
+
+unsigned int hweight32(unsigned int w)
+{
+#if defined(_M_ARM64)
+	return (unsigned int)_CountOneBits(w);
+#elif defined(_M_IX86) || defined(_M_AMD64)
+	if (hweight_has_popcnt())
+		return __popcnt(w);
+
+	return hweight32_generic(w);
+#else
+	return hweight32_generic(w);
+#endif
+}
+
+ULONGLONG hweight64(ULONGLONG w)
+{
+#if defined(_M_ARM64)
+	return (ULONGLONG)_CountOneBits64(w);
+#elif defined(_M_AMD64)
+	if (hweight_has_popcnt())
+		return __popcnt64(w);
+
+	return hweight64_generic(w);
+#elif defined(_M_IX86)
+	if (hweight_has_popcnt())
+		return __popcnt((unsigned int)(w >> 32)) + __popcnt((unsigned int)w);
+
+	return hweight64_generic(w);
+#else
+	return hweight64_generic(w);
+#endif
+}
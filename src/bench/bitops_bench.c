@@ -0,0 +1,176 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		bitops_bench.c
+
+	Abstract:
+
+		User-mode micro-benchmark comparing the intrinsic-backed bit
+		operations of the Cross Platform Shim against their generic
+		fallbacks. Masks are shaped like contact tracker masks: a few
+		bits set out of 32.
+
+	Environment:
+
+		User mode
+
+	Revision History:
+
+--*/
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <Cross Platform Shim\bitops.h>
+#include <Cross Platform Shim\hweight.h>
+
+#define BENCH_MASK_COUNT    4096
+#define BENCH_ITERATIONS    2000
+#define BENCH_MASK_BITS     32
+
+typedef ULONGLONG (*PBENCH_ROUTINE)(const unsigned long* Masks, ULONG Count);
+
+static unsigned long gMasks[BENCH_MASK_COUNT];
+
+static ULONGLONG BenchHweight32(const unsigned long* Masks, ULONG Count)
+{
+	ULONGLONG sum = 0;
+	ULONG i;
+
+	for (i = 0; i < Count; i++)
+		sum += hweight32(Masks[i]);
+
+	return sum;
+}
+
+static ULONGLONG BenchHweight32Generic(const unsigned long* Masks, ULONG Count)
+{
+	ULONGLONG sum = 0;
+	ULONG i;
+
+	for (i = 0; i < Count; i++)
+		sum += hweight32_generic(Masks[i]);
+
+	return sum;
+}
+
+static ULONGLONG BenchHweight64(const unsigned long* Masks, ULONG Count)
+{
+	ULONGLONG sum = 0;
+	ULONG i;
+
+	for (i = 0; i + 1 < Count; i += 2)
+		sum += hweight64(((ULONGLONG)Masks[i] << 32) | Masks[i + 1]);
+
+	return sum;
+}
+
+static ULONGLONG BenchHweight64Generic(const unsigned long* Masks, ULONG Count)
+{
+	ULONGLONG sum = 0;
+	ULONG i;
+
+	for (i = 0; i + 1 < Count; i += 2)
+		sum += hweight64_generic(((ULONGLONG)Masks[i] << 32) | Masks[i + 1]);
+
+	return sum;
+}
+
+static ULONGLONG BenchWalkBits(const unsigned long* Masks, ULONG Count)
+{
+	ULONGLONG sum = 0;
+	unsigned long bit;
+	ULONG i;
+
+	for (i = 0; i < Count; i++) {
+		for (bit = find_first_bit(&Masks[i], BENCH_MASK_BITS);
+			bit < BENCH_MASK_BITS;
+			bit = find_next_bit(&Masks[i], BENCH_MASK_BITS, bit + 1))
+			sum += bit;
+	}
+
+	return sum;
+}
+
+static ULONGLONG BenchWalkBitsGeneric(const unsigned long* Masks, ULONG Count)
+{
+	ULONGLONG sum = 0;
+	unsigned long bit;
+	ULONG i;
+
+	for (i = 0; i < Count; i++) {
+		for (bit = find_first_bit_generic(&Masks[i], BENCH_MASK_BITS);
+			bit < BENCH_MASK_BITS;
+			bit = find_next_bit_generic(&Masks[i], BENCH_MASK_BITS, bit + 1))
+			sum += bit;
+	}
+
+	return sum;
+}
+
+static double BenchRun(PBENCH_ROUTINE Routine, ULONGLONG* Result)
+{
+	LARGE_INTEGER frequency, start, end;
+	ULONGLONG result = 0;
+	ULONG i;
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+		result += Routine(gMasks, BENCH_MASK_COUNT);
+
+	QueryPerformanceCounter(&end);
+
+	*Result = result;
+
+	return (double)(end.QuadPart - start.QuadPart) * 1e9 /
+		(double)frequency.QuadPart /
+		((double)BENCH_ITERATIONS * BENCH_MASK_COUNT);
+}
+
+static int BenchCompare(const char* Name, PBENCH_ROUTINE Intrinsic, PBENCH_ROUTINE Generic)
+{
+	ULONGLONG intrinsicResult, genericResult;
+	double intrinsicNs, genericNs;
+
+	intrinsicNs = BenchRun(Intrinsic, &intrinsicResult);
+	genericNs = BenchRun(Generic, &genericResult);
+
+	printf("%-16s intrinsic %7.3f ns/mask  generic %7.3f ns/mask  speedup %5.2fx%s\n",
+		Name,
+		intrinsicNs,
+		genericNs,
+		intrinsicNs > 0.0 ? genericNs / intrinsicNs : 0.0,
+		intrinsicResult == genericResult ? "" : "  MISMATCH");
+
+	return intrinsicResult == genericResult;
+}
+
+int __cdecl main(void)
+{
+	ULONG i, j;
+	int ok = 1;
+
+	srand(0x5446);
+
+	//
+	// Up to 10 contacts out of 32 slots, single contacts most common
+	//
+	for (i = 0; i < BENCH_MASK_COUNT; i++) {
+		ULONG contacts = (ULONG)(rand() % 4 == 0 ? rand() % 11 : 1 + rand() % 2);
+
+		gMasks[i] = 0;
+
+		for (j = 0; j < contacts; j++)
+			gMasks[i] |= 1UL << (rand() % BENCH_MASK_BITS);
+	}
+
+	ok &= BenchCompare("hweight32", BenchHweight32, BenchHweight32Generic);
+	ok &= BenchCompare("hweight64", BenchHweight64, BenchHweight64Generic);
+	ok &= BenchCompare("find_*_bit walk", BenchWalkBits, BenchWalkBitsGeneric);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,605 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		replay_bench.c
+
+	Abstract:
+
+		User-mode replay benchmark of the frame pipeline: parsing of the
+		FocalTech event data (Ft5xParseEventData), the object cache, the
+		coordinate translation and the HID report generation, built from
+		the driver sources against the shim in shim\.
+
+		Synthetic traces covering 1 to 6 contacts, lifts and reordered
+		records are replayed, or frames saved from the self-test
+		interface. Each trace is first replayed once from a fresh report
+		context to count and hash the reports it produces, the hash and
+		the optional report stream only depend on the trace and the
+		options, so that a change to the pipeline can be checked for
+		bit-identical output. The trace is then replayed for timing.
+
+	Environment:
+
+		User mode
+
+	Revision History:
+
+--*/
+
+#include <wdm.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <Cross Platform Shim\compat.h>
+#include <report.h>
+#include <ft5x\ftinternal.h>
+#include <benchshim.h>
+
+#define BENCH_TRACE_FRAMES          4096
+#define BENCH_DEFAULT_PASSES        200
+#define BENCH_MAX_CAPTURE_FRAMES    (1024 * 1024)
+
+//
+// 120Hz frames, times are interrupt time in 100ns units. Traces start one
+// second in as a zero timestamp means none to the report code.
+//
+#define BENCH_FRAME_INTERVAL        83333
+#define BENCH_BASE_TIME             10000000ULL
+
+#define BENCH_CONTACT_IDS           10
+#define BENCH_DISPLAY_WIDTH         1080
+#define BENCH_DISPLAY_HEIGHT        1920
+
+//
+// Layout of the IOCTL_TOUCH_SELFTEST_RECORDED_FRAMES output (selftest.h),
+// which a capture file holds as returned
+//
+#define BENCH_CAPTURE_DATA_SIZE     64
+
+typedef struct _BENCH_CAPTURE_HEADER
+{
+	ULONG FrameCount;
+	ULONG Reserved;
+} BENCH_CAPTURE_HEADER;
+
+typedef struct _BENCH_CAPTURE_FRAME
+{
+	ULONG64 InterruptTime;
+	ULONG Sequence;
+	ULONG Length;
+	UCHAR Data[BENCH_CAPTURE_DATA_SIZE];
+} BENCH_CAPTURE_FRAME;
+
+C_ASSERT(sizeof(FOCAL_TECH_EVENT_DATA) <= BENCH_CAPTURE_DATA_SIZE);
+
+typedef struct _BENCH_FRAME
+{
+	ULONG64 Time;
+	FOCAL_TECH_EVENT_DATA EventData;
+} BENCH_FRAME;
+
+typedef struct _BENCH_CONTACT
+{
+	BOOLEAN Down;
+	BOOLEAN Pressed;
+	BOOLEAN Lifted;
+	LONG X;
+	LONG Y;
+	LONG DX;
+	LONG DY;
+} BENCH_CONTACT;
+
+typedef enum _BENCH_SCENARIO
+{
+	BenchScenarioTap,
+	BenchScenarioSwipe,
+	BenchScenarioRamp,
+	BenchScenarioReorder,
+	BenchScenarioHold,
+	BenchScenarioRandom,
+	BenchScenarioCount
+} BENCH_SCENARIO;
+
+static const char* gBenchScenarioNames[BenchScenarioCount] =
+{
+	"tap",
+	"swipe2",
+	"ramp1-6",
+	"reorder4",
+	"hold3",
+	"random"
+};
+
+typedef struct _BENCH_OPTIONS
+{
+	const char* CapturePath;
+	const char* ReportPath;
+	ULONG Passes;
+	BOOLEAN Parallel;
+	BOOLEAN Continuous;
+	BOOLEAN Filter;
+	ULONG PredictionUs;
+	ULONG StationaryThreshold;
+} BENCH_OPTIONS;
+
+static ULONG gBenchSeed;
+
+//
+// Own generator so that the traces do not depend on the CRT
+//
+static ULONG BenchRandom(ULONG Range)
+{
+	gBenchSeed = gBenchSeed * 1103515245 + 12345;
+
+	return ((gBenchSeed >> 16) & 0x7FFF) % Range;
+}
+
+static VOID BenchContactDown(BENCH_CONTACT* Contact, ULONG Id, BOOLEAN Moving)
+{
+	Contact->Down = TRUE;
+	Contact->Pressed = TRUE;
+	Contact->X = 100 + (LONG)Id * 120;
+	Contact->Y = 200 + (LONG)Id * 220;
+	Contact->DX = Moving ? 3 + (LONG)Id : 0;
+	Contact->DY = Moving ? 6 - (LONG)Id : 0;
+}
+
+static VOID BenchContactUp(BENCH_CONTACT* Contact)
+{
+	Contact->Down = FALSE;
+	Contact->Lifted = TRUE;
+}
+
+static VOID BenchContactMove(BENCH_CONTACT* Contact)
+{
+	if (Contact->X + Contact->DX < 0 || Contact->X + Contact->DX >= TOUCH_DEVICE_RESOLUTION_X)
+		Contact->DX = -Contact->DX;
+
+	if (Contact->Y + Contact->DY < 0 || Contact->Y + Contact->DY >= TOUCH_DEVICE_RESOLUTION_Y)
+		Contact->DY = -Contact->DY;
+
+	Contact->X += Contact->DX;
+	Contact->Y += Contact->DY;
+}
+
+static VOID BenchSetRecord(FOCAL_TECH_TOUCH_DATA* Record, ULONG Id, ULONG Flag, const BENCH_CONTACT* Contact)
+{
+	Record->TouchId = (BYTE)Id;
+	Record->EventFlag = (BYTE)Flag;
+	Record->PositionX_High = (BYTE)((Contact->X >> 8) & 0xF);
+	Record->PositionX_Low = (BYTE)(Contact->X & 0xFF);
+	Record->PositionY_High = (BYTE)((Contact->Y >> 8) & 0xF);
+	Record->PositionY_Low = (BYTE)(Contact->Y & 0xFF);
+	Record->TouchWeight = 0x20;
+	Record->TouchArea = 0x4;
+}
+
+static VOID BenchStepScenario(BENCH_SCENARIO Scenario, ULONG Frame, BENCH_CONTACT* Contacts)
+{
+	ULONG want, phase, active, i;
+
+	switch (Scenario) {
+	case BenchScenarioTap:
+		want = (Frame % 12) < 8 ? 1 : 0;
+		break;
+	case BenchScenarioSwipe:
+		want = 2;
+		break;
+	case BenchScenarioRamp:
+		phase = Frame % 120;
+		want = phase < 60 ? 1 + phase / 10 : 6 - (phase - 60) / 10;
+		break;
+	case BenchScenarioReorder:
+		want = 4;
+		break;
+	case BenchScenarioHold:
+		want = 3;
+		break;
+	default:
+		want = 0;
+		break;
+	}
+
+	for (i = 0; i < BENCH_CONTACT_IDS; i++) {
+		Contacts[i].Pressed = FALSE;
+		Contacts[i].Lifted = FALSE;
+	}
+
+	if (Scenario != BenchScenarioRandom) {
+		for (i = 0; i < BENCH_CONTACT_IDS; i++) {
+			if (i < want && !Contacts[i].Down)
+				BenchContactDown(&Contacts[i], i, Scenario != BenchScenarioHold);
+			else if (i >= want && Contacts[i].Down)
+				BenchContactUp(&Contacts[i]);
+			else if (Contacts[i].Down)
+				BenchContactMove(&Contacts[i]);
+		}
+
+		return;
+	}
+
+	//
+	// Contacts go down on random IDs and lift at random, a lift frees
+	// its record for the frame after so that at most 6 records are used
+	//
+	active = 0;
+
+	for (i = 0; i < BENCH_CONTACT_IDS; i++) {
+		if (Contacts[i].Down && BenchRandom(40) == 0)
+			BenchContactUp(&Contacts[i]);
+
+		if (Contacts[i].Down || Contacts[i].Lifted)
+			active++;
+	}
+
+	for (i = 0; i < BENCH_CONTACT_IDS; i++) {
+		if (Contacts[i].Down) {
+			Contacts[i].DX = (LONG)BenchRandom(17) - 8;
+			Contacts[i].DY = (LONG)BenchRandom(17) - 8;
+			BenchContactMove(&Contacts[i]);
+		} else if (!Contacts[i].Lifted && active < (ULONG)FT5X_MAX_TOUCH_POINTS && BenchRandom(20) == 0) {
+			BenchContactDown(&Contacts[i], i, FALSE);
+			active++;
+		}
+	}
+}
+
+static VOID BenchBuildScenario(BENCH_SCENARIO Scenario, BENCH_FRAME* Frames, ULONG Count)
+{
+	BENCH_CONTACT contacts[BENCH_CONTACT_IDS];
+	UCHAR order[BENCH_CONTACT_IDS];
+	ULONG f, i, j, records;
+	UCHAR swap;
+
+	RtlZeroMemory(contacts, sizeof(contacts));
+	gBenchSeed = 0x5446 + (ULONG)Scenario;
+
+	for (f = 0; f < Count; f++) {
+		FOCAL_TECH_EVENT_DATA* data = &Frames[f].EventData;
+
+		BenchStepScenario(Scenario, f, contacts);
+
+		records = 0;
+
+		for (i = 0; i < BENCH_CONTACT_IDS; i++) {
+			if (contacts[i].Down || contacts[i].Lifted)
+				order[records++] = (UCHAR)i;
+		}
+
+		//
+		// The controller lists records in no particular order
+		//
+		if (Scenario == BenchScenarioReorder && records != 0) {
+			for (i = 0; i < f % records; i++) {
+				swap = order[0];
+
+				for (j = 1; j < records; j++)
+					order[j - 1] = order[j];
+
+				order[records - 1] = swap;
+			}
+		} else if (Scenario == BenchScenarioRandom) {
+			for (i = records; i > 1; i--) {
+				j = BenchRandom(i);
+				swap = order[i - 1];
+				order[i - 1] = order[j];
+				order[j] = swap;
+			}
+		}
+
+		records = min(records, (ULONG)FT5X_MAX_TOUCH_POINTS);
+
+		Frames[f].Time = (ULONG64)f * BENCH_FRAME_INTERVAL;
+
+		RtlZeroMemory(data, sizeof(FOCAL_TECH_EVENT_DATA));
+		memset(data->TouchData, 0xFF, sizeof(data->TouchData));
+
+		data->NumberOfTouchPoints = (BYTE)records;
+
+		for (i = 0; i < records; i++) {
+			BENCH_CONTACT* contact = &contacts[order[i]];
+			ULONG flag;
+
+			if (contact->Lifted)
+				flag = FT5X_TOUCH_EVENT_LIFT_UP;
+			else if (contact->Pressed)
+				flag = FT5X_TOUCH_EVENT_PRESS_DOWN;
+			else
+				flag = FT5X_TOUCH_EVENT_CONTACT;
+
+			BenchSetRecord(&data->TouchData[i], order[i], flag, contact);
+		}
+	}
+}
+
+static int __cdecl BenchCompareSequence(const void* A, const void* B)
+{
+	const BENCH_CAPTURE_FRAME* a = (const BENCH_CAPTURE_FRAME*)A;
+	const BENCH_CAPTURE_FRAME* b = (const BENCH_CAPTURE_FRAME*)B;
+	LONG delta = (LONG)(a->Sequence - b->Sequence);
+
+	return (delta > 0) - (delta < 0);
+}
+
+static BENCH_FRAME* BenchLoadCapture(const char* Path, ULONG* Count)
+{
+	BENCH_CAPTURE_HEADER header;
+	BENCH_CAPTURE_FRAME* captured = NULL;
+	BENCH_FRAME* frames = NULL;
+	FILE* file = NULL;
+	ULONG64 first;
+	ULONG i;
+
+	if (fopen_s(&file, Path, "rb") != 0 || file == NULL) {
+		fprintf(stderr, "cannot open %s\n", Path);
+		return NULL;
+	}
+
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+		header.FrameCount == 0 ||
+		header.FrameCount > BENCH_MAX_CAPTURE_FRAMES) {
+		fprintf(stderr, "%s is not a frame capture\n", Path);
+		goto exit;
+	}
+
+	captured = (BENCH_CAPTURE_FRAME*)calloc(header.FrameCount, sizeof(BENCH_CAPTURE_FRAME));
+	frames = (BENCH_FRAME*)calloc(header.FrameCount, sizeof(BENCH_FRAME));
+
+	if (captured == NULL || frames == NULL) {
+		fprintf(stderr, "out of memory\n");
+		free(frames);
+		frames = NULL;
+		goto exit;
+	}
+
+	if (fread(captured, sizeof(BENCH_CAPTURE_FRAME), header.FrameCount, file) != header.FrameCount) {
+		fprintf(stderr, "%s is truncated\n", Path);
+		free(frames);
+		frames = NULL;
+		goto exit;
+	}
+
+	//
+	// The recorder is a ring, replay in the order the frames were read
+	//
+	qsort(captured, header.FrameCount, sizeof(BENCH_CAPTURE_FRAME), BenchCompareSequence);
+
+	first = captured[0].InterruptTime;
+
+	for (i = 0; i < header.FrameCount; i++) {
+		memset(&frames[i].EventData, 0xFF, sizeof(FOCAL_TECH_EVENT_DATA));
+		memcpy(&frames[i].EventData, captured[i].Data,
+			min(captured[i].Length, sizeof(FOCAL_TECH_EVENT_DATA)));
+
+		//
+		// Frames without a timestamp are spaced at the synthetic rate
+		//
+		if (captured[i].InterruptTime >= first && first != 0)
+			frames[i].Time = captured[i].InterruptTime - first;
+		else
+			frames[i].Time = (ULONG64)i * BENCH_FRAME_INTERVAL;
+	}
+
+	*Count = header.FrameCount;
+
+exit:
+	free(captured);
+	fclose(file);
+
+	return frames;
+}
+
+static PREPORT_CONTEXT BenchCreateReportContext(const BENCH_OPTIONS* Options)
+{
+	PREPORT_CONTEXT context;
+	PTOUCH_SCREEN_PROPERTIES props;
+
+	context = (PREPORT_CONTEXT)_aligned_malloc(sizeof(REPORT_CONTEXT), SYSTEM_CACHE_ALIGNMENT_SIZE);
+
+	if (context == NULL)
+		return NULL;
+
+	RtlZeroMemory(context, sizeof(REPORT_CONTEXT));
+
+	context->ParallelMode = Options->Parallel;
+	context->StationaryThreshold = Options->StationaryThreshold;
+	context->StationaryKeepalive = (LONG64)REPORT_DEFAULT_STATIONARY_KEEPALIVE_MS * 10000;
+
+	//
+	// Panel resolution scaled to a smaller display, so that the transform
+	// does some work
+	//
+	props = &context->Props;
+	props->TouchPhysicalWidth = TOUCH_DEVICE_RESOLUTION_X;
+	props->TouchPhysicalHeight = TOUCH_DEVICE_RESOLUTION_Y;
+	props->DisplayPhysicalWidth = BENCH_DISPLAY_WIDTH;
+	props->DisplayPhysicalHeight = BENCH_DISPLAY_HEIGHT;
+	props->DisplayViewableWidth = BENCH_DISPLAY_WIDTH;
+	props->DisplayViewableHeight = BENCH_DISPLAY_HEIGHT;
+	props->TouchHardwareLacksContinuousReporting = Options->Continuous;
+
+	props->TouchFilterEnabled = Options->Filter;
+	props->TouchPredictionUs = Options->PredictionUs;
+
+	TchCompileCoordinateTransform(props);
+	TchCompileContactFilter(props);
+
+	if (Options->Continuous &&
+		!NT_SUCCESS(ReportConfigureContinuousSimulationTimer(NULL, context))) {
+		_aligned_free(context);
+		return NULL;
+	}
+
+	return context;
+}
+
+static VOID BenchDestroyReportContext(PREPORT_CONTEXT Context)
+{
+	//
+	// The continuous reporting timer may still be armed on the context
+	//
+	BenchDestroyObjects();
+	_aligned_free(Context);
+}
+
+static ULONG64 BenchReplay(PREPORT_CONTEXT Context, const BENCH_FRAME* Frames, ULONG Count, ULONG64 BaseTime)
+{
+	TOUCH_FRAME frame;
+	ULONG i;
+
+	for (i = 0; i < Count; i++) {
+		BenchAdvanceInterruptTime(BaseTime + Frames[i].Time);
+
+		TchInitializeTouchFrame(&frame);
+		frame.Timestamp = KeQueryInterruptTime();
+
+		Ft5xParseEventData((PFOCAL_TECH_EVENT_DATA)&Frames[i].EventData, &frame);
+
+		(VOID)ReportObjects(Context, &frame);
+	}
+
+	//
+	// Next pass starts one frame after the last
+	//
+	return BaseTime + Frames[Count - 1].Time + BENCH_FRAME_INTERVAL;
+}
+
+static int BenchRunTrace(const char* Name, const BENCH_FRAME* Frames, ULONG Count, const BENCH_OPTIONS* Options, FILE* Stream)
+{
+	LARGE_INTEGER frequency, start, end;
+	PREPORT_CONTEXT context;
+	ULONG64 reports, hash, time;
+	ULONG pass;
+
+	context = BenchCreateReportContext(Options);
+
+	if (context == NULL) {
+		fprintf(stderr, "cannot create the report context\n");
+		return 0;
+	}
+
+	//
+	// Verification pass from a fresh context and clock origin
+	//
+	BenchResetReports(Stream);
+	time = BenchReplay(context, Frames, Count, BENCH_BASE_TIME);
+
+	reports = BenchGetReportCount();
+	hash = BenchGetReportHash();
+
+	BenchResetReports(NULL);
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+
+	for (pass = 0; pass < Options->Passes; pass++)
+		time = BenchReplay(context, Frames, Count, time);
+
+	QueryPerformanceCounter(&end);
+
+	printf("%-10s %7lu frames %9.1f ns/frame %7.3f reports/frame  hash %016llX\n",
+		Name,
+		Count,
+		Options->Passes == 0 ? 0.0 :
+			(double)(end.QuadPart - start.QuadPart) * 1e9 /
+			(double)frequency.QuadPart /
+			((double)Options->Passes * Count),
+		(double)reports / Count,
+		hash);
+
+	BenchDestroyReportContext(context);
+
+	return 1;
+}
+
+static VOID BenchUsage(VOID)
+{
+	fprintf(stderr,
+		"usage: ReplayBench [-c capture] [-o reports] [-n passes] [-p] [-k] [-f] [-e us] [-s threshold] [-v]\n"
+		"  -c  replay frames saved from IOCTL_TOUCH_SELFTEST_RECORDED_FRAMES\n"
+		"      instead of the synthetic traces\n"
+		"  -o  write the reports of the verification passes to a file\n"
+		"  -n  timed passes over each trace (default %u)\n"
+		"  -p  parallel reporting mode\n"
+		"  -k  repeat frames as for TouchHardwareLacksContinuousReporting\n"
+		"  -f  run the contact filter with its default settings\n"
+		"  -e  contact prediction horizon in microseconds, with -f\n"
+		"  -s  stationary threshold in display pixels (default 0)\n"
+		"  -v  print driver traces\n",
+		BENCH_DEFAULT_PASSES);
+}
+
+int __cdecl main(int argc, char** argv)
+{
+	BENCH_OPTIONS options;
+	BENCH_FRAME* frames;
+	FILE* stream = NULL;
+	ULONG count, i;
+	int ok = 1;
+
+	RtlZeroMemory(&options, sizeof(options));
+	options.Passes = BENCH_DEFAULT_PASSES;
+
+	for (i = 1; i < (ULONG)argc; i++) {
+		if (strcmp(argv[i], "-c") == 0 && i + 1 < (ULONG)argc) {
+			options.CapturePath = argv[++i];
+		} else if (strcmp(argv[i], "-o") == 0 && i + 1 < (ULONG)argc) {
+			options.ReportPath = argv[++i];
+		} else if (strcmp(argv[i], "-n") == 0 && i + 1 < (ULONG)argc) {
+			options.Passes = strtoul(argv[++i], NULL, 0);
+		} else if (strcmp(argv[i], "-s") == 0 && i + 1 < (ULONG)argc) {
+			options.StationaryThreshold = strtoul(argv[++i], NULL, 0);
+		} else if (strcmp(argv[i], "-e") == 0 && i + 1 < (ULONG)argc) {
+			options.PredictionUs = strtoul(argv[++i], NULL, 0);
+		} else if (strcmp(argv[i], "-f") == 0) {
+			options.Filter = TRUE;
+		} else if (strcmp(argv[i], "-p") == 0) {
+			options.Parallel = TRUE;
+		} else if (strcmp(argv[i], "-k") == 0) {
+			options.Continuous = TRUE;
+		} else if (strcmp(argv[i], "-v") == 0) {
+			BenchSetTraceLevel(TRACE_LEVEL_VERBOSE);
+		} else {
+			BenchUsage();
+			return 2;
+		}
+	}
+
+	if (options.ReportPath != NULL &&
+		(fopen_s(&stream, options.ReportPath, "wb") != 0 || stream == NULL)) {
+		fprintf(stderr, "cannot create %s\n", options.ReportPath);
+		return 1;
+	}
+
+	if (options.CapturePath != NULL) {
+		frames = BenchLoadCapture(options.CapturePath, &count);
+
+		if (frames == NULL) {
+			ok = 0;
+		} else {
+			ok = BenchRunTrace("capture", frames, count, &options, stream);
+			free(frames);
+		}
+	} else {
+		frames = (BENCH_FRAME*)calloc(BENCH_TRACE_FRAMES, sizeof(BENCH_FRAME));
+
+		if (frames == NULL) {
+			ok = 0;
+		} else {
+			for (i = 0; i < BenchScenarioCount && ok; i++) {
+				BenchBuildScenario((BENCH_SCENARIO)i, frames, BENCH_TRACE_FRAMES);
+				ok = BenchRunTrace(gBenchScenarioNames[i], frames, BENCH_TRACE_FRAMES, &options, stream);
+			}
+
+			free(frames);
+		}
+	}
+
+	if (stream != NULL)
+		fclose(stream);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		benchshim.h
+
+	Abstract:
+
+		Controls of the user-mode shim used by the replay bench: the
+		virtual interrupt clock, the framework timers it drives and the
+		sink counting and hashing the HID reports the driver sends.
+
+	Environment:
+
+		User mode
+
+	Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <stdio.h>
+
+VOID
+BenchSetTraceLevel(
+	IN UCHAR Level
+);
+
+//
+// Moves the virtual clock (interrupt time, 100ns units) to Time, firing
+// every framework timer that expires up to then in due time order
+//
+VOID
+BenchAdvanceInterruptTime(
+	IN ULONG64 Time
+);
+
+//
+// Report sink. Reports are hashed with FNV-1a 64 and, if a stream is
+// given, written to it back to back as sent
+//
+VOID
+BenchResetReports(
+	IN FILE* Stream OPTIONAL
+);
+
+ULONG64
+BenchGetReportCount(
+	VOID
+);
+
+ULONG64
+BenchGetReportHash(
+	VOID
+);
+
+VOID
+BenchDestroyObjects(
+	VOID
+);
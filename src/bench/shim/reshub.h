@@ -0,0 +1,5 @@
+#pragma once
+
+//
+// Everything the bench needs from reshub.h is provided by the shim wdm.h
+//
@@ -0,0 +1,386 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		shim.c
+
+	Abstract:
+
+		User-mode implementation of the kernel and framework routines
+		the frame pipeline calls, see wdm.h. Replays are single threaded:
+		locks only check that they are not taken twice and timers fire
+		from BenchAdvanceInterruptTime.
+
+	Environment:
+
+		User mode
+
+	Revision History:
+
+--*/
+
+#include <wdm.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <controller.h>
+#include <tracelog.h>
+#include "benchshim.h"
+
+TRACELOGGING_DEFINE_PROVIDER(
+	gTouchTraceLoggingProvider,
+	"FocalTechTouch",
+	(0x31c8e366, 0x68ca, 0x5ecc, 0x86, 0xbb, 0x95, 0xd1, 0x0e, 0xae, 0xe7, 0x64));
+
+#define BENCH_FNV_OFFSET_BASIS  0xCBF29CE484222325ULL
+#define BENCH_FNV_PRIME         0x00000100000001B3ULL
+
+typedef struct _BENCH_WDF_OBJECT
+{
+	struct _BENCH_WDF_OBJECT* Next;
+	PCWDF_OBJECT_CONTEXT_TYPE_INFO ContextTypeInfo;
+	PVOID Context;
+	PFN_WDF_TIMER EvtTimerFunc;
+	BOOLEAN TimerArmed;
+	ULONG64 TimerDueTime;
+	LONG LockDepth;
+} BENCH_WDF_OBJECT;
+
+static UCHAR gBenchTraceLevel = TRACE_LEVEL_NONE;
+static ULONG64 gBenchInterruptTime;
+static BENCH_WDF_OBJECT* gBenchObjects;
+
+static FILE* gBenchReportStream;
+static ULONG64 gBenchReportCount;
+static ULONG64 gBenchReportHash = BENCH_FNV_OFFSET_BASIS;
+
+VOID
+BenchSetTraceLevel(
+	IN UCHAR Level
+)
+{
+	gBenchTraceLevel = Level;
+}
+
+VOID
+BenchTrace(
+	IN UCHAR Level,
+	IN PCSTR Format,
+	...
+)
+{
+	va_list args;
+
+	if (Level > gBenchTraceLevel)
+		return;
+
+	va_start(args, Format);
+	vfprintf(stderr, Format, args);
+	va_end(args);
+
+	fputc('\n', stderr);
+}
+
+ULONGLONG
+KeQueryInterruptTime(
+	VOID
+)
+{
+	return gBenchInterruptTime;
+}
+
+ULONGLONG
+KeQueryInterruptTimePrecise(
+	OUT PULONG64 QpcTimeStamp
+)
+{
+	*QpcTimeStamp = gBenchInterruptTime;
+
+	return gBenchInterruptTime;
+}
+
+PVOID
+ExAllocatePoolWithTag(
+	IN POOL_TYPE PoolType,
+	IN SIZE_T NumberOfBytes,
+	IN ULONG Tag
+)
+{
+	UNREFERENCED_PARAMETER(PoolType);
+	UNREFERENCED_PARAMETER(Tag);
+
+	return malloc(NumberOfBytes);
+}
+
+VOID
+ExFreePoolWithTag(
+	IN PVOID P,
+	IN ULONG Tag
+)
+{
+	UNREFERENCED_PARAMETER(Tag);
+
+	free(P);
+}
+
+NTSTATUS
+RtlQueryRegistryValues(
+	IN ULONG RelativeTo,
+	IN PCWSTR Path,
+	IN PRTL_QUERY_REGISTRY_TABLE QueryTable,
+	IN PVOID Context OPTIONAL,
+	IN PVOID Environment OPTIONAL
+)
+{
+	UNREFERENCED_PARAMETER(RelativeTo);
+	UNREFERENCED_PARAMETER(Path);
+	UNREFERENCED_PARAMETER(QueryTable);
+	UNREFERENCED_PARAMETER(Context);
+	UNREFERENCED_PARAMETER(Environment);
+
+	return STATUS_OBJECT_NAME_NOT_FOUND;
+}
+
+static NTSTATUS
+BenchWdfObjectCreate(
+	IN PWDF_OBJECT_ATTRIBUTES Attributes OPTIONAL,
+	OUT BENCH_WDF_OBJECT** Object
+)
+{
+	BENCH_WDF_OBJECT* object;
+
+	object = (BENCH_WDF_OBJECT*)calloc(1, sizeof(BENCH_WDF_OBJECT));
+
+	if (object == NULL)
+		return STATUS_INSUFFICIENT_RESOURCES;
+
+	if (Attributes != NULL && Attributes->ContextTypeInfo != NULL) {
+		object->ContextTypeInfo = Attributes->ContextTypeInfo;
+		object->Context = calloc(1, Attributes->ContextTypeInfo->ContextSize);
+
+		if (object->Context == NULL) {
+			free(object);
+			return STATUS_INSUFFICIENT_RESOURCES;
+		}
+	}
+
+	object->Next = gBenchObjects;
+	gBenchObjects = object;
+
+	*Object = object;
+
+	return STATUS_SUCCESS;
+}
+
+PVOID
+BenchWdfObjectGetContext(
+	IN WDFOBJECT Handle,
+	IN PCWDF_OBJECT_CONTEXT_TYPE_INFO TypeInfo
+)
+{
+	BENCH_WDF_OBJECT* object = (BENCH_WDF_OBJECT*)Handle;
+
+	return (object->ContextTypeInfo == TypeInfo) ? object->Context : NULL;
+}
+
+VOID
+BenchDestroyObjects(
+	VOID
+)
+{
+	BENCH_WDF_OBJECT* object;
+
+	while (gBenchObjects != NULL) {
+		object = gBenchObjects;
+		gBenchObjects = object->Next;
+
+		free(object->Context);
+		free(object);
+	}
+}
+
+NTSTATUS
+WdfTimerCreate(
+	IN PWDF_TIMER_CONFIG Config,
+	IN PWDF_OBJECT_ATTRIBUTES Attributes,
+	OUT WDFTIMER* Timer
+)
+{
+	BENCH_WDF_OBJECT* object;
+	NTSTATUS status;
+
+	status = BenchWdfObjectCreate(Attributes, &object);
+
+	if (!NT_SUCCESS(status))
+		return status;
+
+	object->EvtTimerFunc = Config->EvtTimerFunc;
+
+	*Timer = (WDFTIMER)object;
+
+	return STATUS_SUCCESS;
+}
+
+BOOLEAN
+WdfTimerStart(
+	IN WDFTIMER Timer,
+	IN LONGLONG DueTime
+)
+{
+	BENCH_WDF_OBJECT* object = (BENCH_WDF_OBJECT*)Timer;
+	BOOLEAN armed = object->TimerArmed;
+
+	//
+	// Negative due times are relative, positive ones are taken as
+	// absolute interrupt times
+	//
+	object->TimerDueTime = (DueTime < 0) ?
+		gBenchInterruptTime + (ULONG64)(-DueTime) : (ULONG64)DueTime;
+	object->TimerArmed = TRUE;
+
+	return armed;
+}
+
+NTSTATUS
+WdfSpinLockCreate(
+	IN PWDF_OBJECT_ATTRIBUTES SpinLockAttributes OPTIONAL,
+	OUT WDFSPINLOCK* SpinLock
+)
+{
+	BENCH_WDF_OBJECT* object;
+	NTSTATUS status;
+
+	status = BenchWdfObjectCreate(SpinLockAttributes, &object);
+
+	if (!NT_SUCCESS(status))
+		return status;
+
+	*SpinLock = (WDFSPINLOCK)object;
+
+	return STATUS_SUCCESS;
+}
+
+VOID
+WdfSpinLockAcquire(
+	IN WDFSPINLOCK SpinLock
+)
+{
+	BENCH_WDF_OBJECT* object = (BENCH_WDF_OBJECT*)SpinLock;
+
+	NT_ASSERT(object->LockDepth == 0);
+	object->LockDepth++;
+}
+
+VOID
+WdfSpinLockRelease(
+	IN WDFSPINLOCK SpinLock
+)
+{
+	BENCH_WDF_OBJECT* object = (BENCH_WDF_OBJECT*)SpinLock;
+
+	NT_ASSERT(object->LockDepth == 1);
+	object->LockDepth--;
+}
+
+VOID
+BenchAdvanceInterruptTime(
+	IN ULONG64 Time
+)
+{
+	BENCH_WDF_OBJECT* object;
+	BENCH_WDF_OBJECT* next;
+
+	for (;;) {
+		next = NULL;
+
+		for (object = gBenchObjects; object != NULL; object = object->Next) {
+			if (object->TimerArmed &&
+				object->TimerDueTime <= Time &&
+				(next == NULL || object->TimerDueTime < next->TimerDueTime))
+				next = object;
+		}
+
+		if (next == NULL)
+			break;
+
+		if (next->TimerDueTime > gBenchInterruptTime)
+			gBenchInterruptTime = next->TimerDueTime;
+
+		next->TimerArmed = FALSE;
+		next->EvtTimerFunc((WDFTIMER)next);
+	}
+
+	if (Time > gBenchInterruptTime)
+		gBenchInterruptTime = Time;
+}
+
+VOID
+BenchResetReports(
+	IN FILE* Stream OPTIONAL
+)
+{
+	gBenchReportStream = Stream;
+	gBenchReportCount = 0;
+	gBenchReportHash = BENCH_FNV_OFFSET_BASIS;
+}
+
+ULONG64
+BenchGetReportCount(
+	VOID
+)
+{
+	return gBenchReportCount;
+}
+
+ULONG64
+BenchGetReportHash(
+	VOID
+)
+{
+	return gBenchReportHash;
+}
+
+NTSTATUS
+TchSendReport(
+	IN WDFQUEUE PingPongQueue,
+	IN PHID_REPORT_RING ReportRing,
+	IN PHID_INPUT_REPORT hidReportFromDriver,
+	IN BOOLEAN Coalescable
+)
+{
+	const UCHAR* bytes = (const UCHAR*)hidReportFromDriver;
+	ULONG i;
+
+	UNREFERENCED_PARAMETER(PingPongQueue);
+	UNREFERENCED_PARAMETER(ReportRing);
+	UNREFERENCED_PARAMETER(Coalescable);
+
+	for (i = 0; i < sizeof(HID_INPUT_REPORT); i++) {
+		gBenchReportHash ^= bytes[i];
+		gBenchReportHash *= BENCH_FNV_PRIME;
+	}
+
+	gBenchReportCount++;
+
+	if (gBenchReportStream != NULL)
+		fwrite(hidReportFromDriver, sizeof(HID_INPUT_REPORT), 1, gBenchReportStream);
+
+	return STATUS_SUCCESS;
+}
+
+NTSTATUS
+TchSendReportFrame(
+	IN WDFQUEUE PingPongQueue,
+	IN PHID_REPORT_RING ReportRing,
+	IN PHID_INPUT_REPORT Reports,
+	IN ULONG ReportCount,
+	IN BOOLEAN Coalescable
+)
+{
+	ULONG i;
+
+	for (i = 0; i < ReportCount; i++)
+		TchSendReport(PingPongQueue, ReportRing, &Reports[i], Coalescable);
+
+	return STATUS_SUCCESS;
+}
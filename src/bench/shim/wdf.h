@@ -0,0 +1,5 @@
+#pragma once
+
+//
+// Everything the bench needs from wdf.h is provided by the shim wdm.h
+//
@@ -0,0 +1,256 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		wdm.h
+
+	Abstract:
+
+		Stands in for the kernel and framework headers when the frame
+		pipeline (ftparse.c, report.c, resolutions.c) is built into the
+		user-mode replay bench. Only what those files use is provided,
+		the routines are implemented in shim.c.
+
+	Environment:
+
+		User mode
+
+	Revision History:
+
+--*/
+
+#pragma once
+
+#define WIN32_NO_STATUS
+#include <windows.h>
+#undef WIN32_NO_STATUS
+#include <ntstatus.h>
+#include <evntrace.h>
+#include <assert.h>
+
+typedef LONG NTSTATUS;
+
+#define NT_SUCCESS(Status)      (((NTSTATUS)(Status)) >= 0)
+#define NT_ASSERT(Expression)   assert(Expression)
+
+//
+// WPP is not run on the bench, traces at or below the level set with
+// BenchSetTraceLevel go to stderr. The flags are dropped as WPP defines
+// them in the .tmh files.
+//
+VOID
+BenchTrace(
+	IN UCHAR Level,
+	IN PCSTR Format,
+	...
+);
+
+#define Trace(Level, Flags, ...)    BenchTrace((Level), __VA_ARGS__)
+
+//
+// Interrupt time follows the virtual clock of the replay, so that a trace
+// replays to the same reports on every run
+//
+ULONGLONG
+KeQueryInterruptTime(
+	VOID
+);
+
+ULONGLONG
+KeQueryInterruptTimePrecise(
+	OUT PULONG64 QpcTimeStamp
+);
+
+typedef enum _POOL_TYPE
+{
+	NonPagedPool = 0,
+	PagedPool = 1,
+	NonPagedPoolNx = 512
+} POOL_TYPE;
+
+PVOID
+ExAllocatePoolWithTag(
+	IN POOL_TYPE PoolType,
+	IN SIZE_T NumberOfBytes,
+	IN ULONG Tag
+);
+
+VOID
+ExFreePoolWithTag(
+	IN PVOID P,
+	IN ULONG Tag
+);
+
+//
+// Registry queries always fail, leaving the defaults in place
+//
+#define RTL_REGISTRY_ABSOLUTE       0
+#define RTL_QUERY_REGISTRY_DIRECT   0x00000020
+
+typedef NTSTATUS
+(NTAPI* PRTL_QUERY_REGISTRY_ROUTINE)(
+	IN PWSTR ValueName,
+	IN ULONG ValueType,
+	IN PVOID ValueData,
+	IN ULONG ValueLength,
+	IN PVOID Context,
+	IN PVOID EntryContext
+);
+
+typedef struct _RTL_QUERY_REGISTRY_TABLE
+{
+	PRTL_QUERY_REGISTRY_ROUTINE QueryRoutine;
+	ULONG Flags;
+	PWSTR Name;
+	PVOID EntryContext;
+	ULONG DefaultType;
+	PVOID DefaultData;
+	ULONG DefaultLength;
+} RTL_QUERY_REGISTRY_TABLE, * PRTL_QUERY_REGISTRY_TABLE;
+
+NTSTATUS
+RtlQueryRegistryValues(
+	IN ULONG RelativeTo,
+	IN PCWSTR Path,
+	IN PRTL_QUERY_REGISTRY_TABLE QueryTable,
+	IN PVOID Context OPTIONAL,
+	IN PVOID Environment OPTIONAL
+);
+
+//
+// Framework handles. Objects are created by the shim, the report code
+// only ever passes them back to it.
+//
+typedef PVOID WDFOBJECT;
+
+typedef struct WDFDEVICE__* WDFDEVICE;
+typedef struct WDFQUEUE__* WDFQUEUE;
+typedef struct WDFREQUEST__* WDFREQUEST;
+typedef struct WDFMEMORY__* WDFMEMORY;
+typedef struct WDFIOTARGET__* WDFIOTARGET;
+typedef struct WDFINTERRUPT__* WDFINTERRUPT;
+typedef struct WDFFILEOBJECT__* WDFFILEOBJECT;
+typedef struct WDFTIMER__* WDFTIMER;
+typedef struct WDFSPINLOCK__* WDFSPINLOCK;
+typedef struct WDFWAITLOCK__* WDFWAITLOCK;
+
+typedef enum _WDF_TRI_STATE
+{
+	WdfFalse = FALSE,
+	WdfTrue = TRUE,
+	WdfUseDefault = 2
+} WDF_TRI_STATE;
+
+typedef struct _WDF_OBJECT_CONTEXT_TYPE_INFO
+{
+	ULONG Size;
+	PCSTR ContextName;
+	size_t ContextSize;
+} WDF_OBJECT_CONTEXT_TYPE_INFO, * PWDF_OBJECT_CONTEXT_TYPE_INFO;
+
+typedef const WDF_OBJECT_CONTEXT_TYPE_INFO* PCWDF_OBJECT_CONTEXT_TYPE_INFO;
+
+typedef struct _WDF_OBJECT_ATTRIBUTES
+{
+	ULONG Size;
+	WDFOBJECT ParentObject;
+	size_t ContextSizeOverride;
+	PCWDF_OBJECT_CONTEXT_TYPE_INFO ContextTypeInfo;
+} WDF_OBJECT_ATTRIBUTES, * PWDF_OBJECT_ATTRIBUTES;
+
+FORCEINLINE
+VOID
+WDF_OBJECT_ATTRIBUTES_INIT(
+	OUT PWDF_OBJECT_ATTRIBUTES Attributes
+)
+{
+	RtlZeroMemory(Attributes, sizeof(WDF_OBJECT_ATTRIBUTES));
+	Attributes->Size = sizeof(WDF_OBJECT_ATTRIBUTES);
+}
+
+PVOID
+BenchWdfObjectGetContext(
+	IN WDFOBJECT Handle,
+	IN PCWDF_OBJECT_CONTEXT_TYPE_INFO TypeInfo
+);
+
+#define WDF_TYPE_NAME_TO_TYPE_INFO(_contexttype) \
+	WDF_##_contexttype##_TYPE_INFO
+
+#define WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(_attributes, _contexttype) \
+	(_attributes)->ContextTypeInfo = &WDF_TYPE_NAME_TO_TYPE_INFO(_contexttype)
+
+#define WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(_contexttype, _castingfunction) \
+	static const WDF_OBJECT_CONTEXT_TYPE_INFO WDF_TYPE_NAME_TO_TYPE_INFO(_contexttype) = \
+	{ \
+		sizeof(WDF_OBJECT_CONTEXT_TYPE_INFO), \
+		#_contexttype, \
+		sizeof(_contexttype) \
+	}; \
+	FORCEINLINE _contexttype* _castingfunction(WDFOBJECT Handle) \
+	{ \
+		return (_contexttype*)BenchWdfObjectGetContext( \
+			Handle, \
+			&WDF_TYPE_NAME_TO_TYPE_INFO(_contexttype)); \
+	}
+
+typedef
+VOID
+EVT_WDF_TIMER(
+	IN WDFTIMER Timer
+);
+
+typedef EVT_WDF_TIMER* PFN_WDF_TIMER;
+
+typedef struct _WDF_TIMER_CONFIG
+{
+	ULONG Size;
+	PFN_WDF_TIMER EvtTimerFunc;
+	ULONG Period;
+	BOOLEAN AutomaticSerialization;
+	ULONG TolerableDelay;
+	WDF_TRI_STATE UseHighResolutionTimer;
+} WDF_TIMER_CONFIG, * PWDF_TIMER_CONFIG;
+
+FORCEINLINE
+VOID
+WDF_TIMER_CONFIG_INIT(
+	OUT PWDF_TIMER_CONFIG Config,
+	IN PFN_WDF_TIMER EvtTimerFunc
+)
+{
+	RtlZeroMemory(Config, sizeof(WDF_TIMER_CONFIG));
+	Config->Size = sizeof(WDF_TIMER_CONFIG);
+	Config->EvtTimerFunc = EvtTimerFunc;
+	Config->AutomaticSerialization = TRUE;
+}
+
+NTSTATUS
+WdfTimerCreate(
+	IN PWDF_TIMER_CONFIG Config,
+	IN PWDF_OBJECT_ATTRIBUTES Attributes,
+	OUT WDFTIMER* Timer
+);
+
+BOOLEAN
+WdfTimerStart(
+	IN WDFTIMER Timer,
+	IN LONGLONG DueTime
+);
+
+NTSTATUS
+WdfSpinLockCreate(
+	IN PWDF_OBJECT_ATTRIBUTES SpinLockAttributes OPTIONAL,
+	OUT WDFSPINLOCK* SpinLock
+);
+
+VOID
+WdfSpinLockAcquire(
+	IN WDFSPINLOCK SpinLock
+);
+
+VOID
+WdfSpinLockRelease(
+	IN WDFSPINLOCK SpinLock
+);
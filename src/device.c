@@ -31,12 +31,50 @@
 #include <ft5x/ftinternal.h>
 #include <report.h>
 #include <touch_power/touch_power.h>
+#include <selftest\selftest.h>
+#include <tracelog.h>
 #include <device.tmh>
 
 #ifdef ALLOC_PRAGMA
 #pragma alloc_text(PAGE, OnD0Exit)
 #endif
 
+static VOID
+TchArmInterruptWatchdog(
+    IN PDEVICE_EXTENSION DeviceContext
+)
+/*++
+
+  Routine Description:
+
+    Starts the lost-interrupt watchdog if contacts are down after a frame
+    was serviced and it is not already running.
+
+  Arguments:
+
+    DeviceContext - device context
+
+  Return Value:
+
+    None
+
+--*/
+{
+    if (DeviceContext->WatchdogTimer == NULL ||
+        DeviceContext->WatchdogTimeout == 0 ||
+        DeviceContext->WatchdogArmed != 0 ||
+        DeviceContext->WatchdogStopped != 0 ||
+        DeviceContext->ReportContext->Cache.DownCount == 0)
+    {
+        return;
+    }
+
+    if (InterlockedExchange(&DeviceContext->WatchdogArmed, 1) == 0)
+    {
+        WdfTimerStart(DeviceContext->WatchdogTimer, -DeviceContext->WatchdogTimeout);
+    }
+}
+
 BOOLEAN
 OnInterruptIsr(
     IN WDFINTERRUPT Interrupt,
@@ -67,28 +105,66 @@ OnInterruptIsr(
 {
     PDEVICE_EXTENSION devContext;
     NTSTATUS status;
+    ULONG64 qpcTimeStamp;
 
     UNREFERENCED_PARAMETER(MessageID);
 
-    Trace(
-        TRACE_LEVEL_ERROR,
-        TRACE_REPORTING,
-        "OnInterruptIsr - Entry");
+    devContext = GetDeviceContext(WdfInterruptGetDevice(Interrupt));
+
+    //
+    // Timestamp the frame before anything else, the scan time reported to
+    // HIDClass should not include the time taken to read the frame
+    //
+    WriteNoFence64(
+        &devContext->ReportContext->InterruptTime,
+        (LONG64)KeQueryInterruptTimePrecise(&qpcTimeStamp));
 
     status = STATUS_SUCCESS;
-    devContext = GetDeviceContext(WdfInterruptGetDevice(Interrupt));
 
     //
     // For performance tracing, write an ETW event marker
     //
-    //EventWriteTouchIsr(&TouchMiniDriverControlGuid);
+    TchTraceInterrupt((ULONG64)devContext->ReportContext->InterruptTime);
 
     //
     // If we're in diagnostic mode, let the diagnostic application handle
-    // interrupt servicing
+    // interrupt servicing, feeding it the frame if it is streaming them
     //
     if (devContext->DiagnosticMode != FALSE)
     {
+        TchSelfTestServiceRawStream(devContext);
+        goto exit;
+    }
+
+    InterlockedIncrement(&devContext->InterruptsReceived);
+
+    //
+    // With a service thread, latch the frame and wake the thread, which
+    // collapses the interrupts it did not get to the same way
+    //
+    if (devContext->ServiceThread.Thread != NULL)
+    {
+        if (InterlockedExchange(&devContext->FramePending, 1) != 0)
+        {
+            InterlockedIncrement(&devContext->InterruptsCollapsed);
+        }
+
+        KeSetEvent(&devContext->ServiceThread.Wake, IO_NO_INCREMENT, FALSE);
+        goto exit;
+    }
+
+    //
+    // When coalescing, only latch the frame and let the work item read it.
+    // Interrupts arriving before the work item runs collapse into one read.
+    //
+    if (devContext->CoalesceInterrupts != FALSE)
+    {
+        if (InterlockedExchange(&devContext->FramePending, 1) != 0)
+        {
+            InterlockedIncrement(&devContext->InterruptsCollapsed);
+        }
+
+        WdfInterruptQueueWorkItemForIsr(Interrupt);
         goto exit;
     }
 
@@ -98,7 +174,7 @@ OnInterruptIsr(
     status = Ft5xServiceInterrupts(
         devContext->TouchContext,
         &devContext->I2CContext,
-        &devContext->ReportContext);
+        devContext->ReportContext);
 
     if (!NT_SUCCESS(status))
     {
@@ -110,10 +186,535 @@ OnInterruptIsr(
         goto exit;
     }
 
+    TchArmInterruptWatchdog(devContext);
+
 exit:
     return TRUE;
 }
 
+static VOID
+TchServiceLatchedFrames(
+    IN PDEVICE_EXTENSION DeviceContext
+)
+/*++
+
+  Routine Description:
+
+    Services the frames latched by OnInterruptIsr. Every pass reads the
+    controller's latest frame, so any number of interrupts latched
+    before a pass cost a single read.
+
+  Arguments:
+
+    DeviceContext - device context
+
+  Return Value:
+
+    None
+
+--*/
+{
+    NTSTATUS status;
+
+    //
+    // Serialize with TchReadReport, which services interrupts from a
+    // read request under the same lock
+    //
+    WdfInterruptAcquireLock(DeviceContext->InterruptObject);
+
+    while (InterlockedExchange(&DeviceContext->FramePending, 0) != 0)
+    {
+        if (DeviceContext->DiagnosticMode != FALSE)
+        {
+            break;
+        }
+
+        InterlockedIncrement(&DeviceContext->FramesServiced);
+
+        status = Ft5xServiceInterrupts(
+            DeviceContext->TouchContext,
+            &DeviceContext->I2CContext,
+            DeviceContext->ReportContext);
+
+        if (!NT_SUCCESS(status))
+        {
+            Trace(
+                TRACE_LEVEL_ERROR,
+                TRACE_REPORTING,
+                "Error servicing coalesced interrupts - 0x%08lX",
+                status);
+        }
+    }
+
+    WdfInterruptReleaseLock(DeviceContext->InterruptObject);
+
+    TchArmInterruptWatchdog(DeviceContext);
+}
+
+VOID
+OnInterruptWorkItem(
+    IN WDFINTERRUPT Interrupt,
+    IN WDFOBJECT AssociatedObject
+)
+/*++
+
+  Routine Description:
+
+    Services the frames latched by OnInterruptIsr when interrupt
+    coalescing is enabled.
+
+  Arguments:
+
+    Interrupt - a handle to a framework interrupt object
+    AssociatedObject - the framework device object
+
+  Return Value:
+
+    None
+
+--*/
+{
+    UNREFERENCED_PARAMETER(AssociatedObject);
+
+    TchServiceLatchedFrames(GetDeviceContext(WdfInterruptGetDevice(Interrupt)));
+}
+
+KSTART_ROUTINE TchServiceThreadRoutine;
+
+VOID
+TchServiceThreadRoutine(
+    IN PVOID Context
+)
+/*++
+
+  Routine Description:
+
+    Body of the dedicated servicing thread. It takes the configured
+    priority and affinity, then services the frames latched by
+    OnInterruptIsr every time the ISR wakes it, until it is stopped.
+
+  Arguments:
+
+    Context - device context
+
+  Return Value:
+
+    None
+
+--*/
+{
+    PDEVICE_EXTENSION devContext;
+    TOUCH_SERVICE_THREAD* service;
+
+    devContext = (PDEVICE_EXTENSION)Context;
+    service = &devContext->ServiceThread;
+
+    KeSetPriorityThread(KeGetCurrentThread(), service->Priority);
+
+    if (service->Affinity.Mask != 0)
+    {
+        KeSetSystemGroupAffinityThread(&service->Affinity, NULL);
+    }
+
+    for (;;)
+    {
+        KeWaitForSingleObject(&service->Wake, Executive, KernelMode, FALSE, NULL);
+
+        if (service->Stopping != 0)
+        {
+            break;
+        }
+
+        TchServiceLatchedFrames(devContext);
+    }
+
+    PsTerminateSystemThread(STATUS_SUCCESS);
+}
+
+static NTSTATUS
+TchStartServiceThread(
+    IN PDEVICE_EXTENSION DeviceContext
+)
+/*++
+
+  Routine Description:
+
+    Starts the dedicated servicing thread if the ServiceThreadEnabled
+    setting is on. The thread runs at ServiceThreadPriority, by default
+    the lowest real-time priority, on the processors the interrupt
+    targets, narrowed to ServiceThreadAffinityMask if that leaves any.
+
+    Like coalescing, this relies on the controller pulsing its interrupt
+    line per frame, a level-triggered line is serviced from the ISR.
+
+  Arguments:
+
+    DeviceContext - device context
+
+  Return Value:
+
+    NTSTATUS indicating success or failure
+
+--*/
+{
+    TOUCH_SCREEN_SETTINGS* settings;
+    TOUCH_SERVICE_THREAD* service;
+    WDF_INTERRUPT_INFO interruptInfo;
+    OBJECT_ATTRIBUTES threadAttributes;
+    HANDLE threadHandle;
+    KAFFINITY mask;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    settings = &((FT5X_CONTROLLER_CONTEXT*)DeviceContext->TouchContext)->TouchSettings;
+    service = &DeviceContext->ServiceThread;
+
+    if (settings->ServiceThreadEnabled == 0 ||
+        service->Thread != NULL)
+    {
+        goto exit;
+    }
+
+    WDF_INTERRUPT_INFO_INIT(&interruptInfo);
+    WdfInterruptGetInfo(DeviceContext->InterruptObject, &interruptInfo);
+
+    if (interruptInfo.Mode != Latched)
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_INIT,
+            "Service thread requested on a level-triggered interrupt, ignoring");
+
+        goto exit;
+    }
+
+    service->Priority = LOW_REALTIME_PRIORITY;
+
+    if (settings->ServiceThreadPriority != 0)
+    {
+        service->Priority = (KPRIORITY)min(settings->ServiceThreadPriority, (UINT32)HIGH_PRIORITY);
+    }
+
+    service->Affinity.Group = interruptInfo.Group;
+    service->Affinity.Mask = interruptInfo.TargetProcessorSet &
+        KeQueryGroupAffinity(interruptInfo.Group);
+
+    mask = service->Affinity.Mask & (KAFFINITY)settings->ServiceThreadAffinityMask;
+
+    if (mask != 0)
+    {
+        service->Affinity.Mask = mask;
+    }
+
+    service->Stopping = 0;
+    KeInitializeEvent(&service->Wake, SynchronizationEvent, FALSE);
+
+    InitializeObjectAttributes(
+        &threadAttributes,
+        NULL,
+        OBJ_KERNEL_HANDLE,
+        NULL,
+        NULL);
+
+    status = PsCreateSystemThread(
+        &threadHandle,
+        THREAD_ALL_ACCESS,
+        &threadAttributes,
+        NULL,
+        NULL,
+        TchServiceThreadRoutine,
+        DeviceContext);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_INIT,
+            "Error creating interrupt service thread - 0x%08lX",
+            status);
+
+        goto exit;
+    }
+
+    status = ObReferenceObjectByHandle(
+        threadHandle,
+        THREAD_ALL_ACCESS,
+        *PsThreadType,
+        KernelMode,
+        (PVOID*)&service->Thread,
+        NULL);
+
+    ZwClose(threadHandle);
+
+    if (!NT_SUCCESS(status))
+    {
+        //
+        // The thread cannot be waited for without its object, it has not
+        // serviced anything yet so let it go
+        //
+        service->Thread = NULL;
+        InterlockedExchange(&service->Stopping, 1);
+        KeSetEvent(&service->Wake, IO_NO_INCREMENT, FALSE);
+
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_INIT,
+            "Error referencing interrupt service thread - 0x%08lX",
+            status);
+
+        goto exit;
+    }
+
+    Trace(
+        TRACE_LEVEL_INFORMATION,
+        TRACE_INIT,
+        "Interrupt service thread at priority %ld, group %u affinity 0x%I64x",
+        (LONG)service->Priority,
+        (ULONG)service->Affinity.Group,
+        (ULONG64)service->Affinity.Mask);
+
+exit:
+    return status;
+}
+
+static VOID
+TchStopServiceThread(
+    IN PDEVICE_EXTENSION DeviceContext
+)
+/*++
+
+  Routine Description:
+
+    Stops the dedicated servicing thread and waits for it to exit.
+    Must be called at PASSIVE_LEVEL with interrupts disabled.
+
+  Arguments:
+
+    DeviceContext - device context
+
+  Return Value:
+
+    None
+
+--*/
+{
+    TOUCH_SERVICE_THREAD* service;
+
+    service = &DeviceContext->ServiceThread;
+
+    if (service->Thread == NULL)
+    {
+        return;
+    }
+
+    InterlockedExchange(&service->Stopping, 1);
+    KeSetEvent(&service->Wake, IO_NO_INCREMENT, FALSE);
+
+    KeWaitForSingleObject(service->Thread, Executive, KernelMode, FALSE, NULL);
+
+    ObDereferenceObject(service->Thread);
+    service->Thread = NULL;
+}
+
+EVT_WDF_TIMER OnInterruptWatchdogTimer;
+
+VOID
+OnInterruptWatchdogTimer(
+    IN WDFTIMER Timer
+)
+/*++
+
+  Routine Description:
+
+    Runs at PASSIVE_LEVEL once no interrupt may have arrived for
+    InterruptWatchdogMs while contacts were down. If an interrupt came
+    in the meantime, the timer is rearmed for the remainder. Otherwise
+    the interrupt is taken as lost and the controller's frame is read
+    as the ISR would, then again every TOUCH_WATCHDOG_POLL_INTERVAL
+    until interrupts come back or the contacts are up.
+
+  Arguments:
+
+    Timer - Handle to the watchdog timer
+
+  Return Value:
+
+    None
+
+--*/
+{
+    PDEVICE_EXTENSION devContext;
+    ULONG64 qpcTimeStamp;
+    LONG64 lastInterruptTime;
+    LONG64 timeout;
+    LONG64 idleTime;
+    LONG64 now;
+
+    devContext = GetDeviceContext(WdfTimerGetParentObject(Timer));
+
+    if (devContext->WatchdogStopped != 0 ||
+        devContext->DiagnosticMode != FALSE)
+    {
+        InterlockedExchange(&devContext->WatchdogArmed, 0);
+        return;
+    }
+
+    if (devContext->ReportContext->Cache.DownCount == 0)
+    {
+        InterlockedExchange(&devContext->WatchdogArmed, 0);
+
+        //
+        // Contacts that went down while the timer was still marked armed
+        // did not start it, pick them up before disarming
+        //
+        if (devContext->ReportContext->Cache.DownCount != 0 &&
+            InterlockedExchange(&devContext->WatchdogArmed, 1) == 0)
+        {
+            WdfTimerStart(Timer, -devContext->WatchdogTimeout);
+        }
+
+        return;
+    }
+
+    //
+    // While recovering, the last frame time is the one of the last poll
+    // and the next poll is due one poll interval later
+    //
+    lastInterruptTime = ReadNoFence64(&devContext->ReportContext->InterruptTime);
+    timeout = (lastInterruptTime == devContext->WatchdogPollTime) ?
+        TOUCH_WATCHDOG_POLL_INTERVAL : devContext->WatchdogTimeout;
+    idleTime = (LONG64)KeQueryInterruptTime() - lastInterruptTime;
+
+    if (idleTime < timeout)
+    {
+        WdfTimerStart(Timer, -(timeout - idleTime));
+        return;
+    }
+
+    if (lastInterruptTime != devContext->WatchdogPollTime)
+    {
+        InterlockedIncrement(&devContext->WatchdogStalls);
+
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_INTERRUPT,
+            "No interrupt for %lu ms with contacts down, polling the controller",
+            (ULONG)(idleTime / 10000));
+    }
+
+    //
+    // Serialize with the ISR as TchReadReport does, the poll shares the
+    // controller frame buffer
+    //
+    WdfInterruptAcquireLock(devContext->InterruptObject);
+
+    if (devContext->DiagnosticMode == FALSE)
+    {
+        now = (LONG64)KeQueryInterruptTimePrecise(&qpcTimeStamp);
+        WriteNoFence64(&devContext->ReportContext->InterruptTime, now);
+        devContext->WatchdogPollTime = now;
+
+        InterlockedIncrement(&devContext->WatchdogPolls);
+
+        Ft5xServiceInterrupts(
+            devContext->TouchContext,
+            &devContext->I2CContext,
+            devContext->ReportContext);
+    }
+
+    WdfInterruptReleaseLock(devContext->InterruptObject);
+
+    if (devContext->ReportContext->Cache.DownCount != 0)
+    {
+        WdfTimerStart(Timer, -TOUCH_WATCHDOG_POLL_INTERVAL);
+        return;
+    }
+
+    InterlockedExchange(&devContext->WatchdogArmed, 0);
+}
+
+static NTSTATUS
+TchConfigureInterruptWatchdog(
+    IN PDEVICE_EXTENSION DeviceContext
+)
+/*++
+
+  Routine Description:
+
+    Sets up the lost-interrupt watchdog from the InterruptWatchdogMs
+    setting. Nothing is set up if the setting is zero or continuous
+    reporting is simulated, since held contacts then look the same as a
+    lost interrupt. The timer is created once, the timeout is taken again
+    on every start.
+
+  Arguments:
+
+    DeviceContext - device context
+
+  Return Value:
+
+    NTSTATUS indicating success or failure
+
+--*/
+{
+    WDF_TIMER_CONFIG timerConfig;
+    WDF_OBJECT_ATTRIBUTES attributes;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    DeviceContext->WatchdogTimeout = (LONG64)
+        ((FT5X_CONTROLLER_CONTEXT*)DeviceContext->TouchContext)->TouchSettings.InterruptWatchdogMs * 10000;
+
+    if (DeviceContext->WatchdogTimeout != 0 &&
+        DeviceContext->ReportContext->Props.TouchHardwareLacksContinuousReporting)
+    {
+        Trace(
+            TRACE_LEVEL_INFORMATION,
+            TRACE_INIT,
+            "Continuous reporting is simulated, interrupt watchdog disabled");
+
+        DeviceContext->WatchdogTimeout = 0;
+    }
+
+    if (DeviceContext->WatchdogTimeout == 0 ||
+        DeviceContext->WatchdogTimer != NULL)
+    {
+        goto exit;
+    }
+
+    //
+    // Polling reads the controller over SPB under the passive-level
+    // interrupt lock, so the timer runs at PASSIVE_LEVEL
+    //
+    WDF_TIMER_CONFIG_INIT(&timerConfig, OnInterruptWatchdogTimer);
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = DeviceContext->FxDevice;
+    attributes.ExecutionLevel = WdfExecutionLevelPassive;
+
+    status = WdfTimerCreate(
+        &timerConfig,
+        &attributes,
+        &DeviceContext->WatchdogTimer);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_INIT,
+            "Error creating interrupt watchdog timer - 0x%08lX",
+            status);
+
+        goto exit;
+    }
+
+exit:
+    return status;
+}
+
+static VOID
+TchResetController(
+    IN PDEVICE_EXTENSION DeviceContext
+);
+
 NTSTATUS
 OnD0Entry(
     IN WDFDEVICE Device,
@@ -143,6 +744,16 @@ Return Value:
 
     UNREFERENCED_PARAMETER(PreviousState);
 
+    //
+    // Only a reset brings a hibernated controller back, the wake then
+    // restores its configuration
+    //
+    if (devContext->Configuration.HasResetGpio &&
+        ((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->DevicePowerState == PowerDeviceD3)
+    {
+        TchResetController(devContext);
+    }
+
     status = TchWakeDevice(devContext->TouchContext, &devContext->I2CContext);
 
     if (!NT_SUCCESS(status))
@@ -161,6 +772,11 @@ Return Value:
     //
     devContext->ServiceInterruptsAfterD0Entry = TRUE;
 
+    //
+    // The watchdog is started by the first frames with contacts down
+    //
+    InterlockedExchange(&devContext->WatchdogStopped, 0);
+
     //
     // Complete any pending Idle IRPs
     //
@@ -194,14 +810,55 @@ Return Value:
 {
     NTSTATUS status;
     PDEVICE_EXTENSION devContext;
+    BOOLEAN runtimeIdle;
+    BOOLEAN hibernate;
 
     PAGED_CODE();
 
     devContext = GetDeviceContext(Device);
 
-    UNREFERENCED_PARAMETER(TargetState);
+    //
+    // Drop frames latched for the service thread and wait out a pass in
+    // progress, the controller is about to sleep
+    //
+    if (devContext->ServiceThread.Thread != NULL)
+    {
+        InterlockedExchange(&devContext->FramePending, 0);
+        WdfInterruptAcquireLock(devContext->InterruptObject);
+        WdfInterruptReleaseLock(devContext->InterruptObject);
+    }
 
-    status = TchStandbyDevice(devContext->TouchContext, &devContext->I2CContext, &devContext->ReportContext);
+    //
+    // Interrupts are disabled now, stop the watchdog polling for them
+    // and wait for a poll in progress before the controller sleeps
+    //
+    if (devContext->WatchdogTimer != NULL)
+    {
+        InterlockedExchange(&devContext->WatchdogStopped, 1);
+        WdfTimerStop(devContext->WatchdogTimer, TRUE);
+        InterlockedExchange(&devContext->WatchdogArmed, 0);
+    }
+
+    //
+    // HIDClass owns the power policy and idles the device out of D0 while
+    // nobody reads. For that runtime idle the controller is left in
+    // monitor mode, a touch raises its interrupt to wake the device and
+    // the way back to D0 is a single register write. Across system sleep
+    // and removal the rail may be cut, the controller is restored in full
+    // on the way back and hibernated meanwhile if a reset line can bring
+    // it back.
+    //
+    runtimeIdle = (TargetState != WdfPowerDeviceD3Final &&
+        WdfDeviceGetSystemPowerAction(Device) == PowerActionNone);
+
+    hibernate = devContext->Configuration.HasResetGpio && !runtimeIdle;
+
+    status = TchStandbyDevice(
+        devContext->TouchContext,
+        &devContext->I2CContext,
+        devContext->ReportContext,
+        runtimeIdle,
+        hibernate);
 
     if (!NT_SUCCESS(status))
     {
@@ -240,6 +897,47 @@ NTSTATUS SetGPIO(WDFIOTARGET gpio, unsigned char* value)
     return status;
 }
 
+static VOID
+TchResetController(
+    IN PDEVICE_EXTENSION DeviceContext
+)
+/*++
+
+  Routine Description:
+
+    Holds the controller's reset line low for the rail stable time and
+    releases it. The controller then boots, the caller waits for it to
+    answer. Must be called at PASSIVE_LEVEL.
+
+  Arguments:
+
+    DeviceContext - device context
+
+  Return Value:
+
+    None
+
+--*/
+{
+    LARGE_INTEGER delay;
+    unsigned char value;
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Setting reset gpio pin to low");
+
+    value = 0;
+    SetGPIO(DeviceContext->Configuration.ResetGpio, &value);
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Waiting...");
+
+    delay.QuadPart = -10 * TOUCH_POWER_RAIL_STABLE_TIME;
+    KeDelayExecutionThread(KernelMode, TRUE, &delay);
+
+    Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Setting reset gpio pin to high");
+
+    value = 1;
+    SetGPIO(DeviceContext->Configuration.ResetGpio, &value);
+}
+
 NTSTATUS OpenIOTarget(PDEVICE_EXTENSION ctx, LARGE_INTEGER res, ACCESS_MASK use, WDFIOTARGET* target)
 {
     NTSTATUS status = STATUS_SUCCESS;
@@ -314,10 +1012,10 @@ OnPrepareHardware(
     NTSTATUS status;
     PCM_PARTIAL_RESOURCE_DESCRIPTOR res;
     PDEVICE_EXTENSION devContext;
+    WDF_INTERRUPT_INFO interruptInfo;
+    TOUCH_CONFIGURATION_BLOB_HEADER* configurationBlob;
     ULONG resourceCount;
     ULONG i;
-    LARGE_INTEGER delay;
-    unsigned char value;
 
     UNREFERENCED_PARAMETER(FxResourcesRaw);
 
@@ -351,12 +1049,12 @@ OnPrepareHardware(
             res->u.Connection.Class == CM_RESOURCE_CONNECTION_CLASS_GPIO &&
             res->u.Connection.Type == CM_RESOURCE_CONNECTION_TYPE_GPIO_IO)
         {
-            devContext->ResetGpioId.LowPart =
+            devContext->Configuration.ResetGpioId.LowPart =
                 res->u.Connection.IdLowPart;
-            devContext->ResetGpioId.HighPart =
+            devContext->Configuration.ResetGpioId.HighPart =
                 res->u.Connection.IdHighPart;
 
-            devContext->HasResetGpio = TRUE;
+            devContext->Configuration.HasResetGpio = TRUE;
         }
     }
 
@@ -371,9 +1069,9 @@ OnPrepareHardware(
         goto exit;
     }
 
-    if (devContext->HasResetGpio)
+    if (devContext->Configuration.HasResetGpio)
     {
-        status = OpenIOTarget(devContext, devContext->ResetGpioId, GENERIC_READ | GENERIC_WRITE, &devContext->ResetGpio);
+        status = OpenIOTarget(devContext, devContext->Configuration.ResetGpioId, GENERIC_READ | GENERIC_WRITE, &devContext->Configuration.ResetGpio);
         if (!NT_SUCCESS(status)) {
             Trace(TRACE_LEVEL_ERROR, TRACE_DRIVER, "OpenIOTarget failed for Reset GPIO 0x%x", status);
             goto exit;
@@ -381,27 +1079,7 @@ OnPrepareHardware(
 
         Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Starting bring up sequence for the controller");
 
-        Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Setting reset gpio pin to low");
-
-        value = 0;
-        SetGPIO(devContext->ResetGpio, &value);
-
-        Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Waiting...");
-
-        delay.QuadPart = -10 * TOUCH_POWER_RAIL_STABLE_TIME;
-        KeDelayExecutionThread(KernelMode, TRUE, &delay);
-
-        Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Setting reset gpio pin to high");
-
-        value = 1;
-        SetGPIO(devContext->ResetGpio, &value);
-
-        Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Waiting...");
-
-        delay.QuadPart = -10 * TOUCH_DELAY_TO_COMMUNICATE;
-        KeDelayExecutionThread(KernelMode, TRUE, &delay);
-
-        Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Done");
+        TchResetController(devContext);
     }
 
     //
@@ -420,6 +1098,29 @@ OnPrepareHardware(
         goto exit;
     }
 
+    //
+    // Coming out of reset, poll the controller instead of waiting the
+    // full TOUCH_DELAY_TO_COMMUNICATE, which only bounds the wait now
+    //
+    if (devContext->Configuration.HasResetGpio)
+    {
+        Trace(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "Waiting for the controller to come out of reset");
+
+        status = Ft5xWaitForReady(&devContext->I2CContext, TOUCH_DELAY_TO_COMMUNICATE);
+
+        if (!NT_SUCCESS(status))
+        {
+            Trace(
+                TRACE_LEVEL_WARNING,
+                TRACE_INIT,
+                "Controller did not answer within %lu us after reset - 0x%08lX",
+                (ULONG)TOUCH_DELAY_TO_COMMUNICATE,
+                status);
+
+            status = STATUS_SUCCESS;
+        }
+    }
+
     //
     // Initialize Touch Power so the driver can issue power state changes
     //
@@ -436,15 +1137,26 @@ OnPrepareHardware(
         goto exit;
     }
 
+    //
+    // Read the configuration blob once, its validated copy stands in for
+    // the registry values of both the screen properties and the settings
+    //
+    configurationBlob = TchLoadConfigurationBlob();
+
     //
     // Get screen properties and populate context
     //
-    TchGetScreenProperties(&devContext->ReportContext.Props);
+    TchGetScreenProperties(&devContext->ReportContext->Props, configurationBlob);
 
     //
     // Prepare the hardware for touch scanning
     //
-    status = TchAllocateContext(&devContext->TouchContext, FxDevice);
+    status = TchAllocateContext(&devContext->TouchContext, FxDevice, configurationBlob);
+
+    if (configurationBlob != NULL)
+    {
+        TchFreeConfigurationBlob(configurationBlob);
+    }
 
     if (!NT_SUCCESS(status))
     {
@@ -476,9 +1188,108 @@ OnPrepareHardware(
     }
 
     //
-    // Configure the timer for continuous simulation on synaptics hardware that doesn't support it
+    // Snapshot the settings read by the power setting callback, it then
+    // follows registry changes without reading the registry itself
+    //
+    status = TchStartSettingsWatch(devContext);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_INIT,
+            "Error starting settings watch - 0x%08lX",
+            status);
+
+        goto exit;
+    }
+
+    //
+    // Select hybrid or parallel finger reporting before HIDClass asks for
+    // the report descriptor
+    //
+    devContext->ReportContext->ParallelMode =
+        (((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->TouchSettings.ParallelReportMode != 0);
+
+    //
+    // Optional suppression of frames in which no contact moved
+    //
+    {
+        TOUCH_SCREEN_SETTINGS* settings =
+            &((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->TouchSettings;
+        ULONG keepaliveMs = settings->StationaryKeepaliveMs;
+
+        if (keepaliveMs == 0)
+        {
+            keepaliveMs = REPORT_DEFAULT_STATIONARY_KEEPALIVE_MS;
+        }
+
+        devContext->ReportContext->StationaryThreshold = settings->StationaryThreshold;
+        devContext->ReportContext->StationaryKeepalive = (LONG64)keepaliveMs * 10000;
+    }
+
+    //
+    // Interrupt coalescing relies on the controller pulsing its interrupt
+    // line per frame. A level-triggered line stays asserted until the frame
+    // is read, so it keeps being serviced directly from the ISR.
+    // The controller checks the same before reading frames asynchronously.
+    //
+    WDF_INTERRUPT_INFO_INIT(&interruptInfo);
+    WdfInterruptGetInfo(devContext->InterruptObject, &interruptInfo);
+
+    ((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->InterruptLatched =
+        (interruptInfo.Mode == Latched);
+
+    devContext->CoalesceInterrupts = FALSE;
+
+    if (((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->TouchSettings.CoalesceInterrupts != 0)
+    {
+        if (interruptInfo.Mode == Latched)
+        {
+            devContext->CoalesceInterrupts = TRUE;
+        }
+        else
+        {
+            Trace(
+                TRACE_LEVEL_WARNING,
+                TRACE_INIT,
+                "Interrupt coalescing requested on a level-triggered interrupt, ignoring");
+        }
+    }
+
+    //
+    // Optionally service frames from a thread of our own. Failing to start
+    // it is not fatal, frames are then serviced as if it were disabled.
     //
-    status = ReportConfigureContinuousSimulationTimer(devContext->FxDevice);
+    status = TchStartServiceThread(devContext);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_INIT,
+            "Interrupt service thread unavailable, servicing frames without it - 0x%08lX",
+            status);
+
+        status = STATUS_SUCCESS;
+    }
+
+    //
+    // Set up the watchdog recovering from interrupts lost with contacts down
+    //
+    status = TchConfigureInterruptWatchdog(devContext);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    //
+    // Configure the timer for continuous simulation on hardware that doesn't support it
+    //
+    status = ReportConfigureContinuousSimulationTimer(
+        devContext->FxDevice,
+        devContext->ReportContext);
 
     if (!NT_SUCCESS(status))
     {
@@ -507,12 +1318,30 @@ OnPrepareHardware(
         goto exit;
     }
 
+    //
+    // Screen properties and report mode are known now and starting the
+    // controller identified it and its contact count, so build the report
+    // descriptor HIDClass will ask for
+    //
+    status = TchBuildReportDescriptor(devContext->FxDevice);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_INIT,
+            "Error building HID report descriptor - 0x%08lX",
+            status);
+
+        goto exit;
+    }
+
     status = PoRegisterPowerSettingCallback(
         NULL,
         &GUID_ACDC_POWER_SOURCE,
         TchPowerSettingCallback,
         devContext,
-        &devContext->PoFxPowerSettingCallbackHandle1
+        &devContext->Configuration.PoFxPowerSettingCallbackHandle1
     );
 
     if (!NT_SUCCESS(status))
@@ -531,7 +1360,7 @@ OnPrepareHardware(
         &GUID_CONSOLE_DISPLAY_STATE,
         TchPowerSettingCallback,
         devContext,
-        &devContext->PoFxPowerSettingCallbackHandle2
+        &devContext->Configuration.PoFxPowerSettingCallbackHandle2
     );
 
     if (!NT_SUCCESS(status))
@@ -583,7 +1412,7 @@ OnReleaseHardware(
     devContext = GetDeviceContext(FxDevice);
 
     status = PoUnregisterPowerSettingCallback(
-        devContext->PoFxPowerSettingCallbackHandle1
+        devContext->Configuration.PoFxPowerSettingCallbackHandle1
     );
 
     if (!NT_SUCCESS(status))
@@ -596,7 +1425,7 @@ OnReleaseHardware(
     }
 
     status = PoUnregisterPowerSettingCallback(
-        devContext->PoFxPowerSettingCallbackHandle2
+        devContext->Configuration.PoFxPowerSettingCallbackHandle2
     );
 
     if (!NT_SUCCESS(status))
@@ -608,6 +1437,10 @@ OnReleaseHardware(
             status);
     }
 
+    TchStopSettingsWatch(devContext);
+
+    TchStopServiceThread(devContext);
+
     status = TchStopDevice(devContext->TouchContext, &devContext->I2CContext);
 
     if (!NT_SUCCESS(status))
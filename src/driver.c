@@ -28,8 +28,17 @@
 #include <selftest\selftest.h>
 #include <selftest\enoselftest.h>
 #include <driver.h>
+#include <tracelog.h>
 #include <driver.tmh>
 
+//
+// {31C8E366-68CA-5ECC-86BB-95D10EAEE764}, the ETW name hash of "FocalTechTouch"
+//
+TRACELOGGING_DEFINE_PROVIDER(
+    gTouchTraceLoggingProvider,
+    "FocalTechTouch",
+    (0x31c8e366, 0x68ca, 0x5ecc, 0x86, 0xbb, 0x95, 0xd1, 0x0e, 0xae, 0xe7, 0x64));
+
 #ifdef ALLOC_PRAGMA
 #pragma alloc_text(PAGE, OnDeviceAdd)
 #pragma alloc_text(PAGE, OnContextCleanup)
@@ -68,6 +77,21 @@ Return Value:
     //
     WPP_INIT_TRACING(DriverObject, RegistryPath);
 
+    //
+    // Hot path events go through TraceLogging. Without the provider they
+    // are simply not written, so a failure here is not fatal.
+    //
+    status = TraceLoggingRegister(gTouchTraceLoggingProvider);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_INIT,
+            "Error registering the TraceLogging provider - 0x%08lX",
+            status);
+    }
+
     //
     // Create a framework driver object
     //
@@ -93,6 +117,7 @@ Return Value:
             "Error creating WDF driver object - 0x%08lX",
             status);
 
+        TraceLoggingUnregister(gTouchTraceLoggingProvider);
         WPP_CLEANUP(DriverObject);
 
         goto exit;
@@ -134,6 +159,7 @@ Return Value:
     WDF_INTERRUPT_CONFIG interruptConfig;
     WDF_PNPPOWER_EVENT_CALLBACKS pnpPowerCallbacks;
     WDF_IO_QUEUE_CONFIG queueConfig;
+    WDFMEMORY reportMemory;
     NTSTATUS status;
 
     UNREFERENCED_PARAMETER(Driver);
@@ -160,6 +186,12 @@ Return Value:
 
     WdfDeviceInitSetPnpPowerEventCallbacks(DeviceInit, &pnpPowerCallbacks);
 
+    //
+    // Read requests carry their validated output buffer in their context
+    //
+    WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&attributes, HID_READ_REQUEST_CONTEXT);
+    WdfDeviceInitSetRequestAttributes(DeviceInit, &attributes);
+
     //
     // Create a framework device object. This call will in turn create
     // a WDM device object, attach to the lower stack, and set the
@@ -184,6 +216,35 @@ Return Value:
     devContext->FxDevice = fxDevice;
     devContext->InputMode = MODE_MULTI_TOUCH;
 
+    //
+    // The report context holds the state touched on every frame, give it
+    // its own cache-aligned allocation away from the configuration kept
+    // in the device extension. It is freed along with the device.
+    //
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = fxDevice;
+
+    status = WdfMemoryCreate(
+        &attributes,
+        NonPagedPoolNxCacheAligned,
+        TOUCH_REPORT_POOL_TAG,
+        sizeof(REPORT_CONTEXT),
+        &reportMemory,
+        (PVOID*)&devContext->ReportContext);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_INIT,
+            "Error allocating the report context - 0x%08lX",
+            status);
+
+        goto exit;
+    }
+
+    RtlZeroMemory(devContext->ReportContext, sizeof(REPORT_CONTEXT));
+
     //
     // Create a parallel dispatch queue to handle requests from HID Class
     //
@@ -224,7 +285,7 @@ Return Value:
         fxDevice,
         &queueConfig,
         WDF_NO_OBJECT_ATTRIBUTES,
-        &devContext->ReportContext.PingPongQueue);
+        &devContext->ReportContext->PingPongQueue);
 
     if (!NT_SUCCESS(status))
     {
@@ -237,6 +298,11 @@ Return Value:
         goto exit;
     }
 
+    //
+    // Reports produced while no read request is pending wait in this ring
+    //
+    TchInitializeReportRing(&devContext->ReportContext->ReportRing);
+
     //
     // Register one last manual I/O queue for parking HIDClass's idle power
     // requests. This queue stores idle requests until they're cancelled,
@@ -273,6 +339,7 @@ Return Value:
         OnInterruptIsr,
         NULL);
     interruptConfig.PassiveHandling = TRUE;
+    interruptConfig.EvtInterruptWorkItem = OnInterruptWorkItem;
 
     status = WdfInterruptCreate(
         fxDevice,
@@ -350,5 +417,6 @@ Return Value:
 {
     PAGED_CODE();
 
+    TraceLoggingUnregister(gTouchTraceLoggingProvider);
     WPP_CLEANUP(WdfDriverWdmGetDriverObject(Driver));
 }
\ No newline at end of file
@@ -24,187 +24,1480 @@
 #include <ft5x\ftinternal.h>
 #include <ftinternal.tmh>
 
+C_ASSERT(FT5X_MAX_TOUCH_POINTS <= TOUCH_FRAME_MAX_CONTACTS);
+
 NTSTATUS
 Ft5xBuildFunctionsTable(
       IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
       IN SPB_CONTEXT* SpbContext
 )
+/*++
+
+Routine Description:
+
+      This routine reads the chip ID and picks the variant whose frame
+      length and parser are used from then on. A controller that does not
+      answer keeps the generic variant.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      SpbContext - A pointer to the current i2c context
+
+Return Value:
+
+      NTSTATUS indicating success or failure
+
+--*/
+{
+      NTSTATUS status;
+      UCHAR chipId;
+
+      chipId = 0;
+
+      status = SpbReadDataSynchronously(
+            SpbContext,
+            FT5X_REGISTER_CHIP_ID,
+            &chipId,
+            sizeof(chipId));
+
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_WARNING,
+                  TRACE_INIT,
+                  "Could not read chip ID, using the generic frame layout - 0x%08lX",
+                  status);
+
+            chipId = 0;
+      }
+
+      ControllerContext->Variant = Ft5xFindVariant(chipId);
+
+      Trace(
+            TRACE_LEVEL_INFORMATION,
+            TRACE_INIT,
+            "Chip ID 0x%02X, %s with %u contact records",
+            chipId,
+            ControllerContext->Variant->Name,
+            ControllerContext->Variant->MaxTouchPoints);
+
+      return STATUS_SUCCESS;
+}
+
+NTSTATUS
+Ft5xChangePage(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      IN SPB_CONTEXT* SpbContext,
+      IN int DesiredPage
+)
 {
       UNREFERENCED_PARAMETER(SpbContext);
       UNREFERENCED_PARAMETER(ControllerContext);
+      UNREFERENCED_PARAMETER(DesiredPage);
+
+      return STATUS_SUCCESS;
+}
+
+static VOID
+Ft5xBuildRegisterImage(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+)
+/*++
+
+Routine Description:
+
+      This routine collects the configuration register writes from the
+      touch settings. The settings hold raw FT5x register values, a setting
+      left at FT5X_REGISTER_SETTING_UNSET keeps the firmware default and is
+      not written, so by default nothing is.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+
+Return Value:
+
+      None
+
+--*/
+{
+      TOUCH_SCREEN_SETTINGS* settings;
+      FT5X_REGISTER_IMAGE* image;
+
+      settings = &ControllerContext->TouchSettings;
+      image = &ControllerContext->RegisterImage;
+
+      image->Count = 0;
+
+#define FT5X_IMAGE_WRITE(Register, Setting) \
+      if ((Setting) <= 0xFF) \
+      { \
+            image->Writes[image->Count].Address = (Register); \
+            image->Writes[image->Count].Value = (UCHAR)(Setting); \
+            image->Count++; \
+      }
+
+      FT5X_IMAGE_WRITE(FT5X_REGISTER_INTERRUPT_MODE, settings->InterruptModeRegister);
+      FT5X_IMAGE_WRITE(FT5X_REGISTER_CTRL, settings->CtrlRegister);
+      FT5X_IMAGE_WRITE(FT5X_REGISTER_TIME_ENTER_MONITOR, settings->TimeEnterMonitorRegister);
+      FT5X_IMAGE_WRITE(FT5X_REGISTER_PERIOD_ACTIVE, settings->PeriodActiveRegister);
+      FT5X_IMAGE_WRITE(FT5X_REGISTER_PERIOD_MONITOR, settings->PeriodMonitorRegister);
+
+#undef FT5X_IMAGE_WRITE
+}
+
+NTSTATUS
+Ft5xConfigureFunctions(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      IN SPB_CONTEXT* SpbContext
+)
+/*++
+
+Routine Description:
+
+      This routine programs the configuration registers from the logical
+      settings. The register writes are kept in the controller context so
+      a wake can restore them without building them again.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      SpbContext - A pointer to the current i2c context
+
+Return Value:
+
+      NTSTATUS indicating success or failure
+
+--*/
+{
+      NTSTATUS status;
+
+      ControllerContext->RegisterImage.Valid = FALSE;
+
+      Ft5xBuildRegisterImage(ControllerContext);
+
+      status = SpbWriteRegistersSynchronously(
+            SpbContext,
+            ControllerContext->RegisterImage.Writes,
+            ControllerContext->RegisterImage.Count);
+
+      //
+      // The controller keeps running on its firmware defaults, the writes
+      // are replayed on the next wake
+      //
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_WARNING,
+                  TRACE_INIT,
+                  "Could not write configuration registers, keeping firmware defaults - 0x%08lX",
+                  status);
+      }
+
+      return STATUS_SUCCESS;
+}
+
+NTSTATUS
+Ft5xRestoreConfiguration(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      IN SPB_CONTEXT* SpbContext
+)
+/*++
+
+Routine Description:
+
+      This routine restores the configuration registers on wake by replaying
+      the register image as a single SPB sequence. Nothing is probed or
+      rebuilt, the image being that of the last successful start.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      SpbContext - A pointer to the current i2c context
+
+Return Value:
+
+      NTSTATUS indicating success or failure, STATUS_SUCCESS without any
+      transfer if the controller was never configured
+
+--*/
+{
+      NTSTATUS status;
+
+      if (!ControllerContext->RegisterImage.Valid)
+      {
+            return STATUS_SUCCESS;
+      }
+
+      status = SpbWriteRegistersSynchronously(
+            SpbContext,
+            ControllerContext->RegisterImage.Writes,
+            ControllerContext->RegisterImage.Count);
+
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_ERROR,
+                  TRACE_POWER,
+                  "Error restoring configuration registers - 0x%08lX",
+                  status);
+      }
+
+      return status;
+}
+
+NTSTATUS
+Ft5xWaitForReady(
+      IN SPB_CONTEXT* SpbContext,
+      IN ULONG TimeoutMicroseconds
+)
+/*++
+
+Routine Description:
+
+      This routine polls the chip ID register until the controller answers
+      with a valid ID, backing off between attempts. It replaces a fixed
+      wait after reset or power up, the timeout being the old fixed delay.
+      Must be called at PASSIVE_LEVEL.
+
+Arguments:
+
+      SpbContext - A pointer to the current i2c context
+      TimeoutMicroseconds - Upper bound on the time spent polling
+
+Return Value:
+
+      STATUS_SUCCESS once the controller answered, STATUS_IO_TIMEOUT if it
+      did not within the timeout
+
+--*/
+{
+      LARGE_INTEGER delay;
+      ULONG64 start;
+      ULONG64 elapsed;
+      ULONG interval;
+      UCHAR chipId;
+      NTSTATUS status;
+
+      start = KeQueryInterruptTime();
+      interval = FT5X_READY_POLL_MIN_INTERVAL;
+
+      for (;;)
+      {
+            chipId = 0;
+
+            status = SpbReadDataSynchronously(
+                  SpbContext,
+                  FT5X_REGISTER_CHIP_ID,
+                  &chipId,
+                  sizeof(chipId));
+
+            //
+            // The bus may ack before the firmware runs, in which case the
+            // register reads back as all zeroes or all ones
+            //
+            if (NT_SUCCESS(status) && chipId != 0x00 && chipId != 0xFF)
+            {
+                  Trace(
+                        TRACE_LEVEL_INFORMATION,
+                        TRACE_INIT,
+                        "Controller ready, chip ID 0x%02X after %llu us",
+                        chipId,
+                        (KeQueryInterruptTime() - start) / 10);
+
+                  status = STATUS_SUCCESS;
+                  goto exit;
+            }
+
+            elapsed = (KeQueryInterruptTime() - start) / 10;
+
+            if (elapsed >= TimeoutMicroseconds)
+            {
+                  status = STATUS_IO_TIMEOUT;
+                  goto exit;
+            }
+
+            if (interval > TimeoutMicroseconds - elapsed)
+            {
+                  interval = (ULONG)(TimeoutMicroseconds - elapsed);
+            }
+
+            delay.QuadPart = WDF_REL_TIMEOUT_IN_US(interval);
+            KeDelayExecutionThread(KernelMode, FALSE, &delay);
+
+            interval = min(interval * 2, FT5X_READY_POLL_MAX_INTERVAL);
+      }
+
+exit:
+      return status;
+}
+
+NTSTATUS
+Ft5xReadEventDataAdaptive(
+      IN SPB_CONTEXT* SpbContext,
+      IN PFOCAL_TECH_EVENT_DATA EventData,
+      IN ULONG MaxTouchPoints
+)
+/*++
+
+Routine Description:
+
+      This routine reads a touch frame in two phases. The first read fetches
+      the frame header and the first contact record, which covers the common
+      single-touch case in one transfer. Only if TD_STATUS reports more
+      contacts are the remaining records fetched with a second read.
+
+Arguments:
+
+      SpbContext - A pointer to the current i2c context
+      EventData - Non-paged buffer receiving the frame
+      MaxTouchPoints - Number of contact records the controller exposes
+
+Return Value:
+
+      NTSTATUS indicating success or failure
+
+--*/
+{
+      NTSTATUS status;
+      ULONG touchPoints;
+
+      status = SpbReadDataDirectSynchronously(
+            SpbContext,
+            0,
+            EventData,
+            FIELD_OFFSET(FOCAL_TECH_EVENT_DATA, TouchData[1]));
+
+      if (!NT_SUCCESS(status))
+      {
+            goto exit;
+      }
+
+      touchPoints = EventData->NumberOfTouchPoints;
+
+      if (touchPoints > MaxTouchPoints)
+      {
+            touchPoints = MaxTouchPoints;
+      }
+
+      if (touchPoints > 1)
+      {
+            status = SpbReadDataDirectSynchronously(
+                  SpbContext,
+                  (UCHAR)FIELD_OFFSET(FOCAL_TECH_EVENT_DATA, TouchData[1]),
+                  &EventData->TouchData[1],
+                  (ULONG)((touchPoints - 1) * sizeof(FOCAL_TECH_TOUCH_DATA)));
+      }
+
+exit:
+      return status;
+}
+
+static VOID
+Ft5xRecordFrame(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      IN PFOCAL_TECH_EVENT_DATA EventData,
+      IN ULONG Length,
+      IN ULONG64 Timestamp
+)
+/*++
+
+Routine Description:
+
+      This routine copies a frame as read from the controller into the
+      next slot of the frame recorder. Runs at IRQL <= DISPATCH_LEVEL.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      EventData - The frame as read
+      Length - Number of bytes of the frame that were read
+      Timestamp - Interrupt time of the frame
+
+Return Value:
+
+      None
+
+--*/
+{
+      FT5X_RECORDED_FRAME* slot;
+      LONG sequence;
+
+      sequence = InterlockedIncrement(&ControllerContext->Recorder.Next);
+      slot = &ControllerContext->Recorder.Frames[(ULONG)(sequence - 1) % FT5X_FRAME_RECORDER_DEPTH];
+
+      //
+      // Readers skip the slot until it carries its new sequence again
+      //
+      InterlockedExchange(&slot->Sequence, 0);
+
+      slot->Timestamp = Timestamp;
+      slot->Length = Length;
+      RtlCopyMemory(&slot->EventData, EventData, Length);
+
+      WriteRelease(&slot->Sequence, sequence);
+}
+
+ULONG
+Ft5xCopyRecordedFrames(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      OUT FT5X_RECORDED_FRAME* Frames,
+      IN ULONG MaxFrames
+)
+/*++
+
+Routine Description:
+
+      This routine copies the most recent recorded frames, oldest first.
+      Frames overwritten or being written while they are copied are left
+      out, the sequence numbers of those copied show any gap.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      Frames - Receives the frames
+      MaxFrames - Number of entries in Frames
+
+Return Value:
+
+      Number of frames copied
+
+--*/
+{
+      FT5X_RECORDED_FRAME* slot;
+      ULONG length;
+      ULONG copied;
+      ULONG count;
+      ULONG i;
+      LONG sequence;
+      LONG next;
+
+      copied = 0;
+      next = ReadAcquire(&ControllerContext->Recorder.Next);
+
+      count = min((ULONG)next, FT5X_FRAME_RECORDER_DEPTH);
+      count = min(count, MaxFrames);
+
+      for (i = count; i > 0; i--)
+      {
+            sequence = next - (LONG)i + 1;
+            slot = &ControllerContext->Recorder.Frames[(ULONG)(sequence - 1) % FT5X_FRAME_RECORDER_DEPTH];
+
+            if (ReadAcquire(&slot->Sequence) != sequence)
+            {
+                  continue;
+            }
+
+            length = min(slot->Length, (ULONG)sizeof(FOCAL_TECH_EVENT_DATA));
+
+            RtlZeroMemory(&Frames[copied], sizeof(FT5X_RECORDED_FRAME));
+            Frames[copied].Timestamp = slot->Timestamp;
+            Frames[copied].Length = length;
+            RtlCopyMemory(&Frames[copied].EventData, &slot->EventData, length);
+
+            //
+            // The copy only counts if the slot was not reused meanwhile
+            //
+            MemoryBarrier();
+
+            if (ReadNoFence(&slot->Sequence) != sequence)
+            {
+                  continue;
+            }
+
+            Frames[copied].Sequence = sequence;
+            copied++;
+      }
+
+      return copied;
+}
+
+NTSTATUS
+Ft5xGetObjectStatusFromControllerF12(
+      IN VOID* ControllerContext,
+      IN SPB_CONTEXT* SpbContext,
+      IN PTOUCH_FRAME Frame
+)
+/*++
+
+Routine Description:
+
+      This routine reads raw touch messages from hardware. If there is
+      no touch data available (if a non-touch interrupt fired), the
+      function will not return success and no touch data was transferred.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      SpbContext - A pointer to the current i2c context
+      Frame - A pointer to the frame to fill with returned touch data
+
+Return Value:
+
+      NTSTATUS, where only success indicates data was returned
+
+--*/
+{
+      NTSTATUS status;
+      FT5X_CONTROLLER_CONTEXT* controller;
+      ULONG touchPoints;
+      ULONG length;
+
+      PFOCAL_TECH_EVENT_DATA controllerData;
+      const FT5X_VARIANT* variant;
+      controller = (FT5X_CONTROLLER_CONTEXT*)ControllerContext;
+      controllerData = &controller->EventData;
+      variant = controller->Variant;
+
+      // 
+      // Packets we need is determined by context, and never go past the
+      // last contact record of the variant
+      //
+      if (controller->TouchSettings.AdaptiveFrameRead)
+      {
+            status = Ft5xReadEventDataAdaptive(SpbContext, controllerData, variant->MaxTouchPoints);
+      }
+      else
+      {
+            status = SpbReadDataDirectSynchronously(SpbContext, 0, controllerData, variant->FrameLength);
+      }
+
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_ERROR,
+                  TRACE_INTERRUPT,
+                  "Error reading finger status data - 0x%08lX",
+                  status);
+
+            goto exit;
+      }
+
+      if (controller->Recorder.Enabled)
+      {
+            //
+            // The adaptive read fetched the header and as many contact
+            // records as the frame announced, at least one
+            //
+            length = variant->FrameLength;
+
+            if (controller->TouchSettings.AdaptiveFrameRead)
+            {
+                  touchPoints = min(max(controllerData->NumberOfTouchPoints, 1), variant->MaxTouchPoints);
+                  length = (ULONG)FIELD_OFFSET(FOCAL_TECH_EVENT_DATA, TouchData[touchPoints]);
+            }
+
+            Ft5xRecordFrame(controller, controllerData, length, Frame->Timestamp);
+      }
+
+      variant->ParseEventData(controllerData, Frame);
+
+exit:
+      return status;
+}
+
+static VOID
+Ft5xNoteContacts(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      IN PTOUCH_FRAME Frame
+)
+/*++
+
+Routine Description:
+
+      This routine records that a frame with contacts was read, pushing
+      back the switch to monitor mode. Runs at IRQL <= DISPATCH_LEVEL.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      Frame - The frame that was read
+
+Return Value:
+
+      None
+
+--*/
+{
+      LONG64 now;
+
+      if (Frame->ContactCount == 0 ||
+            ControllerContext->MonitorIdleTimeout == 0 ||
+            ControllerContext->MonitorIdleTimer == NULL)
+      {
+            return;
+      }
+
+      now = (Frame->Timestamp != 0) ? (LONG64)Frame->Timestamp : (LONG64)KeQueryInterruptTime();
+      WriteNoFence64(&ControllerContext->LastContactTime, now);
+
+      if (ControllerContext->MonitorIdleTimerArmed == 0 &&
+            ControllerContext->MonitorIdleTimerStopped == 0 &&
+            InterlockedExchange(&ControllerContext->MonitorIdleTimerArmed, 1) == 0)
+      {
+            WdfTimerStart(ControllerContext->MonitorIdleTimer, -ControllerContext->MonitorIdleTimeout);
+      }
+}
+
+NTSTATUS
+TchServiceObjectInterrupts(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      IN SPB_CONTEXT* SpbContext,
+      IN PREPORT_CONTEXT ReportContext
+)
+{
+      NTSTATUS status = STATUS_SUCCESS;
+      TOUCH_FRAME frame;
+
+      TchInitializeTouchFrame(&frame);
+      frame.Timestamp = (ULONG64)ReadNoFence64(&ReportContext->InterruptTime);
+
+      //
+      // See if new touch data is available
+      //
+      status = Ft5xGetObjectStatusFromControllerF12(
+            ControllerContext,
+            SpbContext,
+            &frame
+      );
+
+      if (!NT_SUCCESS(status))
+      {
+            ReportRecordFailedRead(ReportContext);
+
+            Trace(
+                  TRACE_LEVEL_VERBOSE,
+                  TRACE_SAMPLES,
+                  "No object data to report - 0x%08lX",
+                  status);
+
+            goto exit;
+      }
+
+      ReportRecordLatency(
+            ReportContext,
+            REPORT_LATENCY_STAGE_SPB_READ,
+            frame.Timestamp);
+
+      Ft5xNoteContacts(ControllerContext, &frame);
+
+      status = ReportObjects(
+            ReportContext,
+            &frame);
+
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_VERBOSE,
+                  TRACE_SAMPLES,
+                  "Error while reporting objects - 0x%08lX",
+                  status);
+
+            goto exit;
+      }
+
+exit:
+      return status;
+}
+
+
+SPB_ASYNC_READ_COMPLETION Ft5xAsyncFrameReadCompletion;
+
+FT5X_ASYNC_FRAME*
+Ft5xClaimAsyncFrame(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+)
+/*++
+
+Routine Description:
+
+      This routine marks a frame buffer that has no read in flight as busy.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+
+Return Value:
+
+      The claimed frame buffer, or NULL if all of them are in flight
+
+--*/
+{
+      ULONG i;
+
+      for (i = 0; i < FT5X_ASYNC_FRAME_COUNT; i++)
+      {
+            if (InterlockedCompareExchange(&ControllerContext->AsyncFrames[i].Busy, 1, 0) == 0)
+            {
+                  return &ControllerContext->AsyncFrames[i];
+            }
+      }
+
+      return NULL;
+}
+
+NTSTATUS
+Ft5xStartAsyncFrameRead(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+)
+/*++
+
+Routine Description:
+
+      This routine starts an asynchronous read of the current touch frame
+      into a free frame buffer. If both buffers are in flight, the next
+      completing read starts another one, so the frame that raised this
+      interrupt is not missed.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+
+Return Value:
+
+      NTSTATUS indicating success or failure
+
+--*/
+{
+      FT5X_ASYNC_FRAME* frame;
+      NTSTATUS status;
+
+      if (ControllerContext->AsyncReadStopped)
+      {
+            status = STATUS_INVALID_DEVICE_STATE;
+            goto exit;
+      }
+
+      frame = Ft5xClaimAsyncFrame(ControllerContext);
+
+      if (frame == NULL)
+      {
+            InterlockedExchange(&ControllerContext->AsyncReadPending, 1);
+
+            //
+            // A read may have completed before the flag was raised, retry
+            // once so the request is not left waiting for a completion
+            //
+            frame = Ft5xClaimAsyncFrame(ControllerContext);
+
+            if (frame == NULL)
+            {
+                  status = STATUS_SUCCESS;
+                  goto exit;
+            }
+
+            InterlockedExchange(&ControllerContext->AsyncReadPending, 0);
+      }
+
+      frame->Sequence = InterlockedIncrement(&ControllerContext->AsyncSequence);
+      frame->Timestamp = (ULONG64)ReadNoFence64(&ControllerContext->AsyncReportContext->InterruptTime);
+
+      status = SpbReadDataAsynchronously(&frame->Read, 0);
+
+      if (!NT_SUCCESS(status))
+      {
+            InterlockedExchange(&frame->Busy, 0);
+      }
+
+exit:
+      return status;
+}
+
+VOID
+Ft5xAsyncFrameReadCompletion(
+      IN PSPB_ASYNC_READ AsyncRead,
+      IN NTSTATUS Status,
+      IN PVOID Context
+)
+/*++
+
+Routine Description:
+
+      Completion of an asynchronous frame read, runs at IRQL <= DISPATCH_LEVEL.
+      The frame is parsed and reported unless a read started later has
+      already been reported.
+
+Arguments:
+
+      AsyncRead - The read that completed
+      Status - Completion status of the read
+      Context - The frame buffer the read filled
+
+Return Value:
+
+      None
+
+--*/
+{
+      FT5X_CONTROLLER_CONTEXT* controller;
+      FT5X_ASYNC_FRAME* frame;
+      TOUCH_FRAME touchFrame;
+      NTSTATUS status;
+
+      UNREFERENCED_PARAMETER(AsyncRead);
+
+      frame = (FT5X_ASYNC_FRAME*)Context;
+      controller = frame->Controller;
+
+      if (NT_SUCCESS(Status))
+      {
+            if (controller->Recorder.Enabled)
+            {
+                  Ft5xRecordFrame(
+                        controller,
+                        &frame->EventData,
+                        controller->Variant->FrameLength,
+                        frame->Timestamp);
+            }
+
+            WdfSpinLockAcquire(controller->AsyncReportLock);
+
+            if ((LONG)((ULONG)frame->Sequence - (ULONG)controller->AsyncReportedSequence) > 0)
+            {
+                  controller->AsyncReportedSequence = frame->Sequence;
+
+                  TchInitializeTouchFrame(&touchFrame);
+                  touchFrame.Timestamp = frame->Timestamp;
+                  controller->Variant->ParseEventData(&frame->EventData, &touchFrame);
+                  Ft5xNoteContacts(controller, &touchFrame);
+
+                  ReportRecordLatency(
+                        controller->AsyncReportContext,
+                        REPORT_LATENCY_STAGE_SPB_READ,
+                        touchFrame.Timestamp);
+
+                  status = ReportObjects(
+                        controller->AsyncReportContext,
+                        &touchFrame);
+
+                  if (!NT_SUCCESS(status))
+                  {
+                        Trace(
+                              TRACE_LEVEL_VERBOSE,
+                              TRACE_SAMPLES,
+                              "Error while reporting objects - 0x%08lX",
+                              status);
+                  }
+            }
+
+            WdfSpinLockRelease(controller->AsyncReportLock);
+      }
+      else
+      {
+            ReportRecordFailedRead(controller->AsyncReportContext);
+
+            Trace(
+                  TRACE_LEVEL_ERROR,
+                  TRACE_INTERRUPT,
+                  "Error reading finger status data asynchronously - 0x%08lX",
+                  Status);
+      }
+
+      InterlockedExchange(&frame->Busy, 0);
+
+      if (InterlockedExchange(&controller->AsyncReadPending, 0) != 0)
+      {
+            (VOID)Ft5xStartAsyncFrameRead(controller);
+      }
+}
+
+static
+NTSTATUS
+Ft5xServiceFrameBesideAsyncReads(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      IN SPB_CONTEXT* SpbContext,
+      IN PREPORT_CONTEXT ReportContext
+)
+/*++
+
+Routine Description:
+
+      Reads the current frame synchronously when no asynchronous read
+      could be started for it, while reads already in flight may still
+      complete. The read takes its place in the sequence of asynchronous
+      reads and is reported under AsyncReportLock like them, so it is
+      neither reported concurrently with a completion nor overwritten by
+      an older frame.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      SpbContext - A pointer to the current i2c context
+      ReportContext - Report context the frame is reported to
+
+Return Value:
+
+      NTSTATUS indicating success or failure
+
+--*/
+{
+      TOUCH_FRAME frame;
+      LONG sequence;
+      NTSTATUS status;
+
+      sequence = InterlockedIncrement(&ControllerContext->AsyncSequence);
+
+      TchInitializeTouchFrame(&frame);
+      frame.Timestamp = (ULONG64)ReadNoFence64(&ReportContext->InterruptTime);
+
+      status = Ft5xGetObjectStatusFromControllerF12(
+            ControllerContext,
+            SpbContext,
+            &frame
+      );
+
+      if (!NT_SUCCESS(status))
+      {
+            ReportRecordFailedRead(ReportContext);
+
+            Trace(
+                  TRACE_LEVEL_VERBOSE,
+                  TRACE_SAMPLES,
+                  "No object data to report - 0x%08lX",
+                  status);
+
+            goto exit;
+      }
+
+      ReportRecordLatency(
+            ReportContext,
+            REPORT_LATENCY_STAGE_SPB_READ,
+            frame.Timestamp);
+
+      WdfSpinLockAcquire(ControllerContext->AsyncReportLock);
+
+      if ((LONG)((ULONG)sequence - (ULONG)ControllerContext->AsyncReportedSequence) > 0)
+      {
+            ControllerContext->AsyncReportedSequence = sequence;
+
+            Ft5xNoteContacts(ControllerContext, &frame);
+
+            status = ReportObjects(
+                  ReportContext,
+                  &frame);
+
+            if (!NT_SUCCESS(status))
+            {
+                  Trace(
+                        TRACE_LEVEL_VERBOSE,
+                        TRACE_SAMPLES,
+                        "Error while reporting objects - 0x%08lX",
+                        status);
+            }
+      }
+
+      WdfSpinLockRelease(ControllerContext->AsyncReportLock);
+
+exit:
+      return status;
+}
+
+NTSTATUS
+Ft5xInitializeAsyncFrameRead(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      IN SPB_CONTEXT* SpbContext
+)
+/*++
+
+Routine Description:
+
+      This routine sets up the asynchronous frame read pipeline if it is
+      enabled in the touch settings. Failing to do so is not fatal, frames
+      are then read synchronously.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      SpbContext - A pointer to the current i2c context
+
+Return Value:
+
+      NTSTATUS indicating success or failure
+
+--*/
+{
+      WDF_OBJECT_ATTRIBUTES attributes;
+      NTSTATUS status;
+      ULONG i;
+
+      status = STATUS_SUCCESS;
+
+      if (ControllerContext->TouchSettings.AsyncFrameRead == 0)
+      {
+            goto exit;
+      }
+
+      //
+      // Each completion rearms a read that is only consumed by the next
+      // interrupt pulse, a level-triggered line would be serviced again
+      // before the frame in flight is read
+      //
+      if (!ControllerContext->InterruptLatched)
+      {
+            Trace(
+                  TRACE_LEVEL_WARNING,
+                  TRACE_INIT,
+                  "Asynchronous frame reads requested on a level-triggered interrupt, reading synchronously");
+
+            goto exit;
+      }
+
+      WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+      attributes.ParentObject = ControllerContext->FxDevice;
+
+      status = WdfSpinLockCreate(
+            &attributes,
+            &ControllerContext->AsyncReportLock);
+
+      if (!NT_SUCCESS(status))
+      {
+            goto exit;
+      }
+
+      for (i = 0; i < FT5X_ASYNC_FRAME_COUNT; i++)
+      {
+            ControllerContext->AsyncFrames[i].Controller = ControllerContext;
+
+            status = SpbAsyncReadInitialize(
+                  ControllerContext->FxDevice,
+                  SpbContext,
+                  &ControllerContext->AsyncFrames[i].Read,
+                  &ControllerContext->AsyncFrames[i].EventData,
+                  ControllerContext->Variant->FrameLength,
+                  Ft5xAsyncFrameReadCompletion,
+                  &ControllerContext->AsyncFrames[i]);
+
+            if (!NT_SUCCESS(status))
+            {
+                  goto exit;
+            }
+      }
+
+      ControllerContext->AsyncReadStopped = 0;
+      ControllerContext->AsyncReadEnabled = TRUE;
+
+exit:
+
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_WARNING,
+                  TRACE_INIT,
+                  "Could not set up asynchronous frame reads, reading synchronously - 0x%08lX",
+                  status);
+
+            Ft5xDeinitializeAsyncFrameRead(ControllerContext);
+            status = STATUS_SUCCESS;
+      }
+
+      return status;
+}
+
+VOID
+Ft5xStopAsyncFrameRead(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+)
+/*++
+
+Routine Description:
+
+      This routine prevents new asynchronous frame reads from starting and
+      waits for those in flight to complete. Must be called at PASSIVE_LEVEL
+      with interrupts disabled.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+
+Return Value:
+
+      None
+
+--*/
+{
+      LARGE_INTEGER delay;
+      ULONG i;
+
+      if (!ControllerContext->AsyncReadEnabled)
+      {
+            return;
+      }
+
+      InterlockedExchange(&ControllerContext->AsyncReadStopped, 1);
+      InterlockedExchange(&ControllerContext->AsyncReadPending, 0);
+
+      delay.QuadPart = WDF_REL_TIMEOUT_IN_MS(1);
+
+      for (i = 0; i < FT5X_ASYNC_FRAME_COUNT; i++)
+      {
+            while (ControllerContext->AsyncFrames[i].Busy != 0)
+            {
+                  KeDelayExecutionThread(KernelMode, FALSE, &delay);
+            }
+      }
+}
+
+VOID
+Ft5xResumeAsyncFrameRead(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+)
+/*++
+
+Routine Description:
+
+      This routine allows asynchronous frame reads to start again after
+      Ft5xStopAsyncFrameRead.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+
+Return Value:
+
+      None
+
+--*/
+{
+      InterlockedExchange(&ControllerContext->AsyncReadStopped, 0);
+}
+
+VOID
+Ft5xDeinitializeAsyncFrameRead(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+)
+/*++
+
+Routine Description:
+
+      This routine tears down the asynchronous frame read pipeline.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+
+Return Value:
+
+      None
+
+--*/
+{
+      ULONG i;
+
+      Ft5xStopAsyncFrameRead(ControllerContext);
+
+      ControllerContext->AsyncReadEnabled = FALSE;
+
+      for (i = 0; i < FT5X_ASYNC_FRAME_COUNT; i++)
+      {
+            SpbAsyncReadDeinitialize(&ControllerContext->AsyncFrames[i].Read);
+      }
+
+      if (ControllerContext->AsyncReportLock != NULL)
+      {
+            WdfObjectDelete(ControllerContext->AsyncReportLock);
+            ControllerContext->AsyncReportLock = NULL;
+      }
+}
+
+typedef struct _FT5X_TIMER_CONTEXT
+{
+      FT5X_CONTROLLER_CONTEXT* Controller;
+} FT5X_TIMER_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(FT5X_TIMER_CONTEXT, GetFt5xTimerContext)
+
+EVT_WDF_TIMER Ft5xMonitorIdleTimerFunc;
+
+VOID
+Ft5xMonitorIdleTimerFunc(
+      IN WDFTIMER Timer
+)
+/*++
+
+Routine Description:
+
+      Runs at PASSIVE_LEVEL once MonitorIdleTimeoutMs may have passed since
+      the last frame with contacts. If a contact was seen in the meantime,
+      the timer is rearmed for the remainder, otherwise the controller is
+      put in monitor mode.
+
+Arguments:
+
+      Timer - Handle to the idle timer
+
+Return Value:
 
-      return STATUS_SUCCESS;
-}
+      None
 
-NTSTATUS
-Ft5xChangePage(
-      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
-      IN SPB_CONTEXT* SpbContext,
-      IN int DesiredPage
-)
+--*/
 {
-      UNREFERENCED_PARAMETER(SpbContext);
-      UNREFERENCED_PARAMETER(ControllerContext);
-      UNREFERENCED_PARAMETER(DesiredPage);
+      FT5X_CONTROLLER_CONTEXT* controller;
+      LONG64 lastContactTime;
+      LONG64 idleTime;
+      NTSTATUS status;
 
-      return STATUS_SUCCESS;
-}
+      controller = GetFt5xTimerContext(Timer)->Controller;
 
-NTSTATUS
-Ft5xConfigureFunctions(
-      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
-      IN SPB_CONTEXT* SpbContext
-)
-{
-      UNREFERENCED_PARAMETER(SpbContext);
-      UNREFERENCED_PARAMETER(ControllerContext);
+      if (controller->MonitorIdleTimerStopped != 0 ||
+            controller->GestureModeActive != 0)
+      {
+            InterlockedExchange(&controller->MonitorIdleTimerArmed, 0);
+            return;
+      }
 
-      return STATUS_SUCCESS;
+      lastContactTime = ReadNoFence64(&controller->LastContactTime);
+      idleTime = (LONG64)KeQueryInterruptTime() - lastContactTime;
+
+      if (idleTime < controller->MonitorIdleTimeout)
+      {
+            WdfTimerStart(Timer, -(controller->MonitorIdleTimeout - idleTime));
+            return;
+      }
+
+      InterlockedExchange(&controller->MonitorIdleTimerArmed, 0);
+
+      //
+      // A contact noted while the timer was still marked armed did not
+      // start it, pick that up before going idle
+      //
+      if (ReadNoFence64(&controller->LastContactTime) != lastContactTime)
+      {
+            if (InterlockedExchange(&controller->MonitorIdleTimerArmed, 1) == 0)
+            {
+                  WdfTimerStart(Timer, -controller->MonitorIdleTimeout);
+            }
+
+            return;
+      }
+
+      status = Ft5xChangeSleepState(
+            controller,
+            controller->MonitorSpbContext,
+            FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_MONITOR);
+
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_ERROR,
+                  TRACE_POWER,
+                  "Error entering monitor mode - 0x%08lX",
+                  status);
+
+            return;
+      }
+
+      InterlockedExchange(&controller->MonitorModeActive, 1);
 }
 
 NTSTATUS
-Ft5xGetObjectStatusFromControllerF12(
-      IN VOID* ControllerContext,
-      IN SPB_CONTEXT* SpbContext,
-      IN DETECTED_OBJECTS* Data
+Ft5xInitializeMonitorMode(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+      IN SPB_CONTEXT* SpbContext
 )
 /*++
 
 Routine Description:
 
-      This routine reads raw touch messages from hardware. If there is
-      no touch data available (if a non-touch interrupt fired), the
-      function will not return success and no touch data was transferred.
+      This routine sets up the idle timer moving the controller to monitor
+      mode when no contact was reported for MonitorIdleTimeoutMs. Nothing
+      is set up if the setting is zero. The timer is created once, the
+      timeout is taken again on every start.
 
 Arguments:
 
       ControllerContext - Touch controller context
       SpbContext - A pointer to the current i2c context
-      Data - A pointer to any returned F11 touch data
 
 Return Value:
 
-      NTSTATUS, where only success indicates data was returned
+      NTSTATUS indicating success or failure
 
 --*/
 {
-      NTSTATUS status;
-      FT5X_CONTROLLER_CONTEXT* controller;
-
-      int i, x, y;
-      PFOCAL_TECH_EVENT_DATA controllerData = NULL;
-      controller = (FT5X_CONTROLLER_CONTEXT*)ControllerContext;
+      WDF_TIMER_CONFIG timerConfig;
+      WDF_OBJECT_ATTRIBUTES attributes;
+      NTSTATUS status = STATUS_SUCCESS;
 
-      controllerData = ExAllocatePoolWithTag(
-            NonPagedPoolNx,
-            sizeof(FOCAL_TECH_EVENT_DATA),
-            TOUCH_POOL_TAG_F12);
+      ControllerContext->MonitorSpbContext = SpbContext;
+      ControllerContext->MonitorIdleTimeout =
+            (LONG64)ControllerContext->TouchSettings.MonitorIdleTimeoutMs * 10000;
 
-      if (controllerData == NULL)
+      if (ControllerContext->MonitorIdleTimeout == 0 ||
+            ControllerContext->MonitorIdleTimer != NULL)
       {
-            status = STATUS_INSUFFICIENT_RESOURCES;
             goto exit;
       }
 
-      // 
-      // Packets we need is determined by context
       //
-      status = SpbReadDataSynchronously(SpbContext, 0, controllerData, sizeof(FOCAL_TECH_EVENT_DATA));
+      // Entering monitor mode is an SPB write, so the timer runs at
+      // PASSIVE_LEVEL
+      //
+      WDF_TIMER_CONFIG_INIT(&timerConfig, Ft5xMonitorIdleTimerFunc);
+
+      WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&attributes, FT5X_TIMER_CONTEXT);
+      attributes.ParentObject = ControllerContext->FxDevice;
+      attributes.ExecutionLevel = WdfExecutionLevelPassive;
+
+      status = WdfTimerCreate(
+            &timerConfig,
+            &attributes,
+            &ControllerContext->MonitorIdleTimer);
 
       if (!NT_SUCCESS(status))
       {
             Trace(
                   TRACE_LEVEL_ERROR,
-                  TRACE_INTERRUPT,
-                  "Error reading finger status data - 0x%08lX",
+                  TRACE_INIT,
+                  "Error creating monitor mode idle timer - 0x%08lX",
                   status);
 
-            goto free_buffer;
+            goto exit;
       }
 
-      BYTE X_MSB = 0;
-      BYTE X_LSB = 0;
-      BYTE Y_MSB = 0;
-      BYTE Y_LSB = 0;
+      GetFt5xTimerContext(ControllerContext->MonitorIdleTimer)->Controller = ControllerContext;
 
-      for (i = 0; i < controllerData->NumberOfTouchPoints; i++)
-      {
-            X_MSB = controllerData->TouchData[i].PositionX_High;
-            X_LSB = controllerData->TouchData[i].PositionX_Low;
-            Y_MSB = controllerData->TouchData[i].PositionY_High;
-            Y_LSB = controllerData->TouchData[i].PositionY_Low;
+exit:
+      return status;
+}
+
+VOID
+Ft5xRestartMonitorIdleTimer(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+)
+/*++
+
+Routine Description:
+
+      This routine starts counting the idle period from now, called when
+      the controller was just put in active mode.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+
+Return Value:
 
-            Data->States[i] = OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS;
+      None
 
-            x = (X_MSB << 8) | X_LSB;
-            y = (Y_MSB << 8) | Y_LSB;
+--*/
+{
+      InterlockedExchange(&ControllerContext->MonitorModeActive, 0);
 
-            Data->Positions[i].X = x;
-            Data->Positions[i].Y = y;
+      if (ControllerContext->MonitorIdleTimer == NULL ||
+            ControllerContext->MonitorIdleTimeout == 0)
+      {
+            return;
       }
 
-free_buffer:
-      ExFreePoolWithTag(
-            controllerData,
-            TOUCH_POOL_TAG_F12
-      );
+      WriteNoFence64(&ControllerContext->LastContactTime, (LONG64)KeQueryInterruptTime());
+      InterlockedExchange(&ControllerContext->MonitorIdleTimerStopped, 0);
 
-exit:
-      return status;
+      if (InterlockedExchange(&ControllerContext->MonitorIdleTimerArmed, 1) == 0)
+      {
+            WdfTimerStart(ControllerContext->MonitorIdleTimer, -ControllerContext->MonitorIdleTimeout);
+      }
 }
 
-NTSTATUS
-TchServiceObjectInterrupts(
+VOID
+Ft5xStopMonitorIdleTimer(
+      IN FT5X_CONTROLLER_CONTEXT* ControllerContext
+)
+/*++
+
+Routine Description:
+
+      This routine stops the idle timer and waits for a running callback
+      to return. Must be called at PASSIVE_LEVEL.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+
+Return Value:
+
+      None
+
+--*/
+{
+      if (ControllerContext->MonitorIdleTimer == NULL)
+      {
+            return;
+      }
+
+      InterlockedExchange(&ControllerContext->MonitorIdleTimerStopped, 1);
+      WdfTimerStop(ControllerContext->MonitorIdleTimer, TRUE);
+      InterlockedExchange(&ControllerContext->MonitorIdleTimerArmed, 0);
+}
+
+static NTSTATUS
+Ft5xServiceGestureInterrupt(
       IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
       IN SPB_CONTEXT* SpbContext,
       IN PREPORT_CONTEXT ReportContext
 )
+/*++
+
+Routine Description:
+
+      This routine services an interrupt raised by the gesture engine. Only
+      the gesture ID is read, and the host is woken only if it is one of
+      the enabled gestures. Anything else is dropped here without a
+      report reaching HIDClass.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      SpbContext - A pointer to the current i2c context
+      ReportContext - Report context of the device
+
+Return Value:
+
+      NTSTATUS indicating success or failure
+
+--*/
 {
-      NTSTATUS status = STATUS_SUCCESS;
-      DETECTED_OBJECTS data;
+      UCHAR gestureId;
+      NTSTATUS status;
 
-      RtlZeroMemory(&data, sizeof(data));
+      gestureId = 0;
 
-      //
-      // See if new touch data is available
-      //
-      status = Ft5xGetObjectStatusFromControllerF12(
-            ControllerContext,
+      status = SpbReadDataSynchronously(
             SpbContext,
-            &data
-      );
+            FT5X_REGISTER_GESTURE_ID,
+            &gestureId,
+            sizeof(gestureId));
 
       if (!NT_SUCCESS(status))
       {
-            Trace(
-                  TRACE_LEVEL_VERBOSE,
-                  TRACE_SAMPLES,
-                  "No object data to report - 0x%08lX",
-                  status);
-
             goto exit;
       }
 
-      status = ReportObjects(
-            ReportContext,
-            data);
-
-      if (!NT_SUCCESS(status))
+      if (gestureId < FOCAL_TECH_WAKE_GESTURE_FIRST ||
+            gestureId > FOCAL_TECH_WAKE_GESTURE_LAST ||
+            (ControllerContext->GestureMask & (1u << (gestureId - FOCAL_TECH_WAKE_GESTURE_FIRST))) == 0)
       {
             Trace(
                   TRACE_LEVEL_VERBOSE,
                   TRACE_SAMPLES,
-                  "Error while reporting objects - 0x%08lX",
-                  status);
+                  "Ignoring gesture 0x%02X",
+                  gestureId);
 
             goto exit;
       }
 
+      Trace(
+            TRACE_LEVEL_INFORMATION,
+            TRACE_REPORTING,
+            "Wake gesture 0x%02X",
+            gestureId);
+
+      status = ReportWakeup(ReportContext);
+
 exit:
       return status;
 }
 
-
 NTSTATUS
 Ft5xServiceInterrupts(
       IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
@@ -214,8 +1507,73 @@ Ft5xServiceInterrupts(
 {
       NTSTATUS status = STATUS_SUCCESS;
 
+      if (ControllerContext->GestureModeActive != 0)
+      {
+            status = Ft5xServiceGestureInterrupt(
+                  ControllerContext,
+                  SpbContext,
+                  ReportContext);
+
+            goto exit;
+      }
+
+      //
+      // The first interrupt in monitor mode brings the controller back to
+      // its active report rate
+      //
+      if (ControllerContext->MonitorModeActive != 0 &&
+            InterlockedExchange(&ControllerContext->MonitorModeActive, 0) != 0)
+      {
+            status = Ft5xChangeSleepState(
+                  ControllerContext,
+                  SpbContext,
+                  FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_OPERATING);
+
+            if (!NT_SUCCESS(status))
+            {
+                  Trace(
+                        TRACE_LEVEL_ERROR,
+                        TRACE_INTERRUPT,
+                        "Error leaving monitor mode - 0x%08lX",
+                        status);
+            }
+
+            status = STATUS_SUCCESS;
+      }
+
+      //
+      // In asynchronous mode the read is only started here, parsing and
+      // reporting happen in its completion
+      //
+      if (ControllerContext->AsyncReadEnabled &&
+            SpbContext->SequenceSupported)
+      {
+            ControllerContext->AsyncReportContext = ReportContext;
+
+            status = Ft5xStartAsyncFrameRead(ControllerContext);
+
+            if (NT_SUCCESS(status) ||
+                  status == STATUS_INVALID_DEVICE_STATE)
+            {
+                  goto exit;
+            }
+
+            //
+            // The other frame buffer's read may still be in flight, read
+            // this frame in its turn with the completions
+            //
+            (VOID)Ft5xServiceFrameBesideAsyncReads(
+                  ControllerContext,
+                  SpbContext,
+                  ReportContext);
+
+            status = STATUS_SUCCESS;
+            goto exit;
+      }
+
       TchServiceObjectInterrupts(ControllerContext, SpbContext, ReportContext);
 
+exit:
       return status;
 }
 
@@ -226,13 +1584,101 @@ Ft5xSetReportingFlagsF12(
     IN UCHAR NewMode,
     OUT UCHAR* OldMode
 )
+/*++
+
+Routine Description:
+
+      This routine switches the controller between regular reporting and
+      its gesture engine. In gesture mode the controller only interrupts
+      for the gestures enabled by WakeupGestureMask, a double tap unless
+      set otherwise. Leaving a mode that is not active costs no transfer.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      SpbContext - A pointer to the current i2c context
+      NewMode - One of FT5X_F12_REPORTING_FLAGS
+      OldMode - Optionally receives the mode that was active
+
+Return Value:
+
+      NTSTATUS indicating success or failure
+
+--*/
 {
-      UNREFERENCED_PARAMETER(SpbContext);
-      UNREFERENCED_PARAMETER(ControllerContext);
-      UNREFERENCED_PARAMETER(NewMode);
-      UNREFERENCED_PARAMETER(OldMode);
+      SPB_REGISTER_WRITE writes[3];
+      BOOLEAN gestureMode;
+      UINT32 mask;
+      NTSTATUS status = STATUS_SUCCESS;
 
-      return STATUS_SUCCESS;
+      gestureMode = (NewMode == FT5X_F12_REPORTING_WAKEUP_GESTURE_MODE);
+
+      if (OldMode != NULL)
+      {
+            *OldMode = (ControllerContext->GestureModeActive != 0) ?
+                  (UCHAR)FT5X_F12_REPORTING_WAKEUP_GESTURE_MODE :
+                  (UCHAR)FT5X_F12_REPORTING_CONTINUOUS_MODE;
+      }
+
+      if (gestureMode == (ControllerContext->GestureModeActive != 0))
+      {
+            goto exit;
+      }
+
+      if (gestureMode)
+      {
+            mask = ControllerContext->TouchSettings.WakeupGestureMask;
+
+            if (mask == 0)
+            {
+                  mask = FOCAL_TECH_WAKE_GESTURE_MASK_DEFAULT;
+            }
+
+            ControllerContext->GestureMask = (UCHAR)(mask &
+                  ((1u << (FOCAL_TECH_WAKE_GESTURE_LAST - FOCAL_TECH_WAKE_GESTURE_FIRST + 1)) - 1));
+
+            writes[0].Address = FT5X_REGISTER_GESTURE_MASK;
+            writes[0].Value = ControllerContext->GestureMask;
+            writes[1].Address = FT5X_REGISTER_GESTURE_MASK_EXT;
+            writes[1].Value = 0;
+            writes[2].Address = FT5X_REGISTER_GESTURE_ENABLE;
+            writes[2].Value = 1;
+
+            //
+            // Mark the mode first, the first gesture interrupt may come in
+            // as soon as the engine is enabled
+            //
+            InterlockedExchange(&ControllerContext->GestureModeActive, 1);
+
+            status = SpbWriteRegistersSynchronously(SpbContext, writes, ARRAYSIZE(writes));
+
+            if (!NT_SUCCESS(status))
+            {
+                  InterlockedExchange(&ControllerContext->GestureModeActive, 0);
+            }
+      }
+      else
+      {
+            writes[0].Address = FT5X_REGISTER_GESTURE_ENABLE;
+            writes[0].Value = 0;
+
+            status = SpbWriteRegistersSynchronously(SpbContext, writes, 1);
+
+            InterlockedExchange(&ControllerContext->GestureModeActive, 0);
+      }
+
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_ERROR,
+                  TRACE_POWER,
+                  "Error switching gesture mode to %d - 0x%08lX",
+                  gestureMode,
+                  status);
+      }
+
+exit:
+      return status;
 }
 
 NTSTATUS
@@ -256,11 +1702,31 @@ Ft5xChangeSleepState(
     IN UCHAR SleepState
 )
 {
-      UNREFERENCED_PARAMETER(SpbContext);
+      UCHAR powerMode;
+
       UNREFERENCED_PARAMETER(ControllerContext);
-      UNREFERENCED_PARAMETER(SleepState);
 
-      return STATUS_SUCCESS;
+      //
+      // Monitor mode is also used for sleep, it keeps the controller
+      // answering on the bus so the wake path needs no reset
+      //
+      powerMode = FT5X_POWER_MODE_ACTIVE;
+
+      if (SleepState == FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_SLEEPING ||
+            SleepState == FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_MONITOR)
+      {
+            powerMode = FT5X_POWER_MODE_MONITOR;
+      }
+      else if (SleepState == FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_HIBERNATE)
+      {
+            powerMode = FT5X_POWER_MODE_HIBERNATE;
+      }
+
+      return SpbWriteDataSynchronously(
+            SpbContext,
+            FT5X_REGISTER_POWER_MODE,
+            &powerMode,
+            sizeof(powerMode));
 }
 
 NTSTATUS
@@ -269,10 +1735,42 @@ Ft5xGetFirmwareVersion(
     IN SPB_CONTEXT* SpbContext
 )
 {
-      UNREFERENCED_PARAMETER(SpbContext);
-      UNREFERENCED_PARAMETER(ControllerContext);
+      NTSTATUS status;
+      UCHAR firmwareVersion;
 
-      return STATUS_SUCCESS;
+      firmwareVersion = 0;
+
+      status = SpbReadDataSynchronously(
+            SpbContext,
+            FT5X_REGISTER_FIRMWARE_VERSION,
+            &firmwareVersion,
+            sizeof(firmwareVersion));
+
+      //
+      // The version is only informational, it stays 0 if unreadable
+      //
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_WARNING,
+                  TRACE_INIT,
+                  "Could not read firmware version - 0x%08lX",
+                  status);
+
+            status = STATUS_SUCCESS;
+            goto exit;
+      }
+
+      ControllerContext->RegisterImage.FirmwareVersion = firmwareVersion;
+
+      Trace(
+            TRACE_LEVEL_INFORMATION,
+            TRACE_INIT,
+            "Firmware version 0x%02X",
+            firmwareVersion);
+
+exit:
+      return status;
 }
 
 NTSTATUS
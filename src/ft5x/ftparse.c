@@ -0,0 +1,202 @@
+/*++
+      Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+      Module Name:
+
+            ftparse.c
+
+      Abstract:
+
+            Converts the touch frames read from FocalTech controllers into
+            the frames consumed by the reporting code. Kept apart from the
+            I/O paths so that it also builds in the user-mode replay bench.
+
+      Environment:
+
+            Kernel mode, user mode (replay bench)
+
+      Revision History:
+
+--*/
+
+#include <Cross Platform Shim\compat.h>
+#include <report.h>
+#include <ft5x\ftinternal.h>
+
+static FORCEINLINE VOID
+Ft5xParseRecords(
+      IN PFOCAL_TECH_EVENT_DATA EventData,
+      IN PTOUCH_FRAME Frame,
+      IN const int MaxTouchPoints
+)
+/*++
+
+Routine Description:
+
+      This routine converts a touch frame read from the controller into
+      the compact frame consumed by the reporting code. It is expanded
+      once per controller variant with MaxTouchPoints a constant, the
+      records being FOCAL_TECH_TOUCH_DATA on every variant.
+
+Arguments:
+
+      EventData - The frame read from the controller
+      Frame - A pointer to an initialized frame to fill
+      MaxTouchPoints - Number of contact records the variant exposes
+
+Return Value:
+
+      None
+
+--*/
+{
+      TOUCH_FRAME_CONTACT* contact;
+      int i, touchPoints;
+      UINT32 id;
+
+      BYTE X_MSB = 0;
+      BYTE X_LSB = 0;
+      BYTE Y_MSB = 0;
+      BYTE Y_LSB = 0;
+
+      touchPoints = EventData->NumberOfTouchPoints;
+
+      if (touchPoints > MaxTouchPoints)
+      {
+            touchPoints = MaxTouchPoints;
+      }
+
+      //
+      // Objects are keyed by the controller's touch ID, so a contact keeps
+      // its slot when the controller reorders its records. Lifted records
+      // are left out and show up to the cache as no longer present, as
+      // are records repeating a touch ID already in the frame.
+      //
+      for (i = 0; i < touchPoints; i++)
+      {
+            id = EventData->TouchData[i].TouchId;
+
+            if (id == FT5X_TOUCH_ID_INVALID ||
+                  id >= MAX_TOUCHES ||
+                  EventData->TouchData[i].EventFlag == FT5X_TOUCH_EVENT_LIFT_UP ||
+                  EventData->TouchData[i].EventFlag == FT5X_TOUCH_EVENT_NO_EVENT ||
+                  (Frame->Present & (1u << id)) != 0)
+            {
+                  continue;
+            }
+
+            X_MSB = EventData->TouchData[i].PositionX_High;
+            X_LSB = EventData->TouchData[i].PositionX_Low;
+            Y_MSB = EventData->TouchData[i].PositionY_High;
+            Y_LSB = EventData->TouchData[i].PositionY_Low;
+
+            contact = &Frame->Contacts[Frame->ContactCount++];
+
+            Frame->Present |= (1u << id);
+            contact->TouchId = (UCHAR)id;
+            contact->State = OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS;
+            contact->X = (USHORT)((X_MSB << 8) | X_LSB);
+            contact->Y = (USHORT)((Y_MSB << 8) | Y_LSB);
+      }
+}
+
+VOID
+Ft5xParseEventData(
+      IN PFOCAL_TECH_EVENT_DATA EventData,
+      IN PTOUCH_FRAME Frame
+)
+/*++
+
+Routine Description:
+
+      This routine parses a frame taking as many records as any variant
+      exposes, which is the layout of the FT5x46.
+
+Arguments:
+
+      EventData - The frame read from the controller
+      Frame - A pointer to an initialized frame to fill
+
+Return Value:
+
+      None
+
+--*/
+{
+      Ft5xParseRecords(EventData, Frame, FT5X_MAX_TOUCH_POINTS);
+}
+
+//
+// Parsers of the identified variants, one per record count
+//
+#define FT5X_DEFINE_PARSER(MaxTouchPoints) \
+      static VOID \
+      Ft5xParseEventData##MaxTouchPoints( \
+            IN PFOCAL_TECH_EVENT_DATA EventData, \
+            IN PTOUCH_FRAME Frame \
+      ) \
+      { \
+            Ft5xParseRecords(EventData, Frame, MaxTouchPoints); \
+      }
+
+FT5X_DEFINE_PARSER(2)
+FT5X_DEFINE_PARSER(5)
+FT5X_DEFINE_PARSER(6)
+
+#define FT5X_VARIANT_ENTRY(ChipId, MaxTouchPoints, ParseEventData, Name) \
+      { \
+            (ChipId), \
+            (MaxTouchPoints), \
+            (ULONG)FIELD_OFFSET(FOCAL_TECH_EVENT_DATA, TouchData[MaxTouchPoints]), \
+            (ParseEventData), \
+            (Name) \
+      }
+
+//
+// Known controllers by the ID in FT5X_REGISTER_CHIP_ID. They share the
+// register map and record layout and differ in how many records they
+// expose, so a frame read stops after the last record of the variant.
+// The last entry is taken for any other ID and keeps the 6 record frame
+// of the boards that report none, only an identified FT5x46 reads 10.
+//
+static const FT5X_VARIANT gFt5xVariants[] =
+{
+      FT5X_VARIANT_ENTRY(0x06, 2, Ft5xParseEventData2, "FT6x06"),
+      FT5X_VARIANT_ENTRY(0x36, 2, Ft5xParseEventData2, "FT6x36"),
+      FT5X_VARIANT_ENTRY(0x55, 5, Ft5xParseEventData5, "FT5x06"),
+      FT5X_VARIANT_ENTRY(0x54, FT5X_MAX_TOUCH_POINTS, Ft5xParseEventData, "FT5x46"),
+      FT5X_VARIANT_ENTRY(0x00, 6, Ft5xParseEventData6, "FT5x"),
+};
+
+const FT5X_VARIANT*
+Ft5xFindVariant(
+      IN UCHAR ChipId
+)
+/*++
+
+Routine Description:
+
+      This routine looks up the controller variant with the given chip ID.
+
+Arguments:
+
+      ChipId - Value read from FT5X_REGISTER_CHIP_ID, 0 if unknown
+
+Return Value:
+
+      The variant, the generic one if the chip ID is not known
+
+--*/
+{
+      ULONG i;
+
+      for (i = 0; i < ARRAYSIZE(gFt5xVariants) - 1; i++)
+      {
+            if (gFt5xVariants[i].ChipId == ChipId)
+            {
+                  break;
+            }
+      }
+
+      return &gFt5xVariants[i];
+}
@@ -25,6 +25,7 @@
 #include <controller.h>
 #include <ft5x\ftinternal.h>
 #include <hid.h>
+#include <tracelog.h>
 #include <hid.tmh>
 
 const USHORT gOEMVendorID = 0x6674;    // "ft"
@@ -51,6 +52,22 @@ const UCHAR gReportDescriptor[] = {
 };
 const ULONG gdwcbReportDescriptor = sizeof(gReportDescriptor);
 
+//
+// HID Report Descriptor for a touch device reporting in parallel mode
+//
+
+const UCHAR gReportDescriptorParallel[] = {
+	FOCALTECH_FT5X_DIGITIZER_DIAGNOSTIC1,
+	FOCALTECH_FT5X_DIGITIZER_DIAGNOSTIC2,
+	FOCALTECH_FT5X_DIGITIZER_DIAGNOSTIC3,
+	FOCALTECH_FT5X_DIGITIZER_DIAGNOSTIC4,
+	FOCALTECH_FT5X_DIGITIZER_FINGER_PARALLEL,
+	FOCALTECH_FT5X_DIGITIZER_REPORTMODE,
+	FOCALTECH_FT5X_DIGITIZER_KEYPAD,
+	FOCALTECH_FT5X_DIGITIZER_STYLUS
+};
+const ULONG gdwcbReportDescriptorParallel = sizeof(gReportDescriptorParallel);
+
 //
 // HID Descriptor for a touch device
 //
@@ -67,169 +84,615 @@ const HID_DESCRIPTOR gHidDescriptor =
 	}
 };
 
-NTSTATUS
-TchSendReport(
+static
+VOID
+TchGetReportDescriptorTemplate(
+	IN PDEVICE_EXTENSION DevContext,
+	OUT const UCHAR** Descriptor,
+	OUT ULONG* DescriptorLength
+)
+/*++
+
+Routine Description:
+
+	Selects the report descriptor matching the finger reporting mode of
+	the device, hybrid (two contacts per report) or parallel (all contacts
+	in one report).
+
+Arguments:
+
+	DevContext - Device context
+	Descriptor - Receives the report descriptor template
+	DescriptorLength - Receives the report descriptor length in bytes
+
+Return Value:
+
+	None
+
+--*/
+{
+	if (DevContext->ReportContext->ParallelMode)
+	{
+		*Descriptor = gReportDescriptorParallel;
+		*DescriptorLength = gdwcbReportDescriptorParallel;
+	}
+	else
+	{
+		*Descriptor = gReportDescriptor;
+		*DescriptorLength = gdwcbReportDescriptor;
+	}
+}
+
+static
+LONG
+TchReportRingCount(
+	IN PHID_REPORT_RING ReportRing
+)
+{
+	return (LONG)((ULONG)ReportRing->EnqueuePosition - (ULONG)ReportRing->DequeuePosition);
+}
+
+static
+BOOLEAN
+TchReportRingEnqueueFrame(
+	IN PHID_REPORT_RING ReportRing,
+	IN PHID_INPUT_REPORT Reports,
+	IN ULONG ReportCount,
+	IN BOOLEAN Coalescable
+)
+/*++
+
+Routine Description:
+
+	Claims consecutive free cells of the report ring for all reports of a
+	frame at once and publishes a copy of each report into them.
+
+Arguments:
+
+	ReportRing - Report ring
+	Reports - Reports of the frame, in order
+	ReportCount - Number of reports, at least 1
+	Coalescable - TRUE if the whole frame is superseded by the next one
+
+Return Value:
+
+	FALSE if the ring cannot take the whole frame
+
+--*/
+{
+	PHID_REPORT_RING_CELL cell;
+	LONG position;
+	LONG sequence;
+	LONG difference;
+	ULONG i;
+
+	position = ReportRing->EnqueuePosition;
+
+	for (;;)
+	{
+		//
+		// Every cell of the frame must be free in this lap of the ring
+		//
+		difference = 0;
+
+		for (i = 0; i < ReportCount; i++)
+		{
+			cell = &ReportRing->Cells[((ULONG)position + i) & HID_REPORT_RING_MASK];
+			sequence = cell->Sequence;
+			KeMemoryBarrier();
+
+			difference = (LONG)((ULONG)sequence - ((ULONG)position + i));
+
+			if (difference != 0)
+			{
+				break;
+			}
+		}
+
+		if (difference == 0)
+		{
+			LONG observed = InterlockedCompareExchange(
+				&ReportRing->EnqueuePosition,
+				(LONG)((ULONG)position + ReportCount),
+				position);
+
+			if (observed == position)
+			{
+				break;
+			}
+
+			position = observed;
+		}
+		else if (difference < 0)
+		{
+			return FALSE;
+		}
+		else
+		{
+			position = ReportRing->EnqueuePosition;
+		}
+	}
+
+	for (i = 0; i < ReportCount; i++)
+	{
+		cell = &ReportRing->Cells[((ULONG)position + i) & HID_REPORT_RING_MASK];
+
+		RtlCopyMemory(&cell->Report, &Reports[i], sizeof(HID_INPUT_REPORT));
+		cell->FrameReports = (UCHAR)((i == 0) ? ReportCount : 0);
+		cell->Coalescable = Coalescable;
+
+		InterlockedExchange(&cell->Sequence, (LONG)((ULONG)position + i + 1));
+	}
+
+	return TRUE;
+}
+
+static
+BOOLEAN
+TchReportRingDequeue(
+	IN PHID_REPORT_RING ReportRing,
+	OUT PHID_INPUT_REPORT Report
+)
+/*++
+
+Routine Description:
+
+	Claims the oldest published cell of the report ring, copies its report
+	out and releases the cell to producers.
+
+Arguments:
+
+	ReportRing - Report ring
+	Report - Receives the oldest buffered report
+
+Return Value:
+
+	FALSE if the ring is empty
+
+--*/
+{
+	PHID_REPORT_RING_CELL cell;
+	LONG position;
+	LONG sequence;
+	LONG difference;
+
+	position = ReportRing->DequeuePosition;
+
+	for (;;)
+	{
+		cell = &ReportRing->Cells[(ULONG)position & HID_REPORT_RING_MASK];
+		sequence = cell->Sequence;
+		KeMemoryBarrier();
+
+		difference = (LONG)((ULONG)sequence - ((ULONG)position + 1));
+
+		if (difference == 0)
+		{
+			LONG observed = InterlockedCompareExchange(
+				&ReportRing->DequeuePosition,
+				(LONG)((ULONG)position + 1),
+				position);
+
+			if (observed == position)
+			{
+				break;
+			}
+
+			position = observed;
+		}
+		else if (difference < 0)
+		{
+			return FALSE;
+		}
+		else
+		{
+			position = ReportRing->DequeuePosition;
+		}
+	}
+
+	RtlCopyMemory(Report, &cell->Report, sizeof(HID_INPUT_REPORT));
+
+	InterlockedExchange(&cell->Sequence, (LONG)((ULONG)position + HID_REPORT_RING_SIZE));
+
+	return TRUE;
+}
+
+static
+ULONG
+TchReportRingDiscardFrame(
+	IN PHID_REPORT_RING ReportRing
+)
+/*++
+
+Routine Description:
+
+	Releases the oldest frame of the report ring without handing it out,
+	if it is a move-only frame none of whose reports was handed out yet
+	and all of whose reports are published. It must only be called by
+	the drain owner, the only consumer of the ring.
+
+Arguments:
+
+	ReportRing - Report ring
+
+Return Value:
+
+	Number of reports discarded, 0 if the oldest frame must be kept
+
+--*/
+{
+	PHID_REPORT_RING_CELL cell;
+	LONG position;
+	ULONG reports;
+	ULONG i;
+
+	position = ReportRing->DequeuePosition;
+	cell = &ReportRing->Cells[(ULONG)position & HID_REPORT_RING_MASK];
+
+	if (cell->Sequence != (LONG)((ULONG)position + 1))
+	{
+		return 0;
+	}
+
+	KeMemoryBarrier();
+
+	reports = cell->FrameReports;
+
+	if (reports == 0 || cell->Coalescable == FALSE)
+	{
+		return 0;
+	}
+
+	for (i = 1; i < reports; i++)
+	{
+		cell = &ReportRing->Cells[((ULONG)position + i) & HID_REPORT_RING_MASK];
+
+		if (cell->Sequence != (LONG)((ULONG)position + i + 1))
+		{
+			return 0;
+		}
+	}
+
+	InterlockedExchange(&ReportRing->DequeuePosition, (LONG)((ULONG)position + reports));
+
+	for (i = 0; i < reports; i++)
+	{
+		cell = &ReportRing->Cells[((ULONG)position + i) & HID_REPORT_RING_MASK];
+
+		InterlockedExchange(&cell->Sequence, (LONG)((ULONG)position + i + HID_REPORT_RING_SIZE));
+	}
+
+	return reports;
+}
+
+VOID
+TchInitializeReportRing(
+	IN PHID_REPORT_RING ReportRing
+)
+/*++
+
+Routine Description:
+
+	Resets the report ring to its empty state. Must not race with
+	producers or consumers.
+
+Arguments:
+
+	ReportRing - Report ring
+
+Return Value:
+
+	None
+
+--*/
+{
+	ULONG i;
+
+	RtlZeroMemory(ReportRing, sizeof(HID_REPORT_RING));
+
+	for (i = 0; i < HID_REPORT_RING_SIZE; i++)
+	{
+		ReportRing->Cells[i].Sequence = (LONG)i;
+	}
+}
+
+static
+VOID
+TchDrainReportRingToRoom(
 	IN WDFQUEUE PingPongQueue,
-	IN PHID_INPUT_REPORT hidReportFromDriver
+	IN PHID_REPORT_RING ReportRing,
+	IN LONG FreeCells
 )
+/*++
+
+Routine Description:
+
+	Completes pending HIDClass read requests with buffered reports, oldest
+	first. Only one caller drains at a time so reports keep their order;
+	concurrent callers leave their drain to the current owner. Once no
+	request takes more reports, the owner coalesces away the oldest
+	move-only frames until FreeCells cells are free.
+
+Arguments:
+
+	PingPongQueue - Manual queue holding HIDClass read requests
+	ReportRing - Report ring
+	FreeCells - Free cells the caller needs, 0 for none
+
+Return Value:
+
+	None
+
+--*/
 {
-	NTSTATUS status;
 	WDFREQUEST request;
-	PHID_INPUT_REPORT hidReportRequestBuffer;
-	size_t hidReportRequestBufferLength;
+	NTSTATUS status;
+	LONG requests;
+	ULONG discarded;
 
-	status = STATUS_SUCCESS;
-	request = NULL;
-
-	switch (hidReportFromDriver->ReportID)
-	{
-	case REPORTID_STYLUS:
-	{
-	Trace(
-		TRACE_LEVEL_INFORMATION,
-		TRACE_HID,
-		"HID pen: "
-		"Tip Switch = %d, "
-		"Barrel Switch = %d, "
-		"Invert = %d, "
-		"Eraser = %d, "
-		"In Range = %d, "
-		"X = %d, "
-		"Y = %d, "
-		"Tip Pressure = %d, "
-		"X Tilt = %d, "
-		"Y Tilt = %d",
-		hidReportFromDriver->PenReport.TipSwitch,
-		hidReportFromDriver->PenReport.BarrelSwitch,
-		hidReportFromDriver->PenReport.Invert,
-		hidReportFromDriver->PenReport.Eraser,
-		hidReportFromDriver->PenReport.InRange,
-		hidReportFromDriver->PenReport.X,
-		hidReportFromDriver->PenReport.Y,
-		hidReportFromDriver->PenReport.TipPressure,
-		hidReportFromDriver->PenReport.XTilt,
-		hidReportFromDriver->PenReport.YTilt);
-	break;
-	}
-	case REPORTID_FINGER:
+	if (InterlockedIncrement(&ReportRing->DrainRequests) != 1)
 	{
-		Trace(
-			TRACE_LEVEL_INFORMATION,
-			TRACE_HID,
-			"HID Finger: "
-			"Contact Count = %d\n"
-			"Tip Switch = %d, "
-			"In Range = %d, "
-			"Confidence = %d, "
-			"Contact ID = %d, "
-			"X = %d, "
-			"Y = %d\n"
-			"Tip Switch = %d, "
-			"In Range = %d, "
-			"Confidence = %d, "
-			"Contact ID = %d, "
-			"X = %d, "
-			"Y = %d",
-			hidReportFromDriver->TouchReport.ContactCount,
-			hidReportFromDriver->TouchReport.Contacts[0].TipSwitch,
-			hidReportFromDriver->TouchReport.Contacts[0].InRange,
-			hidReportFromDriver->TouchReport.Contacts[0].Confidence,
-			hidReportFromDriver->TouchReport.Contacts[0].ContactID,
-			hidReportFromDriver->TouchReport.Contacts[0].X,
-			hidReportFromDriver->TouchReport.Contacts[0].Y,
-			hidReportFromDriver->TouchReport.Contacts[1].TipSwitch,
-			hidReportFromDriver->TouchReport.Contacts[1].InRange,
-			hidReportFromDriver->TouchReport.Contacts[1].Confidence,
-			hidReportFromDriver->TouchReport.Contacts[1].ContactID,
-			hidReportFromDriver->TouchReport.Contacts[1].X,
-			hidReportFromDriver->TouchReport.Contacts[1].Y);
-		break;
+		return;
 	}
-	case REPORTID_KEYPAD:
+
+	requests = 1;
+
+	for (;;)
 	{
-		Trace(
-			TRACE_LEVEL_INFORMATION,
-			TRACE_HID,
-			"HID key: "
-			"System Power Down = %d, "
-			"Start = %d, "
-			"AC Search = %d, "
-			"AC Back = %d",
-			hidReportFromDriver->KeyReport.SystemPowerDown,
-			hidReportFromDriver->KeyReport.Start,
-			hidReportFromDriver->KeyReport.ACSearch,
-			hidReportFromDriver->KeyReport.ACBack);
-	}
+		while (TchReportRingCount(ReportRing) > 0)
+		{
+			status = WdfIoQueueRetrieveNextRequest(
+				PingPongQueue,
+				&request);
+
+			if (!NT_SUCCESS(status))
+			{
+				break;
+			}
+
+			//
+			// The buffer was validated when the request was parked, the
+			// report goes straight into it
+			//
+			if (!TchReportRingDequeue(ReportRing, GetReadRequestContext(request)->Report))
+			{
+				//
+				// The producer has claimed a cell but not published it yet,
+				// it drains again once it has
+				//
+				status = WdfRequestRequeue(request);
+
+				if (!NT_SUCCESS(status))
+				{
+					Trace(
+						TRACE_LEVEL_ERROR,
+						TRACE_HID,
+						"Failed to requeue HID read request - 0x%08lX",
+						status);
+
+					WdfRequestComplete(request, status);
+				}
+
+				break;
+			}
+
+			WdfRequestSetInformation(request, sizeof(HID_INPUT_REPORT));
+			WdfRequestComplete(request, STATUS_SUCCESS);
+		}
+
+		while (HID_REPORT_RING_SIZE - TchReportRingCount(ReportRing) < FreeCells)
+		{
+			discarded = TchReportRingDiscardFrame(ReportRing);
+
+			if (discarded == 0)
+			{
+				break;
+			}
+
+			InterlockedExchangeAdd(&ReportRing->CoalescedReports, (LONG)discarded);
+		}
+
+		requests = InterlockedExchangeAdd(&ReportRing->DrainRequests, -requests) - requests;
+
+		if (requests == 0)
+		{
+			break;
+		}
 	}
+}
+
+VOID
+TchDrainReportRing(
+	IN WDFQUEUE PingPongQueue,
+	IN PHID_REPORT_RING ReportRing
+)
+/*++
+
+Routine Description:
+
+	Completes pending HIDClass read requests with buffered reports, oldest
+	first.
+
+Arguments:
+
+	PingPongQueue - Manual queue holding HIDClass read requests
+	ReportRing - Report ring
+
+Return Value:
+
+	None
+
+--*/
+{
+	TchDrainReportRingToRoom(PingPongQueue, ReportRing, 0);
+}
+
+NTSTATUS
+TchSendReportFrame(
+	IN WDFQUEUE PingPongQueue,
+	IN PHID_REPORT_RING ReportRing,
+	IN PHID_INPUT_REPORT Reports,
+	IN ULONG ReportCount,
+	IN BOOLEAN Coalescable
+)
+/*++
+
+Routine Description:
+
+	Hands the reports of a frame to HIDClass. The reports are buffered in
+	the report ring together and complete the oldest pending read requests
+	in order, or wait in the ring for TchReadReport if no read request is
+	pending. A frame is buffered whole or not at all, so HIDClass never
+	sees a frame whose first report is missing.
+
+	When the ring runs short the oldest move-only frames are coalesced
+	away first. A move-only frame that still does not fit next to the
+	reserve is coalesced away itself, and the caller reports its positions
+	again with the next frame.
+
+Arguments:
+
+	PingPongQueue - Manual queue holding HIDClass read requests
+	ReportRing - Report ring
+	Reports - Reports of the frame, in order
+	ReportCount - Number of reports, at least 1
+	Coalescable - TRUE if a later frame fully supersedes this one, such as
+		a finger frame carrying no lift-up
+
+Return Value:
+
+	STATUS_SUCCESS if every report of the frame was buffered,
+	STATUS_DEVICE_BUSY if the move-only frame was coalesced away
+
+--*/
+{
+	NTSTATUS status;
+	LONG freeCells;
+	ULONG i;
+
+	status = STATUS_SUCCESS;
 
 	//
-	// Complete a HIDClass request if one is available
+	// Pen and finger reports go out on every frame, trace them through
+	// TraceLogging so they cost nothing while no session listens
 	//
-	status = WdfIoQueueRetrieveNextRequest(
-		PingPongQueue,
-		&request);
-
-	if (!NT_SUCCESS(status))
+	for (i = 0; i < ReportCount; i++)
 	{
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_REPORTING,
-			"No request pending from HIDClass, ignoring report - 0x%08lX",
-			status);
-
-		goto exit;
+		switch (Reports[i].ReportID)
+		{
+		case REPORTID_STYLUS:
+		{
+			TchTracePenReport(&Reports[i].PenReport);
+			break;
+		}
+		case REPORTID_FINGER:
+		{
+			TchTraceFingerReport(&Reports[i]);
+			break;
+		}
+		case REPORTID_KEYPAD:
+		{
+			Trace(
+				TRACE_LEVEL_INFORMATION,
+				TRACE_HID,
+				"HID key: "
+				"System Power Down = %d, "
+				"Start = %d, "
+				"AC Search = %d, "
+				"AC Back = %d",
+				Reports[i].KeyReport.SystemPowerDown,
+				Reports[i].KeyReport.Start,
+				Reports[i].KeyReport.ACSearch,
+				Reports[i].KeyReport.ACBack);
+		}
+		}
 	}
 
 	//
-	// Validate an output buffer was provided
+	// Flush older reports first so they keep their place ahead of these,
+	// and make room for the frame by dropping superseded ones
 	//
-	status = WdfRequestRetrieveOutputBuffer(
-		request,
-		sizeof(HID_INPUT_REPORT),
-		&hidReportRequestBuffer,
-		&hidReportRequestBufferLength);
+	freeCells = (LONG)ReportCount;
 
-	if (!NT_SUCCESS(status))
+	if (Coalescable != FALSE)
+	{
+		freeCells += HID_REPORT_RING_RESERVE;
+	}
+
+	TchDrainReportRingToRoom(PingPongQueue, ReportRing, freeCells);
+
+	if (Coalescable != FALSE &&
+		HID_REPORT_RING_SIZE - TchReportRingCount(ReportRing) < freeCells)
 	{
+		InterlockedExchangeAdd(&ReportRing->CoalescedReports, (LONG)ReportCount);
+
+		status = STATUS_DEVICE_BUSY;
+
 		Trace(
 			TRACE_LEVEL_VERBOSE,
-			TRACE_SAMPLES,
-			"Error retrieving HID read request output buffer - 0x%08lX",
-			status);
+			TRACE_REPORTING,
+			"No request pending from HIDClass, coalescing move-only frame (%d coalesced)",
+			ReportRing->CoalescedReports);
+
+		goto exit;
 	}
-	else
+
+	if (!TchReportRingEnqueueFrame(ReportRing, Reports, ReportCount, Coalescable))
 	{
-		//
-		// Validate the size of the output buffer
-		//
-		if (hidReportRequestBufferLength < sizeof(HID_INPUT_REPORT))
-		{
-			status = STATUS_BUFFER_TOO_SMALL;
+		InterlockedExchangeAdd(&ReportRing->DroppedReports, (LONG)ReportCount);
 
-			Trace(
-				TRACE_LEVEL_VERBOSE,
-				TRACE_SAMPLES,
-				"Error HID read request buffer is too small (%I64x bytes) - 0x%08lX",
-				hidReportRequestBufferLength,
-				status);
-		}
-		else
-		{
-			RtlCopyMemory(
-				hidReportRequestBuffer,
-				hidReportFromDriver,
-				sizeof(HID_INPUT_REPORT));
+		status = STATUS_INSUFFICIENT_RESOURCES;
 
-			WdfRequestSetInformation(request, sizeof(HID_INPUT_REPORT));
-		}
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_REPORTING,
+			"Report ring full, dropping frame (%d dropped) - 0x%08lX",
+			ReportRing->DroppedReports,
+			status);
+
+		goto exit;
 	}
 
-	WdfRequestComplete(request, status);
+	TchDrainReportRingToRoom(PingPongQueue, ReportRing, 0);
 
 exit:
 	return status;
 }
 
+NTSTATUS
+TchSendReport(
+	IN WDFQUEUE PingPongQueue,
+	IN PHID_REPORT_RING ReportRing,
+	IN PHID_INPUT_REPORT hidReportFromDriver,
+	IN BOOLEAN Coalescable
+)
+/*++
+
+Routine Description:
+
+	Hands a report that makes up a frame on its own to HIDClass.
+
+Arguments:
+
+	PingPongQueue - Manual queue holding HIDClass read requests
+	ReportRing - Report ring
+	hidReportFromDriver - Report to send
+	Coalescable - TRUE if a later report fully supersedes this one
+
+Return Value:
+
+	NTSTATUS indicating whether the report was accepted
+
+--*/
+{
+	return TchSendReportFrame(
+		PingPongQueue,
+		ReportRing,
+		hidReportFromDriver,
+		1,
+		Coalescable);
+}
+
 NTSTATUS
 TchReadReport(
 	IN WDFDEVICE Device,
@@ -258,13 +721,37 @@ Return Value:
 --*/
 {
 	PDEVICE_EXTENSION devContext;
+	PHID_INPUT_REPORT report;
 	NTSTATUS status;
 
 	devContext = GetDeviceContext(Device);
 
+	//
+	// Validate the output buffer once, reports are written into it
+	// without looking at the request again
+	//
+	status = WdfRequestRetrieveOutputBuffer(
+		Request,
+		sizeof(HID_INPUT_REPORT),
+		(PVOID*)&report,
+		NULL);
+
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_HID,
+			"Error retrieving HID read request output buffer - 0x%08lX",
+			status);
+
+		goto exit;
+	}
+
+	GetReadRequestContext(Request)->Report = report;
+
 	status = WdfRequestForwardToIoQueue(
 		Request,
-		devContext->ReportContext.PingPongQueue);
+		devContext->ReportContext->PingPongQueue);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -282,16 +769,36 @@ Return Value:
 		*Pending = TRUE;
 	}
 
+	//
+	// Hand out any report buffered while no read request was pending
+	//
+	TchDrainReportRing(
+		devContext->ReportContext->PingPongQueue,
+		&devContext->ReportContext->ReportRing);
+
 	//
 	// Service any interrupt that may have asserted while the framework had
 	// interrupts disabled, or occurred before a read request was queued.
+	// The interrupt lock serializes this with the ISR, which shares the
+	// controller frame buffer.
 	//
 	if (devContext->ServiceInterruptsAfterD0Entry == TRUE)
 	{
+		WdfInterruptAcquireLock(devContext->InterruptObject);
+
+		//
+		// The interrupt that raised the frame was not seen, stamp it now
+		//
+		WriteNoFence64(
+			&devContext->ReportContext->InterruptTime,
+			(LONG64)KeQueryInterruptTime());
+
 		Ft5xServiceInterrupts(
 			devContext->TouchContext,
 			&devContext->I2CContext,
-			&devContext->ReportContext);
+			devContext->ReportContext);
+
+		WdfInterruptReleaseLock(devContext->InterruptObject);
 
 		devContext->ServiceInterruptsAfterD0Entry = FALSE;
 	}
@@ -383,98 +890,229 @@ Return Value:
 	return status;
 }
 
-NTSTATUS
-TchGenerateHidReportDescriptor(
-	IN WDFDEVICE Device,
-	IN WDFMEMORY Memory
+C_ASSERT(sizeof(gReportDescriptor) <= HID_REPORT_DESCRIPTOR_MAX_LENGTH);
+C_ASSERT(sizeof(gReportDescriptorParallel) <= HID_REPORT_DESCRIPTOR_MAX_LENGTH);
+
+UCHAR
+TchGetMaximumContacts(
+	IN WDFDEVICE Device
 )
+/*++
+
+Routine Description:
+
+	Returns the number of contacts the digitizer reports, as advertised in
+	the report descriptor and the device capabilities feature report. It
+	follows the variant identified by the chip ID when the controller was
+	started.
+
+Arguments:
+
+	Device - Handle to WDF Device Object
+
+Return Value:
+
+	The maximum number of contacts
+
+--*/
 {
 	PDEVICE_EXTENSION devContext;
-	FT5X_CONTROLLER_CONTEXT* touchContext;
-	NTSTATUS status;
+	UCHAR maxContacts = PTP_MAX_CONTACT_POINTS;
 
 	devContext = GetDeviceContext(Device);
 
-	touchContext = (FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext;
+	if (devContext->TouchContext != NULL &&
+		((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->Variant != NULL)
+	{
+		maxContacts = (UCHAR)min(
+			((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->Variant->MaxTouchPoints,
+			PTP_MAX_CONTACT_POINTS);
+	}
 
-	PUCHAR hidReportDescBuffer = (PUCHAR)ExAllocatePoolWithTag(
-		NonPagedPool,
-		gdwcbReportDescriptor,
-		TOUCH_POOL_TAG
-	);
+	return maxContacts;
+}
 
-	if (hidReportDescBuffer == NULL)
-	{
-		Trace(
-			TRACE_LEVEL_INFORMATION,
-			TRACE_HID,
-			"Failed to create hidReportDescBuffer on %p",
-			hidReportDescBuffer);
+static
+NTSTATUS
+TchFindReportDescriptorPatches(
+	IN PHID_REPORT_DESCRIPTOR_CACHE Cache
+)
+/*++
 
-		return STATUS_FATAL_MEMORY_EXHAUSTION;
-	}
+Routine Description:
 
-	RtlCopyBytes(
-		hidReportDescBuffer,
-		gReportDescriptor,
-		gdwcbReportDescriptor
-	);
+	Walks the items of the report descriptor template and records where
+	the display extents and the contact count are to be patched. Extents
+	are 16-bit logical and physical maxima holding the 0xFEFE (width) and
+	0xFDFD (height) placeholders, the contact count is the logical maximum
+	following the Maximum Contacts usage.
 
-	for (unsigned int i = 0; i < gdwcbReportDescriptor - 2; i++)
+Arguments:
+
+	Cache - Descriptor cache holding the template
+
+Return Value:
+
+	NTSTATUS indicating success or failure
+
+--*/
+{
+	const UCHAR* item = Cache->Template;
+	ULONG length = Cache->Length;
+	ULONG offset = 0;
+	ULONG size;
+	UCHAR previous = 0;
+	UCHAR previousData = 0;
+	USHORT kind;
+
+	Cache->PatchCount = 0;
+
+	while (offset < length)
 	{
-		if (*(hidReportDescBuffer + i) == LOGICAL_MAXIMUM_2)
+		//
+		// Short items only, the size is encoded in the two low bits
+		//
+		size = item[offset] & 0x3;
+		size = (size == 3) ? 4 : size;
+
+		if (offset + 1 + size > length)
 		{
-			if (*(hidReportDescBuffer + i + 1) == 0xFE &&
-				*(hidReportDescBuffer + i + 2) == 0xFE)
+			return STATUS_INVALID_BUFFER_SIZE;
+		}
+
+		kind = MAXUSHORT;
+
+		if ((item[offset] == LOGICAL_MAXIMUM_2 || item[offset] == PHYSICAL_MAXIMUM_2) &&
+			item[offset + 1] == item[offset + 2] &&
+			(item[offset + 1] == 0xFE || item[offset + 1] == 0xFD))
+		{
+			if (item[offset] == LOGICAL_MAXIMUM_2)
 			{
-				*(hidReportDescBuffer + i + 1) = devContext->ReportContext.Props.DisplayPhysicalWidth & 0xFF;
-				*(hidReportDescBuffer + i + 2) = (devContext->ReportContext.Props.DisplayPhysicalWidth >> 8) & 0xFF;
+				kind = (item[offset + 1] == 0xFE) ? HidPatchLogicalWidth : HidPatchLogicalHeight;
 			}
-			if (*(hidReportDescBuffer + i + 1) == 0xFD &&
-				*(hidReportDescBuffer + i + 2) == 0xFD)
+			else
 			{
-				*(hidReportDescBuffer + i + 1) = devContext->ReportContext.Props.DisplayPhysicalHeight & 0xFF;
-				*(hidReportDescBuffer + i + 2) = (devContext->ReportContext.Props.DisplayPhysicalHeight >> 8) & 0xFF;
+				kind = (item[offset + 1] == 0xFE) ? HidPatchPhysicalWidth : HidPatchPhysicalHeight;
 			}
 		}
-		else if (*(hidReportDescBuffer + i) == PHYSICAL_MAXIMUM_2)
+		else if (item[offset] == LOGICAL_MAXIMUM &&
+			previous == USAGE &&
+			previousData == 0x55)
 		{
-			if (*(hidReportDescBuffer + i + 1) == 0xFE &&
-				*(hidReportDescBuffer + i + 2) == 0xFE)
-			{
-				*(hidReportDescBuffer + i + 1) = devContext->ReportContext.Props.DisplayWidth10um & 0xFF;
-				*(hidReportDescBuffer + i + 2) = (devContext->ReportContext.Props.DisplayWidth10um >> 8) & 0xFF;
-			}
-			if (*(hidReportDescBuffer + i + 1) == 0xFD &&
-				*(hidReportDescBuffer + i + 2) == 0xFD)
+			kind = HidPatchMaximumContacts;
+		}
+
+		if (kind != MAXUSHORT)
+		{
+			if (Cache->PatchCount == HID_REPORT_DESCRIPTOR_MAX_PATCHES)
 			{
-				*(hidReportDescBuffer + i + 1) = devContext->ReportContext.Props.DisplayHeight10um & 0xFF;
-				*(hidReportDescBuffer + i + 2) = (devContext->ReportContext.Props.DisplayHeight10um >> 8) & 0xFF;
+				return STATUS_INSUFFICIENT_RESOURCES;
 			}
+
+			Cache->Patches[Cache->PatchCount].Offset = (USHORT)(offset + 1);
+			Cache->Patches[Cache->PatchCount].Kind = kind;
+			Cache->PatchCount++;
 		}
+
+		previous = item[offset];
+		previousData = (size > 0) ? item[offset + 1] : 0;
+		offset += 1 + size;
 	}
 
-	//
-	// Use hardcoded Report descriptor
-	//
-	status = WdfMemoryCopyFromBuffer(
-		Memory,
-		0,
-		(PVOID)hidReportDescBuffer,
-		gdwcbReportDescriptor);
+	return STATUS_SUCCESS;
+}
 
-	if (!NT_SUCCESS(status))
+NTSTATUS
+TchBuildReportDescriptor(
+	IN WDFDEVICE Device
+)
+/*++
+
+Routine Description:
+
+	Builds the report descriptor for the current reporting mode, screen
+	properties and contact count. It is called once the controller is
+	started in PrepareHardware, and only rewrites the patched values if
+	one of them changed.
+
+Arguments:
+
+	Device - Handle to WDF Device Object
+
+Return Value:
+
+	NTSTATUS indicating success or failure
+
+--*/
+{
+	PDEVICE_EXTENSION devContext;
+	PHID_REPORT_DESCRIPTOR_CACHE cache;
+	const UCHAR* reportDescriptor;
+	ULONG reportDescriptorLength;
+	USHORT values[HidPatchMaximumContacts + 1];
+	HID_REPORT_DESCRIPTOR_PATCH* patch;
+	NTSTATUS status = STATUS_SUCCESS;
+	ULONG i;
+
+	devContext = GetDeviceContext(Device);
+	cache = &devContext->Configuration.ReportDescriptor;
+
+	TchGetReportDescriptorTemplate(
+		devContext,
+		&reportDescriptor,
+		&reportDescriptorLength);
+
+	if (cache->Template != reportDescriptor)
+	{
+		cache->Template = reportDescriptor;
+		cache->Length = reportDescriptorLength;
+		cache->Built = FALSE;
+
+		status = TchFindReportDescriptorPatches(cache);
+
+		if (!NT_SUCCESS(status))
+		{
+			Trace(
+				TRACE_LEVEL_ERROR,
+				TRACE_HID,
+				"Error parsing HID report descriptor template - 0x%08lX",
+				status);
+
+			cache->Template = NULL;
+			goto exit;
+		}
+
+		RtlCopyMemory(cache->Descriptor, reportDescriptor, reportDescriptorLength);
+	}
+
+	values[HidPatchLogicalWidth] = (USHORT)devContext->ReportContext->Props.DisplayPhysicalWidth;
+	values[HidPatchLogicalHeight] = (USHORT)devContext->ReportContext->Props.DisplayPhysicalHeight;
+	values[HidPatchPhysicalWidth] = (USHORT)devContext->ReportContext->Props.DisplayWidth10um;
+	values[HidPatchPhysicalHeight] = (USHORT)devContext->ReportContext->Props.DisplayHeight10um;
+	values[HidPatchMaximumContacts] = TchGetMaximumContacts(Device);
+
+	if (cache->Built &&
+		RtlEqualMemory(cache->Values, values, sizeof(values)))
 	{
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_HID,
-			"Error copying HID report descriptor to request memory - STATUS:%X",
-			status);
 		goto exit;
 	}
 
+	for (i = 0; i < cache->PatchCount; i++)
+	{
+		patch = &cache->Patches[i];
+
+		cache->Descriptor[patch->Offset] = (UCHAR)(values[patch->Kind] & 0xFF);
+
+		if (patch->Kind != HidPatchMaximumContacts)
+		{
+			cache->Descriptor[patch->Offset + 1] = (UCHAR)((values[patch->Kind] >> 8) & 0xFF);
+		}
+	}
+
+	RtlCopyMemory(cache->Values, values, sizeof(values));
+	cache->Built = TRUE;
+
 exit:
-	ExFreePoolWithTag((PVOID)hidReportDescBuffer, TOUCH_POOL_TAG);
 	return status;
 }
 
@@ -502,11 +1140,11 @@ Return Value:
 
 --*/
 {
+	PDEVICE_EXTENSION devContext;
+	HID_DESCRIPTOR hidDescriptor;
 	WDFMEMORY memory;
 	NTSTATUS status;
 
-	UNREFERENCED_PARAMETER(Device);
-
 	//
 	// This IOCTL is METHOD_NEITHER so WdfRequestRetrieveOutputMemory
 	// will correctly retrieve buffer from Irp->UserBuffer. 
@@ -529,13 +1167,29 @@ Return Value:
 	}
 
 	//
-	// Use hardcoded global HID Descriptor
+	// Use hardcoded global HID Descriptor, sized for the report descriptor
+	// of the current reporting mode
 	//
+	devContext = GetDeviceContext(Device);
+
+	if (!devContext->Configuration.ReportDescriptor.Built)
+	{
+		status = TchBuildReportDescriptor(Device);
+
+		if (!NT_SUCCESS(status))
+		{
+			goto exit;
+		}
+	}
+
+	hidDescriptor = gHidDescriptor;
+	hidDescriptor.DescriptorList[0].wReportLength = (USHORT)devContext->Configuration.ReportDescriptor.Length;
+
 	status = WdfMemoryCopyFromBuffer(
 		memory,
 		0,
-		(PUCHAR) &gHidDescriptor,
-		sizeof(gHidDescriptor));
+		(PUCHAR) &hidDescriptor,
+		sizeof(hidDescriptor));
 
 	if (!NT_SUCCESS(status))
 	{
@@ -584,9 +1238,12 @@ Return Value:
 
 --*/
 {
+	PDEVICE_EXTENSION devContext;
 	WDFMEMORY memory;
 	NTSTATUS status;
 
+	devContext = GetDeviceContext(Device);
+
 	//
 	// This IOCTL is METHOD_NEITHER so WdfRequestRetrieveOutputMemory
 	// will correctly retrieve buffer from Irp->UserBuffer. 
@@ -609,12 +1266,23 @@ Return Value:
 	}
 
 	//
-	// Use hardcoded Report descriptor
+	// The descriptor is normally built in PrepareHardware
 	//
-	status = TchGenerateHidReportDescriptor(
-		Device,
-		memory
-	);
+	if (!devContext->Configuration.ReportDescriptor.Built)
+	{
+		status = TchBuildReportDescriptor(Device);
+
+		if (!NT_SUCCESS(status))
+		{
+			goto exit;
+		}
+	}
+
+	status = WdfMemoryCopyFromBuffer(
+		memory,
+		0,
+		(PVOID)devContext->Configuration.ReportDescriptor.Descriptor,
+		devContext->Configuration.ReportDescriptor.Length);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -629,7 +1297,7 @@ Return Value:
 	//
 	// Report how many bytes were copied
 	//
-	WdfRequestSetInformation(Request, gdwcbReportDescriptor);
+	WdfRequestSetInformation(Request, devContext->Configuration.ReportDescriptor.Length);
 
 exit:
 
@@ -842,13 +1510,11 @@ Return Value:
 
 --*/
 {
-	PDEVICE_EXTENSION devContext;
 	PHID_XFER_PACKET featurePacket;
 	WDF_REQUEST_PARAMETERS params;
 	NTSTATUS status;
 	size_t ReportSize;
 
-	devContext = GetDeviceContext(Device);
 	status = STATUS_SUCCESS;
 
 	//
@@ -902,14 +1568,9 @@ Return Value:
 
 		PPTP_DEVICE_CAPS_FEATURE_REPORT capsReport = (PPTP_DEVICE_CAPS_FEATURE_REPORT) featurePacket->reportBuffer;
 
-		capsReport->MaximumContactPoints = PTP_MAX_CONTACT_POINTS;
+		capsReport->MaximumContactPoints = TchGetMaximumContacts(Device);
 		capsReport->ReportID = REPORTID_DEVICE_CAPS;
 
-		if (devContext->TouchContext != NULL && ((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->MaxFingers != 0)
-		{
-			capsReport->MaximumContactPoints = ((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->MaxFingers;
-		}
-
 		Trace(
 			TRACE_LEVEL_INFORMATION,
 			TRACE_DRIVER,
@@ -47,7 +47,8 @@ Routine Description:
 
    In the case of this touch miniport, we are using the HID class driver's
    enhanced power management functionality, whereby invoking the callback
-   results in an immediate exit from D0, powering off touch.
+   results in an immediate exit from D0, leaving the controller in
+   monitor mode until it is touched.
 
    The Request will be completed when either HIDCLASS cancels it or
    there is a device wake signal that will cause us to complete it.
@@ -58,7 +58,7 @@ TchStartDevice(
 	status = STATUS_SUCCESS;
 
 	//
-	// Populate context with FT5X function descriptors
+	// Identify the controller, which sets the frame read length and parser
 	//
 	status = Ft5xBuildFunctionsTable(
 		ControllerContext,
@@ -123,6 +123,11 @@ TchStartDevice(
 		goto exit;
 	}
 
+	//
+	// The controller is configured, later wakes only replay the registers
+	//
+	controller->RegisterImage.Valid = TRUE;
+
 	//
 	// Clear any pending interrupts
 	//
@@ -141,6 +146,30 @@ TchStartDevice(
 			status);
 	}
 
+	//
+	// Set up the switch to monitor mode once the panel goes idle
+	//
+	status = Ft5xInitializeMonitorMode(
+		ControllerContext,
+		SpbContext);
+
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INIT,
+			"Could not set up monitor mode - 0x%08lX",
+			status);
+		goto exit;
+	}
+
+	//
+	// Set up asynchronous frame reads if they are enabled
+	//
+	status = Ft5xInitializeAsyncFrameRead(
+		ControllerContext,
+		SpbContext);
+
 exit:
 	return status;
 }
@@ -173,13 +202,16 @@ Return Value:
 
 	controller = (FT5X_CONTROLLER_CONTEXT*)ControllerContext;
 
+	Ft5xDeinitializeAsyncFrameRead(controller);
+
 	return STATUS_SUCCESS;
 }
 
 NTSTATUS
 TchAllocateContext(
 	OUT VOID** ControllerContext,
-	IN WDFDEVICE FxDevice
+	IN WDFDEVICE FxDevice,
+	IN const TOUCH_CONFIGURATION_BLOB_HEADER* ConfigurationBlob OPTIONAL
 )
 /*++
 
@@ -191,6 +223,8 @@ Argument:
 
 	ControllerContext - Touch controller context
 	FxDevice - Framework device object
+	ConfigurationBlob - Optional validated blob replacing the registry
+	settings
 
 Return Value:
 
@@ -218,11 +252,14 @@ Return Value:
 
 	RtlZeroMemory(context, sizeof(FT5X_CONTROLLER_CONTEXT));
 	context->FxDevice = FxDevice;
+	context->Variant = Ft5xFindVariant(0);
 
 	//
 	// Get Touch settings and populate context
 	//
-	TchGetTouchSettings(&context->TouchSettings);
+	TchGetTouchSettings(&context->TouchSettings, ConfigurationBlob);
+
+	context->Recorder.Enabled = (context->TouchSettings.FrameRecorderEnabled != 0);
 
 	//
 	// Allocate a WDFWAITLOCK for guarding access to the
@@ -156,7 +156,6 @@ TchPowerSettingCallback(
         }
 
         DWORD DisplayState = *(DWORD*)Value;
-        DWORD GestureEnabled = 0;
 
         switch (DisplayState)
         {
@@ -166,24 +165,12 @@ TchPowerSettingCallback(
                 TRACE_POWER,
                 "The Display is Off");
 
-            status = PowerToggle(&devContext->TouchPowerContext, 0);
-
-            if (!NT_SUCCESS(status))
-            {
-                Trace(
-                    TRACE_LEVEL_ERROR,
-                    TRACE_POWER,
-                    "Error changing touch power state - 0x%08lX",
-                    status);
-                goto exit;
-            }
-
-            if (NT_SUCCESS(RtlReadRegistryValue(
-                (PCWSTR)L"\\Registry\\Machine\\SOFTWARE\\OEM\\Nokia\\Touch\\WakeupGesture",
-                (PCWSTR)L"Enabled",
-                REG_DWORD,
-                &GestureEnabled,
-                sizeof(DWORD))) && GestureEnabled == 1)
+            //
+            // With wake gestures the rail stays up so the controller's
+            // gesture engine can watch the panel, the host only hears of
+            // the gestures it enabled
+            //
+            if (TchGetSettingsSnapshot(devContext)->WakeupGestureEnabled == 1)
             {
                 status = Ft5xSetReportingFlagsF12(
                     ControllerContext,
@@ -192,27 +179,36 @@ TchPowerSettingCallback(
                     NULL
                 );
 
-                if (!NT_SUCCESS(status))
+                if (NT_SUCCESS(status))
                 {
-                    Trace(
-                        TRACE_LEVEL_ERROR,
-                        TRACE_POWER,
-                        "Error Changing Reporting Mode for F12 - 0x%08lX",
-                        status);
-                    goto exit;
+                    break;
                 }
+
+                Trace(
+                    TRACE_LEVEL_ERROR,
+                    TRACE_POWER,
+                    "Error Changing Reporting Mode for F12 - 0x%08lX",
+                    status);
             }
 
+            status = PowerToggle(&devContext->Configuration.TouchPowerContext, 0);
+
             if (!NT_SUCCESS(status))
             {
                 Trace(
                     TRACE_LEVEL_ERROR,
                     TRACE_POWER,
-                    "Error Changing Reporting Mode for F12 - 0x%08lX",
+                    "Error changing touch power state - 0x%08lX",
                     status);
                 goto exit;
             }
 
+            //
+            // The controller loses its configuration with the rail, the
+            // next wake cannot take the monitor mode shortcut
+            //
+            InterlockedExchange(&ControllerContext->PowerRailOff, 1);
+
             break;
         case 1:
             Trace(
@@ -220,7 +216,7 @@ TchPowerSettingCallback(
                 TRACE_POWER,
                 "The Display is On");
 
-            status = PowerToggle(&devContext->TouchPowerContext, 1);
+            status = PowerToggle(&devContext->Configuration.TouchPowerContext, 1);
 
             if (!NT_SUCCESS(status))
             {
@@ -278,7 +274,10 @@ TchWakeDevice(
 
 Routine Description:
 
-   Enables multi-touch scanning
+   Enables multi-touch scanning. A controller left in monitor mode
+   with its rail up still has its configuration and only needs to be
+   switched back to operating mode, otherwise the configuration of the
+   last start is restored first.
 
 Arguments:
 
@@ -293,6 +292,7 @@ Return Value:
 --*/
 {    
     FT5X_CONTROLLER_CONTEXT* controller;
+    DEVICE_POWER_STATE previousState;
     NTSTATUS status;
 
     controller = (FT5X_CONTROLLER_CONTEXT*) ControllerContext;
@@ -305,8 +305,54 @@ Return Value:
         goto exit;
     }
 
+    previousState = controller->DevicePowerState;
     controller->DevicePowerState = PowerDeviceD0;
 
+    if (previousState == PowerDeviceD2 &&
+        controller->PowerRailOff == 0)
+    {
+        goto resume;
+    }
+
+    //
+    // The touch power rail may have been cut while the display was off, in
+    // which case the controller boots again. A controller that stayed up
+    // answers the first poll.
+    //
+    status = Ft5xWaitForReady(SpbContext, TOUCH_DELAY_TO_COMMUNICATE);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_POWER,
+            "Controller did not answer within %lu us after power up - 0x%08lX",
+            (ULONG)TOUCH_DELAY_TO_COMMUNICATE,
+            status);
+    }
+
+    //
+    // Put back the configuration of the last start in one transfer, in
+    // case the controller lost it with its rail
+    //
+    status = Ft5xRestoreConfiguration(controller, SpbContext);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_POWER,
+            "Error restoring touch controller configuration - 0x%08lX",
+            status);
+    }
+    else
+    {
+        InterlockedExchange(&controller->PowerRailOff, 0);
+    }
+
+resume:
+    Ft5xResumeAsyncFrameRead(controller);
+
     //
     // Attempt to put the controller into operating mode 
     //
@@ -324,6 +370,11 @@ Return Value:
             status);
     }
 
+    //
+    // Count the idle period before monitor mode from the wake
+    //
+    Ft5xRestartMonitorIdleTimer(controller);
+
 exit:
 
     return STATUS_SUCCESS;
@@ -333,13 +384,19 @@ NTSTATUS
 TchStandbyDevice(
    IN VOID *ControllerContext,
    IN SPB_CONTEXT *SpbContext,
-   IN VOID* ReportContext
+   IN VOID* ReportContext,
+   IN BOOLEAN RuntimeIdle,
+   IN BOOLEAN Hibernate
    )
 /*++
 
 Routine Description:
 
-   Disables multi-touch scanning to conserve power
+   Disables multi-touch scanning to conserve power. The controller is
+   left in monitor mode, where a touch still raises its interrupt and
+   its configuration is kept, or hibernated if asked to. Only a runtime
+   idle may keep the configuration for the next wake, across system
+   sleep the firmware may cut the controller's rail.
 
 Arguments:
 
@@ -347,6 +404,14 @@ Arguments:
    
    SpbContext - A pointer to the current i2c context
 
+   ReportContext - Report context whose contacts are forgotten
+
+   RuntimeIdle - TRUE if the device idles out of D0 with the system
+      running, FALSE for system sleep and removal
+
+   Hibernate - TRUE to hibernate the controller, which only a reset
+      brings back
+
 Return Value:
 
    NTSTATUS indicating success or failure
@@ -365,13 +430,23 @@ Return Value:
     //
     WdfWaitLockAcquire(controller->ControllerLock, NULL);
 
+    //
+    // Let asynchronous frame reads still on the bus finish before the
+    // controller goes to sleep
+    //
+    Ft5xStopAsyncFrameRead(controller);
+
+    Ft5xStopMonitorIdleTimer(controller);
+
     //
     // Put the chip in sleep mode
     //
     status = Ft5xChangeSleepState(
         ControllerContext,
         SpbContext,
-        FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_SLEEPING);
+        Hibernate ?
+            FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_HIBERNATE :
+            FT5X_F01_DEVICE_CONTROL_SLEEP_MODE_SLEEPING);
 
     if (!NT_SUCCESS(status))
     {
@@ -382,14 +457,18 @@ Return Value:
             status);
     }
 
-    controller->DevicePowerState = PowerDeviceD3;
+    //
+    // Unless the controller took monitor mode during a runtime idle it is
+    // restored in full on wake like a hibernated one
+    //
+    controller->DevicePowerState =
+        (RuntimeIdle && !Hibernate && NT_SUCCESS(status)) ?
+            PowerDeviceD2 : PowerDeviceD3;
 
     //
     // Invalidate state
     //
-    ((PREPORT_CONTEXT)ReportContext)->Cache.SlotValid = 0;
-    ((PREPORT_CONTEXT)ReportContext)->Cache.SlotDirty = 0;
-    ((PREPORT_CONTEXT)ReportContext)->Cache.DownCount = 0;
+    ReportResetObjectCache((PREPORT_CONTEXT)ReportContext);
     ((PREPORT_CONTEXT)ReportContext)->ButtonCache.ButtonSlots[0] = 0;
     ((PREPORT_CONTEXT)ReportContext)->ButtonCache.ButtonSlots[1] = 0;
     ((PREPORT_CONTEXT)ReportContext)->ButtonCache.ButtonSlots[2] = 0;
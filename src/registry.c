@@ -38,7 +38,7 @@
 // FT5X specification for a full description of the fields and value meanings
 //
 
-static FT5X_CONFIGURATION gDefaultConfiguration =
+static const FT5X_CONFIGURATION gDefaultConfiguration =
 {
     //
     // FT5X F01 - Device control settings
@@ -105,7 +105,7 @@ static FT5X_CONFIGURATION gDefaultConfiguration =
     },
 };
 
-static TOUCH_SCREEN_SETTINGS gDefaultTouchSettings =
+static const TOUCH_SCREEN_SETTINGS gDefaultTouchSettings =
 {
     0x1,
     0x0,
@@ -280,16 +280,34 @@ static TOUCH_SCREEN_SETTINGS gDefaultTouchSettings =
     0x3FFF,
     0x3FFF,
     0x0,
+    0x0,
+    0x0,
+    0x0,
+    0x0,
+    0x0,
+    0x0,
+    0x0,
+    0x0,
+    0x0,
+    0x32,
+    0x0,
+    0x0,
+    0x0,
+    0xFFFFFFFF,
+    0xFFFFFFFF,
+    0xFFFFFFFF,
+    0xFFFFFFFF,
+    0xFFFFFFFF,
 };
 
-RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
+static const RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
 {
     {
         NULL, RTL_QUERY_REGISTRY_DIRECT,
         L"DeviceId",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DeviceId)),
         REG_DWORD,
-        &gDefaultTouchSettings.DeviceId,
+        (PVOID)&gDefaultTouchSettings.DeviceId,
         sizeof(UINT32)
     },
     {
@@ -297,7 +315,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"UseControllerSleep",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, UseControllerSleep)),
         REG_DWORD,
-        &gDefaultTouchSettings.UseControllerSleep,
+        (PVOID)&gDefaultTouchSettings.UseControllerSleep,
         sizeof(UINT32)
     },
     {
@@ -305,7 +323,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"UseNoSleepBit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, UseNoSleepBit)),
         REG_DWORD,
-        &gDefaultTouchSettings.UseNoSleepBit,
+        (PVOID)&gDefaultTouchSettings.UseNoSleepBit,
         sizeof(UINT32)
     },
     {
@@ -313,7 +331,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ImprovedTouchSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ImprovedTouchSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ImprovedTouchSupported,
+        (PVOID)&gDefaultTouchSettings.ImprovedTouchSupported,
         sizeof(UINT32)
     },
     {
@@ -321,7 +339,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"WakeupGestureSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, WakeupGestureSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.WakeupGestureSupported,
+        (PVOID)&gDefaultTouchSettings.WakeupGestureSupported,
         sizeof(UINT32)
     },
     {
@@ -329,7 +347,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ChargerDetectionSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ChargerDetectionSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ChargerDetectionSupported,
+        (PVOID)&gDefaultTouchSettings.ChargerDetectionSupported,
         sizeof(UINT32)
     },
     {
@@ -337,7 +355,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ActivePenSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ActivePenSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ActivePenSupported,
+        (PVOID)&gDefaultTouchSettings.ActivePenSupported,
         sizeof(UINT32)
     },
     {
@@ -345,7 +363,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ExtClockControlSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ExtClockControlSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ExtClockControlSupported,
+        (PVOID)&gDefaultTouchSettings.ExtClockControlSupported,
         sizeof(UINT32)
     },
     {
@@ -353,7 +371,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ForceDriverSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ForceDriverSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ForceDriverSupported,
+        (PVOID)&gDefaultTouchSettings.ForceDriverSupported,
         sizeof(UINT32)
     },
     {
@@ -361,7 +379,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"DoubleTapMaxTapTime10ms",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DoubleTapMaxTapTime10ms)),
         REG_DWORD,
-        &gDefaultTouchSettings.DoubleTapMaxTapTime10ms,
+        (PVOID)&gDefaultTouchSettings.DoubleTapMaxTapTime10ms,
         sizeof(UINT32)
     },
     {
@@ -369,7 +387,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"DoubleTapMaxTapDistance100um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DoubleTapMaxTapDistance100um)),
         REG_DWORD,
-        &gDefaultTouchSettings.DoubleTapMaxTapDistance100um,
+        (PVOID)&gDefaultTouchSettings.DoubleTapMaxTapDistance100um,
         sizeof(UINT32)
     },
     {
@@ -377,7 +395,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"DoubleTapDeadZoneWidth100um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DoubleTapDeadZoneWidth100um)),
         REG_DWORD,
-        &gDefaultTouchSettings.DoubleTapDeadZoneWidth100um,
+        (PVOID)&gDefaultTouchSettings.DoubleTapDeadZoneWidth100um,
         sizeof(UINT32)
     },
     {
@@ -385,7 +403,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"DoubleTapDeadZoneHeight100um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DoubleTapDeadZoneHeight100um)),
         REG_DWORD,
-        &gDefaultTouchSettings.DoubleTapDeadZoneHeight100um,
+        (PVOID)&gDefaultTouchSettings.DoubleTapDeadZoneHeight100um,
         sizeof(UINT32)
     },
     {
@@ -393,7 +411,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ControllerType",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ControllerType)),
         REG_DWORD,
-        &gDefaultTouchSettings.ControllerType,
+        (PVOID)&gDefaultTouchSettings.ControllerType,
         sizeof(UINT32)
     },
     {
@@ -401,7 +419,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"VendorCount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, VendorCount)),
         REG_DWORD,
-        &gDefaultTouchSettings.VendorCount,
+        (PVOID)&gDefaultTouchSettings.VendorCount,
         sizeof(UINT32)
     },
     {
@@ -409,7 +427,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ResetControllerInWakeUp",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ResetControllerInWakeUp)),
         REG_DWORD,
-        &gDefaultTouchSettings.ResetControllerInWakeUp,
+        (PVOID)&gDefaultTouchSettings.ResetControllerInWakeUp,
         sizeof(UINT32)
     },
     {
@@ -417,7 +435,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00,
+        (PVOID)&gDefaultTouchSettings.Vendor00,
         sizeof(UINT32)
     },
     {
@@ -425,7 +443,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01,
+        (PVOID)&gDefaultTouchSettings.Vendor01,
         sizeof(UINT32)
     },
     {
@@ -433,7 +451,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02,
+        (PVOID)&gDefaultTouchSettings.Vendor02,
         sizeof(UINT32)
     },
     {
@@ -441,7 +459,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03,
+        (PVOID)&gDefaultTouchSettings.Vendor03,
         sizeof(UINT32)
     },
     {
@@ -449,7 +467,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Revision00",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Revision00)),
         REG_DWORD,
-        &gDefaultTouchSettings.Revision00,
+        (PVOID)&gDefaultTouchSettings.Revision00,
         sizeof(UINT32)
     },
     {
@@ -457,7 +475,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Revision01",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Revision01)),
         REG_DWORD,
-        &gDefaultTouchSettings.Revision01,
+        (PVOID)&gDefaultTouchSettings.Revision01,
         sizeof(UINT32)
     },
     {
@@ -465,7 +483,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Revision02",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Revision02)),
         REG_DWORD,
-        &gDefaultTouchSettings.Revision02,
+        (PVOID)&gDefaultTouchSettings.Revision02,
         sizeof(UINT32)
     },
     {
@@ -473,7 +491,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Revision03",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Revision03)),
         REG_DWORD,
-        &gDefaultTouchSettings.Revision03,
+        (PVOID)&gDefaultTouchSettings.Revision03,
         sizeof(UINT32)
     },
     {
@@ -481,7 +499,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ReprogramFw00",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ReprogramFw00)),
         REG_DWORD,
-        &gDefaultTouchSettings.ReprogramFw00,
+        (PVOID)&gDefaultTouchSettings.ReprogramFw00,
         sizeof(UINT32)
     },
     {
@@ -489,7 +507,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ReprogramFw01",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ReprogramFw01)),
         REG_DWORD,
-        &gDefaultTouchSettings.ReprogramFw01,
+        (PVOID)&gDefaultTouchSettings.ReprogramFw01,
         sizeof(UINT32)
     },
     {
@@ -497,7 +515,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ReprogramFw02",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ReprogramFw02)),
         REG_DWORD,
-        &gDefaultTouchSettings.ReprogramFw02,
+        (PVOID)&gDefaultTouchSettings.ReprogramFw02,
         sizeof(UINT32)
     },
     {
@@ -505,7 +523,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ReprogramFw03",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ReprogramFw03)),
         REG_DWORD,
-        &gDefaultTouchSettings.ReprogramFw03,
+        (PVOID)&gDefaultTouchSettings.ReprogramFw03,
         sizeof(UINT32)
     },
     {
@@ -513,7 +531,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ForceFlash",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ForceFlash)),
         REG_DWORD,
-        &gDefaultTouchSettings.ForceFlash,
+        (PVOID)&gDefaultTouchSettings.ForceFlash,
         sizeof(UINT32)
     },
     {
@@ -521,7 +539,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId0",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId0)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId0,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId0,
         sizeof(UINT32)
     },
     {
@@ -529,7 +547,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId1",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId1)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId1,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId1,
         sizeof(UINT32)
     },
     {
@@ -537,7 +555,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId2",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId2)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId2,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId2,
         sizeof(UINT32)
     },
     {
@@ -545,7 +563,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId3",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId3)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId3,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId3,
         sizeof(UINT32)
     },
     {
@@ -553,7 +571,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId4",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId4)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId4,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId4,
         sizeof(UINT32)
     },
     {
@@ -561,7 +579,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId5",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId5)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId5,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId5,
         sizeof(UINT32)
     },
     {
@@ -569,7 +587,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId6",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId6)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId6,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId6,
         sizeof(UINT32)
     },
     {
@@ -577,7 +595,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId7",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId7)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId7,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId7,
         sizeof(UINT32)
     },
     {
@@ -585,7 +603,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId8",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId8)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId8,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId8,
         sizeof(UINT32)
     },
     {
@@ -593,7 +611,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId9",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId9)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId9,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId9,
         sizeof(UINT32)
     },
     {
@@ -601,7 +619,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId0",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId0)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId0,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId0,
         sizeof(UINT32)
     },
     {
@@ -609,7 +627,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId1",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId1)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId1,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId1,
         sizeof(UINT32)
     },
     {
@@ -617,7 +635,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId2",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId2)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId2,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId2,
         sizeof(UINT32)
     },
     {
@@ -625,7 +643,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId3",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId3)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId3,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId3,
         sizeof(UINT32)
     },
     {
@@ -633,7 +651,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId4",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId4)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId4,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId4,
         sizeof(UINT32)
     },
     {
@@ -641,7 +659,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId5",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId5)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId5,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId5,
         sizeof(UINT32)
     },
     {
@@ -649,7 +667,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId6",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId6)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId6,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId6,
         sizeof(UINT32)
     },
     {
@@ -657,7 +675,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId7",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId7)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId7,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId7,
         sizeof(UINT32)
     },
     {
@@ -665,7 +683,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId8",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId8)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId8,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId8,
         sizeof(UINT32)
     },
     {
@@ -673,7 +691,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId9",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId9)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId9,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId9,
         sizeof(UINT32)
     },
     {
@@ -681,7 +699,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId0",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId0)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId0,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId0,
         sizeof(UINT32)
     },
     {
@@ -689,7 +707,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId1",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId1)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId1,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId1,
         sizeof(UINT32)
     },
     {
@@ -697,7 +715,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId2",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId2)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId2,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId2,
         sizeof(UINT32)
     },
     {
@@ -705,7 +723,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId3",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId3)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId3,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId3,
         sizeof(UINT32)
     },
     {
@@ -713,7 +731,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId4",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId4)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId4,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId4,
         sizeof(UINT32)
     },
     {
@@ -721,7 +739,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId5",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId5)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId5,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId5,
         sizeof(UINT32)
     },
     {
@@ -729,7 +747,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId6",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId6)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId6,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId6,
         sizeof(UINT32)
     },
     {
@@ -737,7 +755,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId7",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId7)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId7,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId7,
         sizeof(UINT32)
     },
     {
@@ -745,7 +763,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId8",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId8)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId8,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId8,
         sizeof(UINT32)
     },
     {
@@ -753,7 +771,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId9",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId9)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId9,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId9,
         sizeof(UINT32)
     },
     {
@@ -761,7 +779,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId0",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId0)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId0,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId0,
         sizeof(UINT32)
     },
     {
@@ -769,7 +787,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId1",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId1)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId1,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId1,
         sizeof(UINT32)
     },
     {
@@ -777,7 +795,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId2",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId2)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId2,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId2,
         sizeof(UINT32)
     },
     {
@@ -785,7 +803,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId3",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId3)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId3,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId3,
         sizeof(UINT32)
     },
     {
@@ -793,7 +811,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId4",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId4)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId4,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId4,
         sizeof(UINT32)
     },
     {
@@ -801,7 +819,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId5",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId5)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId5,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId5,
         sizeof(UINT32)
     },
     {
@@ -809,7 +827,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId6",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId6)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId6,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId6,
         sizeof(UINT32)
     },
     {
@@ -817,7 +835,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId7",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId7)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId7,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId7,
         sizeof(UINT32)
     },
     {
@@ -825,7 +843,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId8",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId8)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId8,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId8,
         sizeof(UINT32)
     },
     {
@@ -833,7 +851,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId9",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId9)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId9,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId9,
         sizeof(UINT32)
     },
     {
@@ -841,7 +859,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeHighResTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeHighResTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeHighResTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeHighResTest,
         sizeof(UINT32)
     },
     {
@@ -849,7 +867,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00HighResMaxRxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00HighResMaxRxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00HighResMaxRxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00HighResMaxRxLimit,
         sizeof(UINT32)
     },
     {
@@ -857,7 +875,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00HighResMaxTxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00HighResMaxTxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00HighResMaxTxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00HighResMaxTxLimit,
         sizeof(UINT32)
     },
     {
@@ -865,7 +883,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00HighResMinImageLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00HighResMinImageLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00HighResMinImageLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00HighResMinImageLimit,
         sizeof(UINT32)
     },
     {
@@ -873,7 +891,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeBaselineMinMaxTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeBaselineMinMaxTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeBaselineMinMaxTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeBaselineMinMaxTest,
         sizeof(UINT32)
     },
     {
@@ -881,7 +899,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00BaselineMinMaxMinPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00BaselineMinMaxMinPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00BaselineMinMaxMinPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00BaselineMinMaxMinPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -889,7 +907,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00BaselineMinMaxMaxPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00BaselineMinMaxMaxPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00BaselineMinMaxMaxPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00BaselineMinMaxMaxPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -897,7 +915,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeFullBaselineTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeFullBaselineTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeFullBaselineTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeFullBaselineTest,
         sizeof(UINT32)
     },
     {
@@ -905,7 +923,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00RxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00RxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00RxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor00RxAmount,
         sizeof(UINT32)
     },
     {
@@ -913,7 +931,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00TxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00TxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00TxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor00TxAmount,
         sizeof(UINT32)
     },
     {
@@ -921,7 +939,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00RxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00RxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00RxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor00RxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -929,7 +947,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00TxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00TxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00TxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor00TxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -937,7 +955,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00RxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00RxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00RxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor00RxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -945,7 +963,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00TxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00TxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00TxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor00TxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -953,7 +971,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton0Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton0Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton0Min,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton0Min,
         sizeof(UINT32)
     },
     {
@@ -961,7 +979,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton1Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton1Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton1Min,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton1Min,
         sizeof(UINT32)
     },
     {
@@ -969,7 +987,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton2Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton2Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton2Min,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton2Min,
         sizeof(UINT32)
     },
     {
@@ -977,7 +995,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton0Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton0Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton0Max,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton0Max,
         sizeof(UINT32)
     },
     {
@@ -985,7 +1003,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton1Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton1Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton1Max,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton1Max,
         sizeof(UINT32)
     },
     {
@@ -993,7 +1011,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton2Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton2Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton2Max,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton2Max,
         sizeof(UINT32)
     },
     {
@@ -1001,7 +1019,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeAbsSenseRawCapTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeAbsSenseRawCapTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeAbsSenseRawCapTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeAbsSenseRawCapTest,
         sizeof(UINT32)
     },
     {
@@ -1009,7 +1027,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00AbsSenseRawCapTxRxStart",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00AbsSenseRawCapTxRxStart)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00AbsSenseRawCapTxRxStart,
+        (PVOID)&gDefaultTouchSettings.Vendor00AbsSenseRawCapTxRxStart,
         sizeof(UINT32)
     },
     {
@@ -1017,7 +1035,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00AbsSenseRawCapTxRxEnd",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00AbsSenseRawCapTxRxEnd)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00AbsSenseRawCapTxRxEnd,
+        (PVOID)&gDefaultTouchSettings.Vendor00AbsSenseRawCapTxRxEnd,
         sizeof(UINT32)
     },
     {
@@ -1025,7 +1043,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00AbsSenseRawCapMinLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00AbsSenseRawCapMinLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00AbsSenseRawCapMinLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00AbsSenseRawCapMinLimit,
         sizeof(UINT32)
     },
     {
@@ -1033,7 +1051,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00AbsSenseRawCapMaxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00AbsSenseRawCapMaxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00AbsSenseRawCapMaxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00AbsSenseRawCapMaxLimit,
         sizeof(UINT32)
     },
     {
@@ -1041,7 +1059,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeShortTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeShortTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeShortTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeShortTest,
         sizeof(UINT32)
     },
     {
@@ -1049,7 +1067,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeHighResTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeHighResTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeHighResTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeHighResTest,
         sizeof(UINT32)
     },
     {
@@ -1057,7 +1075,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01HighResMaxRxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01HighResMaxRxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01HighResMaxRxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01HighResMaxRxLimit,
         sizeof(UINT32)
     },
     {
@@ -1065,7 +1083,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01HighResMaxTxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01HighResMaxTxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01HighResMaxTxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01HighResMaxTxLimit,
         sizeof(UINT32)
     },
     {
@@ -1073,7 +1091,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01HighResMinImageLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01HighResMinImageLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01HighResMinImageLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01HighResMinImageLimit,
         sizeof(UINT32)
     },
     {
@@ -1081,7 +1099,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeBaselineMinMaxTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeBaselineMinMaxTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeBaselineMinMaxTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeBaselineMinMaxTest,
         sizeof(UINT32)
     },
     {
@@ -1089,7 +1107,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01BaselineMinMaxMinPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01BaselineMinMaxMinPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01BaselineMinMaxMinPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01BaselineMinMaxMinPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1097,7 +1115,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01BaselineMinMaxMaxPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01BaselineMinMaxMaxPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01BaselineMinMaxMaxPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01BaselineMinMaxMaxPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1105,7 +1123,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeFullBaselineTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeFullBaselineTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeFullBaselineTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeFullBaselineTest,
         sizeof(UINT32)
     },
     {
@@ -1113,7 +1131,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01RxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01RxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01RxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor01RxAmount,
         sizeof(UINT32)
     },
     {
@@ -1121,7 +1139,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01TxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01TxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01TxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor01TxAmount,
         sizeof(UINT32)
     },
     {
@@ -1129,7 +1147,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01RxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01RxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01RxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor01RxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1137,7 +1155,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01TxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01TxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01TxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor01TxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1145,7 +1163,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01RxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01RxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01RxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor01RxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1153,7 +1171,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01TxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01TxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01TxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor01TxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1161,7 +1179,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton0Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton0Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton0Min,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton0Min,
         sizeof(UINT32)
     },
     {
@@ -1169,7 +1187,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton1Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton1Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton1Min,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton1Min,
         sizeof(UINT32)
     },
     {
@@ -1177,7 +1195,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton2Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton2Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton2Min,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton2Min,
         sizeof(UINT32)
     },
     {
@@ -1185,7 +1203,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton0Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton0Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton0Max,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton0Max,
         sizeof(UINT32)
     },
     {
@@ -1193,7 +1211,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton1Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton1Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton1Max,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton1Max,
         sizeof(UINT32)
     },
     {
@@ -1201,7 +1219,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton2Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton2Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton2Max,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton2Max,
         sizeof(UINT32)
     },
     {
@@ -1209,7 +1227,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeAbsSenseRawCapTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeAbsSenseRawCapTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeAbsSenseRawCapTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeAbsSenseRawCapTest,
         sizeof(UINT32)
     },
     {
@@ -1217,7 +1235,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01AbsSenseRawCapTxRxStart",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01AbsSenseRawCapTxRxStart)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01AbsSenseRawCapTxRxStart,
+        (PVOID)&gDefaultTouchSettings.Vendor01AbsSenseRawCapTxRxStart,
         sizeof(UINT32)
     },
     {
@@ -1225,7 +1243,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01AbsSenseRawCapTxRxEnd",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01AbsSenseRawCapTxRxEnd)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01AbsSenseRawCapTxRxEnd,
+        (PVOID)&gDefaultTouchSettings.Vendor01AbsSenseRawCapTxRxEnd,
         sizeof(UINT32)
     },
     {
@@ -1233,7 +1251,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01AbsSenseRawCapMinLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01AbsSenseRawCapMinLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01AbsSenseRawCapMinLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01AbsSenseRawCapMinLimit,
         sizeof(UINT32)
     },
     {
@@ -1241,7 +1259,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01AbsSenseRawCapMaxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01AbsSenseRawCapMaxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01AbsSenseRawCapMaxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01AbsSenseRawCapMaxLimit,
         sizeof(UINT32)
     },
     {
@@ -1249,7 +1267,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeShortTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeShortTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeShortTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeShortTest,
         sizeof(UINT32)
     },
     {
@@ -1257,7 +1275,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeHighResTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeHighResTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeHighResTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeHighResTest,
         sizeof(UINT32)
     },
     {
@@ -1265,7 +1283,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02HighResMaxRxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02HighResMaxRxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02HighResMaxRxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02HighResMaxRxLimit,
         sizeof(UINT32)
     },
     {
@@ -1273,7 +1291,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02HighResMaxTxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02HighResMaxTxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02HighResMaxTxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02HighResMaxTxLimit,
         sizeof(UINT32)
     },
     {
@@ -1281,7 +1299,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02HighResMinImageLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02HighResMinImageLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02HighResMinImageLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02HighResMinImageLimit,
         sizeof(UINT32)
     },
     {
@@ -1289,7 +1307,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeBaselineMinMaxTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeBaselineMinMaxTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeBaselineMinMaxTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeBaselineMinMaxTest,
         sizeof(UINT32)
     },
     {
@@ -1297,7 +1315,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02BaselineMinMaxMinPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02BaselineMinMaxMinPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02BaselineMinMaxMinPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02BaselineMinMaxMinPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1305,7 +1323,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02BaselineMinMaxMaxPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02BaselineMinMaxMaxPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02BaselineMinMaxMaxPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02BaselineMinMaxMaxPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1313,7 +1331,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeFullBaselineTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeFullBaselineTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeFullBaselineTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeFullBaselineTest,
         sizeof(UINT32)
     },
     {
@@ -1321,7 +1339,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02RxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02RxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02RxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor02RxAmount,
         sizeof(UINT32)
     },
     {
@@ -1329,7 +1347,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02TxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02TxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02TxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor02TxAmount,
         sizeof(UINT32)
     },
     {
@@ -1337,7 +1355,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02RxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02RxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02RxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor02RxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1345,7 +1363,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02TxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02TxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02TxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor02TxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1353,7 +1371,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02RxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02RxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02RxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor02RxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1361,7 +1379,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02TxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02TxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02TxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor02TxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1369,7 +1387,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton0Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton0Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton0Min,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton0Min,
         sizeof(UINT32)
     },
     {
@@ -1377,7 +1395,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton1Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton1Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton1Min,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton1Min,
         sizeof(UINT32)
     },
     {
@@ -1385,7 +1403,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton2Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton2Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton2Min,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton2Min,
         sizeof(UINT32)
     },
     {
@@ -1393,7 +1411,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton0Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton0Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton0Max,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton0Max,
         sizeof(UINT32)
     },
     {
@@ -1401,7 +1419,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton1Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton1Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton1Max,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton1Max,
         sizeof(UINT32)
     },
     {
@@ -1409,7 +1427,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton2Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton2Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton2Max,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton2Max,
         sizeof(UINT32)
     },
     {
@@ -1417,7 +1435,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeAbsSenseRawCapTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeAbsSenseRawCapTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeAbsSenseRawCapTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeAbsSenseRawCapTest,
         sizeof(UINT32)
     },
     {
@@ -1425,7 +1443,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02AbsSenseRawCapTxRxStart",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02AbsSenseRawCapTxRxStart)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02AbsSenseRawCapTxRxStart,
+        (PVOID)&gDefaultTouchSettings.Vendor02AbsSenseRawCapTxRxStart,
         sizeof(UINT32)
     },
     {
@@ -1433,7 +1451,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02AbsSenseRawCapTxRxEnd",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02AbsSenseRawCapTxRxEnd)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02AbsSenseRawCapTxRxEnd,
+        (PVOID)&gDefaultTouchSettings.Vendor02AbsSenseRawCapTxRxEnd,
         sizeof(UINT32)
     },
     {
@@ -1441,7 +1459,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02AbsSenseRawCapMinLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02AbsSenseRawCapMinLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02AbsSenseRawCapMinLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02AbsSenseRawCapMinLimit,
         sizeof(UINT32)
     },
     {
@@ -1449,7 +1467,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02AbsSenseRawCapMaxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02AbsSenseRawCapMaxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02AbsSenseRawCapMaxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02AbsSenseRawCapMaxLimit,
         sizeof(UINT32)
     },
     {
@@ -1457,7 +1475,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeShortTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeShortTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeShortTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeShortTest,
         sizeof(UINT32)
     },
     {
@@ -1465,7 +1483,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeHighResTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeHighResTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeHighResTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeHighResTest,
         sizeof(UINT32)
     },
     {
@@ -1473,7 +1491,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03HighResMaxRxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03HighResMaxRxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03HighResMaxRxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03HighResMaxRxLimit,
         sizeof(UINT32)
     },
     {
@@ -1481,7 +1499,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03HighResMaxTxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03HighResMaxTxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03HighResMaxTxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03HighResMaxTxLimit,
         sizeof(UINT32)
     },
     {
@@ -1489,7 +1507,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03HighResMinImageLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03HighResMinImageLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03HighResMinImageLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03HighResMinImageLimit,
         sizeof(UINT32)
     },
     {
@@ -1497,7 +1515,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeBaselineMinMaxTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeBaselineMinMaxTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeBaselineMinMaxTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeBaselineMinMaxTest,
         sizeof(UINT32)
     },
     {
@@ -1505,7 +1523,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03BaselineMinMaxMinPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03BaselineMinMaxMinPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03BaselineMinMaxMinPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03BaselineMinMaxMinPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1513,7 +1531,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03BaselineMinMaxMaxPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03BaselineMinMaxMaxPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03BaselineMinMaxMaxPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03BaselineMinMaxMaxPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1521,7 +1539,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeFullBaselineTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeFullBaselineTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeFullBaselineTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeFullBaselineTest,
         sizeof(UINT32)
     },
     {
@@ -1529,7 +1547,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03RxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03RxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03RxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor03RxAmount,
         sizeof(UINT32)
     },
     {
@@ -1537,7 +1555,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03TxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03TxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03TxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor03TxAmount,
         sizeof(UINT32)
     },
     {
@@ -1545,7 +1563,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03RxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03RxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03RxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor03RxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1553,7 +1571,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03TxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03TxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03TxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor03TxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1561,7 +1579,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03RxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03RxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03RxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor03RxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1569,7 +1587,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03TxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03TxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03TxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor03TxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1577,7 +1595,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton0Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton0Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton0Min,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton0Min,
         sizeof(UINT32)
     },
     {
@@ -1585,7 +1603,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton1Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton1Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton1Min,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton1Min,
         sizeof(UINT32)
     },
     {
@@ -1593,7 +1611,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton2Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton2Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton2Min,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton2Min,
         sizeof(UINT32)
     },
     {
@@ -1601,7 +1619,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton0Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton0Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton0Max,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton0Max,
         sizeof(UINT32)
     },
     {
@@ -1609,7 +1627,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton1Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton1Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton1Max,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton1Max,
         sizeof(UINT32)
     },
     {
@@ -1617,7 +1635,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton2Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton2Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton2Max,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton2Max,
         sizeof(UINT32)
     },
     {
@@ -1625,7 +1643,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeAbsSenseRawCapTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeAbsSenseRawCapTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeAbsSenseRawCapTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeAbsSenseRawCapTest,
         sizeof(UINT32)
     },
     {
@@ -1633,7 +1651,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03AbsSenseRawCapTxRxStart",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03AbsSenseRawCapTxRxStart)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03AbsSenseRawCapTxRxStart,
+        (PVOID)&gDefaultTouchSettings.Vendor03AbsSenseRawCapTxRxStart,
         sizeof(UINT32)
     },
     {
@@ -1641,7 +1659,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03AbsSenseRawCapTxRxEnd",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03AbsSenseRawCapTxRxEnd)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03AbsSenseRawCapTxRxEnd,
+        (PVOID)&gDefaultTouchSettings.Vendor03AbsSenseRawCapTxRxEnd,
         sizeof(UINT32)
     },
     {
@@ -1649,7 +1667,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03AbsSenseRawCapMinLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03AbsSenseRawCapMinLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03AbsSenseRawCapMinLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03AbsSenseRawCapMinLimit,
         sizeof(UINT32)
     },
     {
@@ -1657,7 +1675,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03AbsSenseRawCapMaxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03AbsSenseRawCapMaxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03AbsSenseRawCapMaxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03AbsSenseRawCapMaxLimit,
         sizeof(UINT32)
     },
     {
@@ -1665,7 +1683,151 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeShortTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeShortTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeShortTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeShortTest,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"AdaptiveFrameRead",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, AdaptiveFrameRead)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.AdaptiveFrameRead,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"AsyncFrameRead",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, AsyncFrameRead)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.AsyncFrameRead,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"ParallelReportMode",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ParallelReportMode)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.ParallelReportMode,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"CoalesceInterrupts",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, CoalesceInterrupts)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.CoalesceInterrupts,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"StationaryThreshold",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, StationaryThreshold)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.StationaryThreshold,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"StationaryKeepaliveMs",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, StationaryKeepaliveMs)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.StationaryKeepaliveMs,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"MonitorIdleTimeoutMs",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, MonitorIdleTimeoutMs)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.MonitorIdleTimeoutMs,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"WakeupGestureMask",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, WakeupGestureMask)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.WakeupGestureMask,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"FrameRecorderEnabled",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, FrameRecorderEnabled)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.FrameRecorderEnabled,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"InterruptWatchdogMs",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, InterruptWatchdogMs)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.InterruptWatchdogMs,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"ServiceThreadEnabled",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ServiceThreadEnabled)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.ServiceThreadEnabled,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"ServiceThreadPriority",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ServiceThreadPriority)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.ServiceThreadPriority,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"ServiceThreadAffinityMask",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ServiceThreadAffinityMask)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.ServiceThreadAffinityMask,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"CtrlRegister",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, CtrlRegister)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.CtrlRegister,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"TimeEnterMonitorRegister",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, TimeEnterMonitorRegister)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.TimeEnterMonitorRegister,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"PeriodActiveRegister",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, PeriodActiveRegister)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.PeriodActiveRegister,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"PeriodMonitorRegister",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, PeriodMonitorRegister)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.PeriodMonitorRegister,
+        sizeof(UINT32)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"InterruptModeRegister",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, InterruptModeRegister)),
+        REG_DWORD,
+        (PVOID)&gDefaultTouchSettings.InterruptModeRegister,
         sizeof(UINT32)
     },
     //
@@ -1847,9 +2009,220 @@ size_t wstrlcat(wchar_t* dst, const wchar_t* src, size_t siz)
     return(dlen + (s - src));        /* count does not include NUL */
 }
 
+TOUCH_CONFIGURATION_BLOB_HEADER*
+TchLoadConfigurationBlob(
+    VOID
+)
+/*++
+
+  Routine Description:
+
+    This routine reads the configuration blob with a single value query
+    and returns a copy of it once its header matches the layout of this
+    build. The copy is handed to TchGetTouchSettings and
+    TchGetScreenProperties so a start reads the value only once.
+
+  Arguments:
+
+    None
+
+  Return Value:
+
+    Validated blob to be released with TchFreeConfigurationBlob, or NULL
+    if there is none
+
+--*/
+{
+    TOUCH_CONFIGURATION_BLOB_HEADER* header;
+    TOUCH_CONFIGURATION_BLOB_HEADER* blob;
+    PKEY_VALUE_PARTIAL_INFORMATION info;
+    UNICODE_STRING keyName;
+    UNICODE_STRING valueName;
+    OBJECT_ATTRIBUTES keyAttributes;
+    HANDLE key;
+    ULONG length;
+    ULONG resultLength;
+    NTSTATUS status;
+
+    key = NULL;
+    info = NULL;
+    blob = NULL;
+
+    RtlInitUnicodeString(&keyName, TOUCH_REG_KEY);
+    RtlInitUnicodeString(&valueName, TOUCH_CONFIGURATION_BLOB_VALUE);
+
+    InitializeObjectAttributes(
+        &keyAttributes,
+        &keyName,
+        OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE,
+        NULL,
+        NULL);
+
+    status = ZwOpenKey(&key, KEY_QUERY_VALUE, &keyAttributes);
+
+    if (!NT_SUCCESS(status))
+    {
+        key = NULL;
+        goto exit;
+    }
+
+    length = FIELD_OFFSET(KEY_VALUE_PARTIAL_INFORMATION, Data) + TOUCH_CONFIGURATION_BLOB_SIZE;
+
+    info = ExAllocatePoolWithTag(PagedPool, length, TOUCH_POOL_TAG);
+
+    if (info == NULL)
+    {
+        goto exit;
+    }
+
+    status = ZwQueryValueKey(
+        key,
+        &valueName,
+        KeyValuePartialInformation,
+        info,
+        length,
+        &resultLength);
+
+    //
+    // A blob of another size, including a larger one, comes from another
+    // layout and fails the query or the checks below
+    //
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    header = (TOUCH_CONFIGURATION_BLOB_HEADER*)info->Data;
+
+    if (info->Type != REG_BINARY ||
+        info->DataLength != TOUCH_CONFIGURATION_BLOB_SIZE ||
+        header->Signature != TOUCH_CONFIGURATION_BLOB_SIGNATURE ||
+        header->Version != TOUCH_CONFIGURATION_BLOB_VERSION ||
+        header->HeaderSize != sizeof(TOUCH_CONFIGURATION_BLOB_HEADER) ||
+        header->SettingsSize != sizeof(TOUCH_SCREEN_SETTINGS) ||
+        header->PropertiesSize != TOUCH_CONFIGURATION_BLOB_PROPERTIES_SIZE)
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_REGISTRY,
+            "Ignoring configuration blob not matching this driver");
+
+        goto exit;
+    }
+
+    blob = ExAllocatePoolWithTag(PagedPool, TOUCH_CONFIGURATION_BLOB_SIZE, TOUCH_POOL_TAG);
+
+    if (blob == NULL)
+    {
+        goto exit;
+    }
+
+    RtlCopyMemory(blob, header, TOUCH_CONFIGURATION_BLOB_SIZE);
+
+exit:
+
+    if (info != NULL)
+    {
+        ExFreePoolWithTag(info, TOUCH_POOL_TAG);
+    }
+
+    if (key != NULL)
+    {
+        ZwClose(key);
+    }
+
+    return blob;
+}
+
+VOID
+TchFreeConfigurationBlob(
+    IN TOUCH_CONFIGURATION_BLOB_HEADER* ConfigurationBlob
+)
+/*++
+
+  Routine Description:
+
+    This routine releases a blob returned by TchLoadConfigurationBlob.
+
+  Arguments:
+
+    ConfigurationBlob - Blob to release
+
+  Return Value:
+
+    None
+
+--*/
+{
+    ExFreePoolWithTag(ConfigurationBlob, TOUCH_POOL_TAG);
+}
+
+ULONG
+TchBuildConfigurationBlob(
+    IN PTOUCH_SCREEN_SETTINGS TouchSettings,
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    OUT PVOID Buffer OPTIONAL,
+    IN ULONG BufferLength
+)
+/*++
+
+  Routine Description:
+
+    This routine lays out the given settings as a configuration blob, so
+    the effective configuration of a device can be stored as
+    TOUCH_CONFIGURATION_BLOB_VALUE.
+
+  Arguments:
+
+    TouchSettings - Controller settings to store
+    Props - Screen properties to store
+    Buffer - Optionally receives the blob
+    BufferLength - Size of Buffer, only the header is written if the
+        whole blob does not fit
+
+  Return Value:
+
+    Size of the blob
+
+--*/
+{
+    TOUCH_CONFIGURATION_BLOB_HEADER* header;
+
+    if (Buffer == NULL || BufferLength < sizeof(TOUCH_CONFIGURATION_BLOB_HEADER))
+    {
+        goto exit;
+    }
+
+    header = (TOUCH_CONFIGURATION_BLOB_HEADER*)Buffer;
+    header->Signature = TOUCH_CONFIGURATION_BLOB_SIGNATURE;
+    header->Version = TOUCH_CONFIGURATION_BLOB_VERSION;
+    header->HeaderSize = (USHORT)sizeof(TOUCH_CONFIGURATION_BLOB_HEADER);
+    header->SettingsSize = (ULONG)sizeof(TOUCH_SCREEN_SETTINGS);
+    header->PropertiesSize = TOUCH_CONFIGURATION_BLOB_PROPERTIES_SIZE;
+
+    if (BufferLength < TOUCH_CONFIGURATION_BLOB_SIZE)
+    {
+        goto exit;
+    }
+
+    RtlCopyMemory(
+        (PUCHAR)(header + 1),
+        TouchSettings,
+        sizeof(TOUCH_SCREEN_SETTINGS));
+
+    RtlCopyMemory(
+        (PUCHAR)(header + 1) + sizeof(TOUCH_SCREEN_SETTINGS),
+        Props,
+        TOUCH_CONFIGURATION_BLOB_PROPERTIES_SIZE);
+
+exit:
+    return TOUCH_CONFIGURATION_BLOB_SIZE;
+}
+
 VOID
 TchGetTouchSettings(
-    IN PTOUCH_SCREEN_SETTINGS TouchSettings
+    OUT PTOUCH_SCREEN_SETTINGS TouchSettings,
+    IN const TOUCH_CONFIGURATION_BLOB_HEADER* ConfigurationBlob OPTIONAL
 )
 {
     ULONG i;
@@ -1859,6 +2232,19 @@ TchGetTouchSettings(
 
     regTable = NULL;
 
+    //
+    // A configuration blob replaces the per-value queries below
+    //
+    if (ConfigurationBlob != NULL)
+    {
+        RtlCopyMemory(
+            TouchSettings,
+            (PUCHAR)(ConfigurationBlob + 1),
+            sizeof(TOUCH_SCREEN_SETTINGS));
+
+        return;
+    }
+
     wstrlcat(regKey, TOUCH_REG_KEY, sizeof(TOUCH_REG_KEY));
     regKey[sizeof(TOUCH_REG_KEY) / sizeof(WCHAR)] = L'\\';
     RtlCopyMemory((PCHAR)regKey + sizeof(TOUCH_REG_KEY) + sizeof(WCHAR), TOUCH_SCREEN_SETTINGS_SUB_KEY, sizeof(TOUCH_SCREEN_SETTINGS_SUB_KEY) - sizeof(WCHAR));
@@ -1924,4 +2310,324 @@ TchGetTouchSettings(
     {
         ExFreePoolWithTag(regTable, TOUCH_POOL_TAG);
     }
-}
\ No newline at end of file
+}
+
+static NTSTATUS
+TchQueryDwordValue(
+    IN HANDLE Key,
+    IN PCWSTR ValueName,
+    OUT UINT32* Value
+)
+/*++
+
+  Routine Description:
+
+    This routine reads a REG_DWORD value from an open key into a stack
+    buffer.
+
+  Arguments:
+
+    Key - Handle to the key holding the value
+    ValueName - Name of the value
+    Value - Receives the value
+
+  Return Value:
+
+    NTSTATUS indicating success or failure
+
+--*/
+{
+    ULONG buffer[(sizeof(KEY_VALUE_PARTIAL_INFORMATION) + sizeof(UINT32) + sizeof(ULONG) - 1) / sizeof(ULONG)];
+    PKEY_VALUE_PARTIAL_INFORMATION info;
+    UNICODE_STRING valueName;
+    ULONG resultLength;
+    NTSTATUS status;
+
+    info = (PKEY_VALUE_PARTIAL_INFORMATION)buffer;
+    RtlInitUnicodeString(&valueName, ValueName);
+
+    status = ZwQueryValueKey(
+        Key,
+        &valueName,
+        KeyValuePartialInformation,
+        info,
+        sizeof(buffer),
+        &resultLength);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    if (info->Type != REG_DWORD || info->DataLength != sizeof(UINT32))
+    {
+        status = STATUS_OBJECT_TYPE_MISMATCH;
+        goto exit;
+    }
+
+    RtlCopyMemory(Value, info->Data, sizeof(UINT32));
+
+exit:
+    return status;
+}
+
+static VOID
+TchLoadSettingsSnapshot(
+    IN HANDLE Key,
+    OUT TOUCH_SETTINGS_SNAPSHOT* Snapshot
+)
+{
+    RtlZeroMemory(Snapshot, sizeof(TOUCH_SETTINGS_SNAPSHOT));
+
+    if (Key == NULL)
+    {
+        return;
+    }
+
+    (VOID)TchQueryDwordValue(Key, L"Enabled", &Snapshot->WakeupGestureEnabled);
+}
+
+static NTSTATUS
+TchArmSettingsWatch(
+    IN TOUCH_SETTINGS_WATCH* Watch
+)
+{
+    //
+    // With a work item in place of the APC routine, the notification
+    // queues it to a system worker thread once a value is set
+    //
+    return ZwNotifyChangeKey(
+        Watch->Key,
+        NULL,
+        (PIO_APC_ROUTINE)(ULONG_PTR)&Watch->WorkItem,
+        (PVOID)(ULONG_PTR)DelayedWorkQueue,
+        &Watch->IoStatus,
+        REG_NOTIFY_CHANGE_LAST_SET,
+        FALSE,
+        NULL,
+        0,
+        TRUE);
+}
+
+static WORKER_THREAD_ROUTINE TchSettingsWatchWorkItem;
+
+static VOID
+TchSettingsWatchWorkItem(
+    IN PVOID Parameter
+)
+/*++
+
+  Routine Description:
+
+    Runs on a system worker thread when the watched key changed, or when
+    the watch was torn down. The snapshot is reloaded into the buffer
+    readers are not using and published, then the watch is armed again.
+
+  Arguments:
+
+    Parameter - The settings watch
+
+  Return Value:
+
+    None
+
+--*/
+{
+    TOUCH_SETTINGS_WATCH* watch;
+    LONG next;
+    NTSTATUS status;
+
+    watch = (TOUCH_SETTINGS_WATCH*)Parameter;
+
+    if (!NT_SUCCESS(watch->IoStatus.Status) ||
+        watch->IoStatus.Status == STATUS_NOTIFY_CLEANUP)
+    {
+        KeSetEvent(&watch->Stopped, IO_NO_INCREMENT, FALSE);
+        return;
+    }
+
+    WdfWaitLockAcquire(watch->Lock, NULL);
+
+    if (watch->Stopping != 0)
+    {
+        WdfWaitLockRelease(watch->Lock);
+        KeSetEvent(&watch->Stopped, IO_NO_INCREMENT, FALSE);
+        return;
+    }
+
+    next = (ReadNoFence(&watch->Current) + 1) & 1;
+    TchLoadSettingsSnapshot(watch->Key, &watch->Snapshots[next]);
+    InterlockedExchange(&watch->Current, next);
+
+    Trace(
+        TRACE_LEVEL_INFORMATION,
+        TRACE_REGISTRY,
+        "Settings changed, wake gesture enabled %lu",
+        watch->Snapshots[next].WakeupGestureEnabled);
+
+    status = TchArmSettingsWatch(watch);
+
+    WdfWaitLockRelease(watch->Lock);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_REGISTRY,
+            "Error rearming settings change notification - 0x%08lX",
+            status);
+
+        KeSetEvent(&watch->Stopped, IO_NO_INCREMENT, FALSE);
+    }
+}
+
+NTSTATUS
+TchStartSettingsWatch(
+    IN PDEVICE_EXTENSION DeviceContext
+)
+/*++
+
+  Routine Description:
+
+    This routine loads the settings snapshot read by callbacks and keeps
+    it current with a change notification on its key. A missing key leaves
+    every setting at zero, as reading it on demand did.
+
+  Arguments:
+
+    DeviceContext - Device context
+
+  Return Value:
+
+    NTSTATUS indicating success or failure
+
+--*/
+{
+    TOUCH_SETTINGS_WATCH* watch;
+    WDF_OBJECT_ATTRIBUTES attributes;
+    UNICODE_STRING keyName;
+    OBJECT_ATTRIBUTES keyAttributes;
+    NTSTATUS status;
+
+    watch = &DeviceContext->SettingsWatch;
+
+    if (watch->Lock == NULL)
+    {
+        WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+        attributes.ParentObject = DeviceContext->FxDevice;
+
+        status = WdfWaitLockCreate(&attributes, &watch->Lock);
+
+        if (!NT_SUCCESS(status))
+        {
+            Trace(
+                TRACE_LEVEL_ERROR,
+                TRACE_REGISTRY,
+                "Error creating settings watch lock - 0x%08lX",
+                status);
+
+            goto exit;
+        }
+    }
+
+    watch->Key = NULL;
+    watch->Stopping = 0;
+    watch->Current = 0;
+    KeInitializeEvent(&watch->Stopped, NotificationEvent, FALSE);
+    ExInitializeWorkItem(&watch->WorkItem, TchSettingsWatchWorkItem, watch);
+
+    RtlInitUnicodeString(&keyName, TOUCH_WAKEUP_GESTURE_KEY);
+
+    InitializeObjectAttributes(
+        &keyAttributes,
+        &keyName,
+        OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE,
+        NULL,
+        NULL);
+
+    status = ZwOpenKey(
+        &watch->Key,
+        KEY_QUERY_VALUE | KEY_NOTIFY,
+        &keyAttributes);
+
+    if (!NT_SUCCESS(status))
+    {
+        watch->Key = NULL;
+    }
+
+    TchLoadSettingsSnapshot(watch->Key, &watch->Snapshots[0]);
+
+    status = STATUS_SUCCESS;
+
+    if (watch->Key == NULL)
+    {
+        KeSetEvent(&watch->Stopped, IO_NO_INCREMENT, FALSE);
+        goto exit;
+    }
+
+    status = TchArmSettingsWatch(watch);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_REGISTRY,
+            "Error arming settings change notification - 0x%08lX",
+            status);
+
+        ZwClose(watch->Key);
+        watch->Key = NULL;
+        KeSetEvent(&watch->Stopped, IO_NO_INCREMENT, FALSE);
+    }
+
+    status = STATUS_SUCCESS;
+
+exit:
+    return status;
+}
+
+VOID
+TchStopSettingsWatch(
+    IN PDEVICE_EXTENSION DeviceContext
+)
+/*++
+
+  Routine Description:
+
+    This routine stops refreshing the settings snapshot. Closing the key
+    completes the pending notification, whose work item is waited for.
+    The last snapshot stays readable.
+
+  Arguments:
+
+    DeviceContext - Device context
+
+  Return Value:
+
+    None
+
+--*/
+{
+    TOUCH_SETTINGS_WATCH* watch;
+
+    watch = &DeviceContext->SettingsWatch;
+
+    if (watch->Lock == NULL)
+    {
+        return;
+    }
+
+    WdfWaitLockAcquire(watch->Lock, NULL);
+
+    InterlockedExchange(&watch->Stopping, 1);
+
+    if (watch->Key != NULL)
+    {
+        ZwClose(watch->Key);
+        watch->Key = NULL;
+    }
+
+    WdfWaitLockRelease(watch->Lock);
+
+    KeWaitForSingleObject(&watch->Stopped, Executive, KernelMode, FALSE, NULL);
+}
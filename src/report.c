@@ -25,13 +25,12 @@
 #include <hid.h>
 #include <HidCommon.h>
 #include <spb.h>
+#include <Cross Platform Shim\bitops.h>
+#include <Cross Platform Shim\hweight.h>
 #include <report.h>
+#include <tracelog.h>
 #include <report.tmh>
 
-WDFTIMER  timerHandle;
-PREPORT_CONTEXT cachedReportContext = NULL;
-DETECTED_OBJECTS objectData;
-
 NTSTATUS
 ReportWakeup(
 	IN PREPORT_CONTEXT ReportContext
@@ -48,7 +47,11 @@ ReportWakeup(
 	HidReport.KeyReport.ACSearch = ReportContext->ButtonCache.ButtonSlots[2];
 	HidReport.KeyReport.SystemPowerDown = 1;
 
-	status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
+	status = TchSendReport(
+		ReportContext->PingPongQueue,
+		&ReportContext->ReportRing,
+		&HidReport,
+		FALSE);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -69,7 +72,11 @@ ReportWakeup(
 	HidReport.KeyReport.ACSearch = ReportContext->ButtonCache.ButtonSlots[2];
 	HidReport.KeyReport.SystemPowerDown = 0;
 
-	status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
+	status = TchSendReport(
+		ReportContext->PingPongQueue,
+		&ReportContext->ReportRing,
+		&HidReport,
+		FALSE);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -109,7 +116,11 @@ ReportKeypad(
 	ReportContext->ButtonCache.ButtonSlots[2] = Search;
 	HidReport.KeyReport.SystemPowerDown = 0;
 
-	status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
+	status = TchSendReport(
+		ReportContext->PingPongQueue,
+		&ReportContext->ReportRing,
+		&HidReport,
+		FALSE);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -145,17 +156,10 @@ ReportPen(
 	HID_INPUT_REPORT HidReport;
 	RtlZeroMemory(&HidReport, sizeof(HID_INPUT_REPORT));
 
-	USHORT ScratchX = (USHORT)X;
-	USHORT ScratchY = (USHORT)Y;
-
 	//
-	// Perform per-platform x/y adjustments to controller coordinates
+	// X and Y are display coordinates, translated once per frame by the
+	// caller
 	//
-	TchTranslateToDisplayCoordinates(
-		&ScratchX,
-		&ScratchY,
-		&ReportContext->Props);
-
 	HidReport.ReportID = REPORTID_STYLUS;
 
 	HidReport.PenReport.InRange = InRange;
@@ -164,14 +168,18 @@ ReportPen(
 	HidReport.PenReport.Invert = Invert;
 	HidReport.PenReport.BarrelSwitch = BarrelSwitch;
 
-	HidReport.PenReport.X = ScratchX;
-	HidReport.PenReport.Y = ScratchY;
+	HidReport.PenReport.X = X;
+	HidReport.PenReport.Y = Y;
 	HidReport.PenReport.TipPressure = TipPressure;
 
 	HidReport.PenReport.XTilt = XTilt;
 	HidReport.PenReport.YTilt = YTilt;
 
-	status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
+	status = TchSendReport(
+		ReportContext->PingPongQueue,
+		&ReportContext->ReportRing,
+		&HidReport,
+		FALSE);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -188,9 +196,165 @@ exit:
 	return status;
 }
 
+static
+VOID
+ReportLinkDownSlot(
+	IN OBJECT_CACHE* Cache,
+	IN ULONG Slot
+)
+{
+	Cache->DownNext[Slot] = 0;
+	Cache->DownPrev[Slot] = Cache->DownTail;
+
+	if (Cache->DownTail != 0)
+	{
+		Cache->DownNext[Cache->DownTail - 1] = (UCHAR)(Slot + 1);
+	}
+	else
+	{
+		Cache->DownHead = (UCHAR)(Slot + 1);
+	}
+
+	Cache->DownTail = (UCHAR)(Slot + 1);
+	Cache->DownCount++;
+}
+
+static
+VOID
+ReportUnlinkDownSlot(
+	IN OBJECT_CACHE* Cache,
+	IN ULONG Slot
+)
+{
+	UCHAR next = Cache->DownNext[Slot];
+	UCHAR prev = Cache->DownPrev[Slot];
+
+	NT_ASSERT(Cache->DownCount > 0);
+
+	if (prev != 0)
+	{
+		Cache->DownNext[prev - 1] = next;
+	}
+	else
+	{
+		Cache->DownHead = next;
+	}
+
+	if (next != 0)
+	{
+		Cache->DownPrev[next - 1] = prev;
+	}
+	else
+	{
+		Cache->DownTail = prev;
+	}
+
+	Cache->DownCount--;
+}
+
+VOID
+ReportRecordLatency(
+	IN PREPORT_CONTEXT ReportContext,
+	IN ULONG Stage,
+	IN ULONG64 InterruptTime
+)
+/*++
+
+Routine Description:
+
+	Adds the time elapsed since ISR entry to the histogram of a pipeline
+	stage. Frames that no interrupt raised carry no timestamp and are not
+	counted.
+
+Arguments:
+
+	ReportContext - Report context
+	Stage - One of the REPORT_LATENCY_STAGE_* values
+	InterruptTime - Interrupt time of ISR entry, in 100ns units
+
+Return Value:
+
+	None
+
+--*/
+{
+	REPORT_LATENCY_STATS* Latency = &ReportContext->Latency;
+	ULONG64 QpcTimeStamp;
+	ULONG64 now;
+	ULONG elapsed;
+	ULONG bucket;
+	ULONG index;
+
+	if (InterruptTime == 0 || Stage >= REPORT_LATENCY_STAGES)
+	{
+		return;
+	}
+
+	now = KeQueryInterruptTimePrecise(&QpcTimeStamp);
+	elapsed = (now > InterruptTime) ?
+		(ULONG)min((now - InterruptTime) / 10, (ULONG64)MAXULONG) : 0;
+
+	bucket = 0;
+
+	if (BitScanReverse(&index, elapsed))
+	{
+		bucket = min(index + 1, REPORT_LATENCY_BUCKETS - 1);
+	}
+
+	InterlockedIncrement(&Latency->Buckets[Stage][bucket]);
+	InterlockedAdd64(&Latency->TotalMicroseconds[Stage], elapsed);
+}
+
+VOID
+ReportRecordFailedRead(
+	IN PREPORT_CONTEXT ReportContext
+)
+{
+	InterlockedIncrement(&ReportContext->Latency.FailedReads);
+}
+
+VOID
+ReportResetObjectCache(
+	IN PREPORT_CONTEXT ReportContext
+)
+/*++
+
+Routine Description:
+
+	Forgets every tracked contact, for instance when the controller is
+	powered down.
+
+Arguments:
+
+	ReportContext - Report context
+
+Return Value:
+
+	None.
+
+--*/
+{
+	//
+	// The continuous reporting timer replays frames through the cache;
+	// with nothing left to repeat it stops on its next expiry
+	//
+	if (ReportContext->ContinuousLock != NULL)
+	{
+		WdfSpinLockAcquire(ReportContext->ContinuousLock);
+	}
+
+	RtlZeroMemory(&ReportContext->Cache, sizeof(OBJECT_CACHE));
+	ReportContext->ContinuousActive = FALSE;
+
+	if (ReportContext->ContinuousLock != NULL)
+	{
+		WdfSpinLockRelease(ReportContext->ContinuousLock);
+	}
+}
+
 VOID
 ReportUpdateLocalObjectCache(
-	IN DETECTED_OBJECTS* Data,
+	IN PTOUCH_FRAME Frame,
 	IN OBJECT_CACHE* Cache
 )
 /*++
@@ -201,11 +365,13 @@ Routine Description:
 	parses it to update a local cache of finger states. This routine manages
 	removing lifted touches from the cache, and manages a map between the
 	order of reported touches in hardware, and the order the driver should
-	use in reporting.
+	use in reporting. Only the contacts of the frame and the slots set in
+	the valid and dirty masks are visited, so the cost scales with the
+	number of contacts.
 
 Arguments:
 
-	Data - A pointer to the new data returned from hardware
+	Frame - A pointer to the new frame returned from hardware
 	Cache - A data structure holding various current finger state info
 
 Return Value:
@@ -214,112 +380,496 @@ Return Value:
 
 --*/
 {
-	int i, j;
+	TOUCH_FRAME_CONTACT* contact;
+	unsigned long bits;
+	unsigned long i;
+	UCHAR link;
+	int j;
 
 	//
 	// When hardware was last read, if any slots reported as lifted, we
 	// must clean out the slot and old touch info. There may be new
 	// finger data using the slot.
 	//
-	for (i = 0; i < MAX_TOUCHES; i++)
+	bits = Cache->SlotDirty;
+
+	for (i = find_first_bit(&bits, MAX_TOUCHES);
+		i < MAX_TOUCHES;
+		i = find_next_bit(&bits, MAX_TOUCHES, i + 1))
 	{
-		//
-		// Sweep for a slot that needs to be cleaned
-		//
-		if (!(Cache->SlotDirty & (1 << i)))
-		{
-			continue;
-		}
+		ReportUnlinkDownSlot(Cache, i);
+	}
 
-		NT_ASSERT(Cache->DownCount > 0);
+	Cache->SlotDirty = 0;
 
-		//
-		// Find the slot in the reporting list 
-		//
-		for (j = 0; j < MAX_TOUCHES; j++)
-		{
-			if (Cache->DownOrder[j] == i)
-			{
-				break;
-			}
-		}
+	//
+	// Take actions when a new contact is first reported as down
+	//
+	bits = Frame->Present & ~Cache->SlotValid;
 
-		NT_ASSERT(j != MAX_TOUCHES);
+	for (i = find_first_bit(&bits, MAX_TOUCHES);
+		i < MAX_TOUCHES;
+		i = find_next_bit(&bits, MAX_TOUCHES, i + 1))
+	{
+		Cache->SlotValid |= (1u << i);
+		ReportLinkDownSlot(Cache, i);
+	}
 
-		//
-		// Remove the slot. If the finger lifted was the last in the list,
-		// we just decrement the list total by one. If it was not last, we
-		// shift the trailing list items up by one.
-		//
-		for (; (j < Cache->DownCount - 1) && (j < MAX_TOUCHES - 1); j++)
-		{
-			Cache->DownOrder[j] = Cache->DownOrder[j + 1];
-		}
-		Cache->DownCount--;
+	Cache->SlotNew = bits;
 
-		//
-		// Finished, clobber the dirty bit
-		//
-		Cache->SlotDirty &= ~(1 << i);
+	//
+	// Cache the new set of finger data reported by hardware
+	//
+	for (i = 0; i < Frame->ContactCount; i++)
+	{
+		contact = &Frame->Contacts[i];
+
+		Cache->Slot[contact->TouchId].status = contact->State;
+		Cache->Slot[contact->TouchId].x = contact->X;
+		Cache->Slot[contact->TouchId].y = contact->Y;
 	}
 
 	//
-	// Cache the new set of finger data reported by hardware
+	// If a finger lifted, note the slot is now inactive so that any
+	// cached data is cleaned out before we read hardware again. The last
+	// cached position is kept for the lift report.
 	//
-	for (i = 0; i < MAX_TOUCHES; i++)
+	bits = Cache->SlotValid & ~Frame->Present;
+
+	for (i = find_first_bit(&bits, MAX_TOUCHES);
+		i < MAX_TOUCHES;
+		i = find_next_bit(&bits, MAX_TOUCHES, i + 1))
 	{
-		//
-		// Take actions when a new contact is first reported as down
-		//
-		if ((Data->States[i] != OBJECT_STATE_NOT_PRESENT) &&
-			((Cache->SlotValid & (1 << i)) == 0) &&
-			(Cache->DownCount < MAX_TOUCHES))
+		Cache->Slot[i].status = OBJECT_STATE_NOT_PRESENT;
+	}
+
+	Cache->SlotDirty = bits;
+	Cache->SlotValid &= ~bits;
+
+	NT_ASSERT((unsigned int)Cache->DownCount ==
+		hweight32(Cache->SlotValid | Cache->SlotDirty));
+
+	//
+	// Flatten the reporting order for this frame
+	//
+	j = 0;
+
+	for (link = Cache->DownHead; link != 0; link = Cache->DownNext[link - 1])
+	{
+		Cache->DownOrder[j++] = (UCHAR)(link - 1);
+	}
+
+	//
+	// Scan time (in 100us units) of the interrupt that raised the frame,
+	// so that bus latency does not leak into the frame intervals
+	//
+	if (Frame->Timestamp != 0)
+	{
+		Cache->ScanTime = Frame->Timestamp / 1000;
+	}
+	else
+	{
+		ULONG64 QpcTimeStamp;
+		Cache->ScanTime = KeQueryInterruptTimePrecise(&QpcTimeStamp) / 1000;
+	}
+}
+
+static
+VOID
+ReportTranslateDownObjects(
+	IN PREPORT_CONTEXT ReportContext
+)
+/*++
+
+Routine Description:
+
+	Translates every contact of the frame to display coordinates with a
+	single batch call and caches the result in the contact's slot.
+
+Arguments:
+
+	ReportContext - Report context
+
+Return Value:
+
+	None
+
+--*/
+{
+	OBJECT_CACHE* Cache = &ReportContext->Cache;
+	USHORT X[MAX_TOUCHES];
+	USHORT Y[MAX_TOUCHES];
+	int i;
+
+	for (i = 0; i < Cache->DownCount; i++)
+	{
+		OBJECT_INFO* info = &Cache->Slot[Cache->DownOrder[i]];
+
+		X[i] = info->x;
+		Y[i] = info->y;
+	}
+
+	TchTranslateToDisplayCoordinatesBatch(
+		&ReportContext->Props,
+		(ULONG)Cache->DownCount,
+		X,
+		Y);
+
+	for (i = 0; i < Cache->DownCount; i++)
+	{
+		OBJECT_INFO* info = &Cache->Slot[Cache->DownOrder[i]];
+
+		info->DisplayX = X[i];
+		info->DisplayY = Y[i];
+	}
+}
+
+//
+// 2 pi in Q16, and the bounds (100ns units) of the frame interval the
+// contact filter steps with, so that a stalled or doubled frame does not
+// throw the filter off
+//
+#define REPORT_FILTER_TWO_PI            411775ULL
+#define REPORT_FILTER_MIN_INTERVAL      10000ULL
+#define REPORT_FILTER_MAX_INTERVAL      1000000ULL
+
+static FORCEINLINE
+LONG64
+ReportFilterAlpha(
+	IN ULONG64 Cutoff,
+	IN ULONG64 Interval
+)
+/*++
+
+Routine Description:
+
+	Returns the smoothing factor, Q16, of a low-pass filter with a cutoff
+	of Cutoff mHz stepped every Interval 100ns units.
+
+--*/
+{
+	ULONG64 x;
+
+	x = REPORT_FILTER_TWO_PI * Cutoff * Interval / 10000000000ULL;
+
+	return (LONG64)((x << 16) / (x + 65536));
+}
+
+static
+VOID
+ReportFilterDownObjects(
+	IN PREPORT_CONTEXT ReportContext,
+	IN ULONG64 Timestamp
+)
+/*++
+
+Routine Description:
+
+	Runs the contact filter over the display coordinates of every contact
+	of the frame: a 1 euro low-pass whose cutoff rises with the contact's
+	speed, then the filtered velocity extrapolated over the prediction
+	horizon. Contacts new in the frame start the filter at their position.
+
+Arguments:
+
+	ReportContext - Report context
+	Timestamp - Interrupt time of the frame, 0 if it has none
+
+Return Value:
+
+	None
+
+--*/
+{
+	OBJECT_CACHE* Cache = &ReportContext->Cache;
+	PTOUCH_CONTACT_FILTER Filter = &ReportContext->Props.Filter;
+	ULONG64 QpcTimeStamp;
+	ULONG64 now;
+	ULONG64 interval;
+	LONG64 rate;
+	LONG64 dalpha;
+	LONG64 maxX;
+	LONG64 maxY;
+	int i;
+
+	if (!Filter->Enabled)
+	{
+		return;
+	}
+
+	//
+	// Frames repeated by continuous reporting carry no timestamp, they
+	// step the filter at the time they go out
+	//
+	now = (Timestamp != 0) ? Timestamp : KeQueryInterruptTimePrecise(&QpcTimeStamp);
+	interval = (now > Cache->FilterTime) ? now - Cache->FilterTime : 0;
+	interval = min(max(interval, REPORT_FILTER_MIN_INTERVAL), REPORT_FILTER_MAX_INTERVAL);
+	Cache->FilterTime = now;
+
+	rate = (LONG64)((10000000ULL << 16) / interval);
+	dalpha = ReportFilterAlpha(Filter->DerivativeCutoff, interval);
+	maxX = (LONG64)ReportContext->Props.DisplayPhysicalWidth;
+	maxY = (LONG64)ReportContext->Props.DisplayPhysicalHeight;
+
+	for (i = 0; i < Cache->DownCount; i++)
+	{
+		UCHAR slot = Cache->DownOrder[i];
+		OBJECT_INFO* info = &Cache->Slot[slot];
+		OBJECT_FILTER* state = &Cache->Filter[slot];
+		LONG64 rawX = (LONG64)info->DisplayX << 8;
+		LONG64 rawY = (LONG64)info->DisplayY << 8;
+		LONG64 speed;
+		LONG64 alpha;
+		LONG64 x;
+		LONG64 y;
+
+		if (info->status == OBJECT_STATE_NOT_PRESENT)
 		{
-			Cache->SlotValid |= (1 << i);
-			Cache->DownOrder[Cache->DownCount++] = i;
+			continue;
 		}
 
-		//
-		// Ignore slots with no new information
-		//
-		if (!(Cache->SlotValid & (1 << i)))
+		if (Cache->SlotNew & (1UL << slot))
 		{
+			state->X = (LONG)rawX;
+			state->Y = (LONG)rawY;
+			state->DX = 0;
+			state->DY = 0;
 			continue;
 		}
 
 		//
-		// When finger is down, update local cache with new information from
-		// the controller. When finger is up, we'll use last cached value
+		// Velocity against the last filtered position, low-passed at the
+		// derivative cutoff, sets how much the position is smoothed
 		//
-		Cache->Slot[i].status = (UCHAR)Data->States[i];
-		if (Cache->Slot[i].status)
+		state->DX += (LONG)(((((rawX - state->X) * rate) >> 16) - state->DX) * dalpha >> 16);
+		state->DY += (LONG)(((((rawY - state->Y) * rate) >> 16) - state->DY) * dalpha >> 16);
+
+		speed = ((LONG64)abs(state->DX) + (LONG64)abs(state->DY)) >> 8;
+		alpha = ReportFilterAlpha(
+			min(Filter->MinCutoff + (ULONG64)Filter->Beta * (ULONG64)speed,
+				(ULONG64)TOUCH_FILTER_MAX_CUTOFF),
+			interval);
+
+		state->X += (LONG)(((rawX - state->X) * alpha) >> 16);
+		state->Y += (LONG)(((rawY - state->Y) * alpha) >> 16);
+
+		x = (state->X + (((LONG64)state->DX * Filter->Prediction) >> 16) + 128) >> 8;
+		y = (state->Y + (((LONG64)state->DY * Filter->Prediction) >> 16) + 128) >> 8;
+
+		info->DisplayX = (USHORT)min(max(x, 0), maxX);
+		info->DisplayY = (USHORT)min(max(y, 0), maxY);
+	}
+}
+
+static FORCEINLINE
+ULONG
+ReportAxisDelta(
+	IN USHORT A,
+	IN USHORT B
+)
+{
+	return (A > B) ? (ULONG)(A - B) : (ULONG)(B - A);
+}
+
+static
+BOOLEAN
+ReportIsFrameStationary(
+	IN PREPORT_CONTEXT ReportContext
+)
+/*++
+
+Routine Description:
+
+	Decides whether the translated frame only repeats what was last sent
+	to HIDClass. Contacts going down or up always make the frame go out,
+	as does the keepalive interval expiring.
+
+Arguments:
+
+	ReportContext - Report context
+
+Return Value:
+
+	TRUE if the frame does not need to be reported
+
+--*/
+{
+	OBJECT_CACHE* Cache = &ReportContext->Cache;
+	ULONG threshold = ReportContext->StationaryThreshold;
+	int i;
+
+	if (threshold == 0 ||
+		Cache->SlotNew != 0 ||
+		Cache->SlotDirty != 0)
+	{
+		return FALSE;
+	}
+
+	if ((LONG64)KeQueryInterruptTime() - Cache->LastReportTime >= ReportContext->StationaryKeepalive)
+	{
+		return FALSE;
+	}
+
+	for (i = 0; i < Cache->DownCount; i++)
+	{
+		OBJECT_INFO* info = &Cache->Slot[Cache->DownOrder[i]];
+
+		if (info->status != info->ReportedStatus ||
+			ReportAxisDelta(info->DisplayX, info->ReportedX) >= threshold ||
+			ReportAxisDelta(info->DisplayY, info->ReportedY) >= threshold)
 		{
-			Cache->Slot[i].x = Data->Positions[i].X;
-			Cache->Slot[i].y = Data->Positions[i].Y;
+			return FALSE;
 		}
+	}
 
-		//
-		// If a finger lifted, note the slot is now inactive so that any
-		// cached data is cleaned out before we read hardware again.
-		//
-		if (Cache->Slot[i].status == OBJECT_STATE_NOT_PRESENT)
+	return TRUE;
+}
+
+static
+VOID
+ReportMarkFrameReported(
+	IN PREPORT_CONTEXT ReportContext
+)
+{
+	OBJECT_CACHE* Cache = &ReportContext->Cache;
+	int i;
+
+	for (i = 0; i < Cache->DownCount; i++)
+	{
+		OBJECT_INFO* info = &Cache->Slot[Cache->DownOrder[i]];
+
+		info->ReportedX = info->DisplayX;
+		info->ReportedY = info->DisplayY;
+		info->ReportedStatus = info->status;
+	}
+
+	Cache->LastReportTime = (LONG64)KeQueryInterruptTime();
+}
+
+static FORCEINLINE
+BOOLEAN
+ReportIsPenState(
+	IN UCHAR State
+)
+{
+	return State == OBJECT_STATE_PEN_PRESENT_WITH_TIP ||
+		State == OBJECT_STATE_PEN_PRESENT_WITH_ERASER;
+}
+
+static
+NTSTATUS
+ReportPenObjects(
+	IN PREPORT_CONTEXT ReportContext,
+	OUT UCHAR* Fingers,
+	OUT int* FingerCount
+)
+/*++
+
+Routine Description:
+
+	Splits the contacts of the translated frame into the pen and the
+	fingers. The first pen contact goes out as the only stylus report of
+	the frame, from the position translated for the frame, and a single
+	out-of-range report follows once no pen is left. Pen contacts, as
+	well as a contact last reported as a pen that just lifted, are kept
+	out of the finger reports.
+
+Arguments:
+
+	ReportContext - Report context
+	Fingers - Receives the slots of the finger contacts in reporting order
+	FingerCount - Receives the number of finger contacts
+
+Return Value:
+
+	NTSTATUS indicating whether the stylus report could be sent
+
+--*/
+{
+	OBJECT_CACHE* Cache = &ReportContext->Cache;
+	OBJECT_INFO* pen = NULL;
+	NTSTATUS status = STATUS_SUCCESS;
+	BOOLEAN eraser;
+	int count = 0;
+	int i;
+
+	for (i = 0; i < Cache->DownCount; i++)
+	{
+		OBJECT_INFO* info = &Cache->Slot[Cache->DownOrder[i]];
+
+		if (ReportIsPenState(info->status))
+		{
+			if (pen == NULL)
+			{
+				pen = info;
+			}
+
+			continue;
+		}
+
+		if (info->status == OBJECT_STATE_NOT_PRESENT &&
+			ReportIsPenState(info->ReportedStatus))
 		{
-			Cache->SlotDirty |= (1 << i);
-			Cache->SlotValid &= ~(1 << i);
+			continue;
 		}
+
+		Fingers[count++] = Cache->DownOrder[i];
 	}
 
-	//
-	// Get current scan time (in 100us units)
-	//
-	ULONG64 QpcTimeStamp;
-	Cache->ScanTime = KeQueryInterruptTimePrecise(&QpcTimeStamp) / 1000;
+	*FingerCount = count;
+
+	if (pen != NULL)
+	{
+		eraser = (pen->status == OBJECT_STATE_PEN_PRESENT_WITH_ERASER);
+		ReportContext->PenPresent = TRUE;
+
+		status = ReportPen(
+			ReportContext,
+			TRUE,
+			FALSE,
+			eraser,
+			eraser,
+			TRUE,
+			pen->DisplayX,
+			pen->DisplayY,
+			1,
+			0,
+			0);
+	}
+	else if (ReportContext->PenPresent)
+	{
+		ReportContext->PenPresent = FALSE;
+
+		status = ReportPen(
+			ReportContext,
+			FALSE,
+			FALSE,
+			FALSE,
+			FALSE,
+			FALSE,
+			0,
+			0,
+			0,
+			0,
+			0);
+	}
+
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_REPORTING,
+			"Error sending hid report for passive pen - 0x%08lX",
+			status);
+	}
+
+	return status;
 }
 
 NTSTATUS
 ReportObjectsInternal(
 	IN PREPORT_CONTEXT ReportContext,
-	IN DETECTED_OBJECTS data
+	IN PTOUCH_FRAME Frame
 )
 /*++
 
@@ -346,20 +896,37 @@ Return Value:
 --*/
 {
 	NTSTATUS status = STATUS_SUCCESS;
-	HID_INPUT_REPORT HidReport;
+	PHID_INPUT_REPORT HidReport;
+	UCHAR Fingers[MAX_TOUCHES];
+	int FingerCount = 0;
 	int TouchesReported = 0;
 	int currentFingerIndex;
 	int fingersToReport = 0;
-	USHORT SctatchX = 0, ScratchY = 0;
-	BOOLEAN HasPen = FALSE;
+	ULONG ReportCount = 0;
+	BOOLEAN HasLiftUp = FALSE;
+	PHID_TOUCH_FINGER Contacts;
+	PUSHORT ScanTime;
+	PUCHAR ContactCount;
+	int contactsPerReport;
+
+	//
+	// Hybrid mode fits 2 contacts per report, parallel mode carries every
+	// contact of the frame in a single report
+	//
+	contactsPerReport = ReportContext->ParallelMode ? PTP_MAX_CONTACT_POINTS : 2;
 
 	//
 	// Process the new touch data by updating our cached state
 	//
 	ReportUpdateLocalObjectCache(
-		&data,
+		Frame,
 		&ReportContext->Cache);
 
+	ReportRecordLatency(
+		ReportContext,
+		REPORT_LATENCY_STAGE_CACHE_UPDATE,
+		Frame->Timestamp);
+
 	//
 	// If no touches are present return that no data needed to be reported
 	//
@@ -369,23 +936,74 @@ Return Value:
 		goto exit;
 	}
 
-	while (TouchesReported != ReportContext->Cache.DownCount)
+	//
+	// Perform per-platform x/y adjustments to controller coordinates,
+	// once for the whole frame
+	//
+	ReportTranslateDownObjects(ReportContext);
+
+	//
+	// Smooth and extrapolate the translated positions if configured
+	//
+	ReportFilterDownObjects(ReportContext, Frame->Timestamp);
+
+	//
+	// Leave out frames that only repeat what HIDClass already has
+	//
+	if (ReportIsFrameStationary(ReportContext))
 	{
+		InterlockedIncrement(&ReportContext->StationaryFramesSuppressed);
+		goto exit;
+	}
+
+	//
+	// The pen goes out in a stylus report of its own, ahead of the
+	// fingers
+	//
+	status = ReportPenObjects(ReportContext, Fingers, &FingerCount);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	//
+	// Build every finger report of the frame, they are handed to HIDClass
+	// together once complete
+	//
+	while (TouchesReported != FingerCount)
+	{
+		HidReport = &ReportContext->FrameReports[ReportCount++];
+
+		if (ReportContext->ParallelMode)
+		{
+			Contacts = HidReport->ParallelTouchReport.Contacts;
+			ScanTime = &HidReport->ParallelTouchReport.ScanTime;
+			ContactCount = &HidReport->ParallelTouchReport.ContactCount;
+		}
+		else
+		{
+			Contacts = HidReport->TouchReport.Contacts;
+			ScanTime = &HidReport->TouchReport.ScanTime;
+			ContactCount = &HidReport->TouchReport.ContactCount;
+		}
+
 		//
 		// Fill report with the next cached touches
 		//
-		RtlZeroMemory(&HidReport, sizeof(HID_INPUT_REPORT));
+		RtlZeroMemory(HidReport, sizeof(HID_INPUT_REPORT));
 
 		currentFingerIndex = 0;
 
-		fingersToReport = min(ReportContext->Cache.DownCount - TouchesReported, 2);
+		fingersToReport = min(FingerCount - TouchesReported, contactsPerReport);
 
-		HidReport.ReportID = REPORTID_FINGER;
+		HidReport->ReportID = REPORTID_FINGER;
 
 		//
-		// There are only 16-bits for ScanTime, truncate it
+		// There are only 16-bits for ScanTime, truncate it. HIDClass
+		// expects the value to wrap.
 		//
-		//HidReport->ScanTime = Cache->ScanTime & 0xFFFF;
+		*ScanTime = (USHORT)(ReportContext->Cache.ScanTime & 0xFFFF);
 
 		//
 		// Report the count
@@ -398,105 +1016,60 @@ Return Value:
 		//
 		if (TouchesReported == 0)
 		{
-			HidReport.TouchReport.ContactCount = (UCHAR)ReportContext->Cache.DownCount;
+			*ContactCount = (UCHAR)FingerCount;
 		}
 		else
 		{
-			HidReport.TouchReport.ContactCount = 0;
+			*ContactCount = 0;
 		}
 
-		HasPen = FALSE;
-
 		for (currentFingerIndex = 0; currentFingerIndex < fingersToReport; currentFingerIndex++)
 		{
-			int currentlyReporting = ReportContext->Cache.DownOrder[TouchesReported];
+			int currentlyReporting = Fingers[TouchesReported];
 
-			OBJECT_INFO info = ReportContext->Cache.Slot[currentlyReporting];
+			OBJECT_INFO* info = &ReportContext->Cache.Slot[currentlyReporting];
 
-			if (info.status == OBJECT_STATE_PEN_PRESENT_WITH_ERASER ||
-				info.status == OBJECT_STATE_PEN_PRESENT_WITH_TIP)
+			Contacts[currentFingerIndex].ContactID = (UCHAR)currentlyReporting;
+			Contacts[currentFingerIndex].Confidence = 1;
+
+			if (info->status == OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS)
 			{
-				HasPen = TRUE;
-				ReportContext->PenPresent = TRUE;
-
-				status = ReportPen(
-					ReportContext,
-					TRUE,
-					FALSE,
-					info.status == OBJECT_STATE_PEN_PRESENT_WITH_ERASER,
-					info.status == OBJECT_STATE_PEN_PRESENT_WITH_ERASER,
-					TRUE,
-					(USHORT)info.x,
-					(USHORT)info.y,
-					1,
-					0,
-					0);
-				if (!NT_SUCCESS(status))
-				{
-					Trace(
-						TRACE_LEVEL_ERROR,
-						TRACE_REPORTING,
-						"Error sending hid report for passive pen - 0x%08lX",
-						status);
-
-					goto exit;
-				}
+				Contacts[currentFingerIndex].X = info->DisplayX;
+				Contacts[currentFingerIndex].Y = info->DisplayY;
+				Contacts[currentFingerIndex].TipSwitch = FINGER_STATUS;
 			}
-
-			HidReport.TouchReport.Contacts[currentFingerIndex].ContactID = (UCHAR)currentlyReporting;
-			SctatchX = (USHORT)info.x;
-			ScratchY = (USHORT)info.y;
-			HidReport.TouchReport.Contacts[currentFingerIndex].Confidence = 1;
-
-			//
-			// Perform per-platform x/y adjustments to controller coordinates
-			//
-			TchTranslateToDisplayCoordinates(
-				&SctatchX,
-				&ScratchY,
-				&ReportContext->Props);
-
-			if (info.status == OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS)
+			else
 			{
-				HidReport.TouchReport.Contacts[currentFingerIndex].X = SctatchX;
-				HidReport.TouchReport.Contacts[currentFingerIndex].Y = ScratchY;
-				HidReport.TouchReport.Contacts[currentFingerIndex].TipSwitch = FINGER_STATUS;
+				HasLiftUp = TRUE;
 			}
 
 			TouchesReported++;
 		}
+	}
 
-		if (HasPen == FALSE && ReportContext->PenPresent == TRUE)
-		{
-			ReportContext->PenPresent = FALSE;
-
-			status = ReportPen(
-				ReportContext,
-				FALSE,
-				FALSE,
-				FALSE,
-				FALSE,
-				FALSE,
-				0,
-				0,
-				0,
-				0,
-				0);
-
-			if (!NT_SUCCESS(status))
-			{
-				Trace(
-					TRACE_LEVEL_ERROR,
-					TRACE_REPORTING,
-					"Error sending hid report for passive pen - 0x%08lX",
-					status);
+	if (ReportCount != 0)
+	{
+		//
+		// A frame without lift-ups only carries positions that the next
+		// frame supersedes, so it can be coalesced if HIDClass falls behind
+		//
+		status = TchSendReportFrame(
+			ReportContext->PingPongQueue,
+			&ReportContext->ReportRing,
+			ReportContext->FrameReports,
+			ReportCount,
+			HasLiftUp == FALSE);
 
-				goto exit;
-			}
+		//
+		// A coalesced frame was not reported, its positions go out with
+		// the next frame
+		//
+		if (status == STATUS_DEVICE_BUSY)
+		{
+			status = STATUS_SUCCESS;
+			goto exit;
 		}
 
-		status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
-
 		if (!NT_SUCCESS(status))
 		{
 			Trace(
@@ -509,83 +1082,192 @@ Return Value:
 		}
 	}
 
+	ReportMarkFrameReported(ReportContext);
+
+	ReportRecordLatency(
+		ReportContext,
+		REPORT_LATENCY_STAGE_REPORT_SENT,
+		Frame->Timestamp);
+
 exit:
 	return status;
 }
 
-NTSTATUS
-TchContinuousObjectInterruptServicingEvtTimerFunc(
+//
+// The continuous reporting timer only needs to find its report context
+//
+typedef struct _REPORT_TIMER_CONTEXT
+{
+	PREPORT_CONTEXT ReportContext;
+} REPORT_TIMER_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(REPORT_TIMER_CONTEXT, GetReportTimerContext)
+
+EVT_WDF_TIMER ReportContinuousTimerFunc;
+
+VOID
+ReportContinuousTimerFunc(
 	IN WDFTIMER Timer
 )
-{
-	NTSTATUS status = STATUS_SUCCESS;
+/*++
 
-	Trace(
-            TRACE_LEVEL_ERROR,
-		TRACE_REPORTING,
-		"TchContinuousObjectInterruptServicingEvtTimerFunc ENTRY");
+Routine Description:
 
-      if (cachedReportContext == NULL)
-      {
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_REPORTING,
-			"Error while reporting objects - cachedReportContext is NULL");
+	Repeats the last frame for panels that only interrupt when contacts
+	move. A repeat is skipped when a real frame was reported within the
+	last period, the timer is then rearmed to expire one period after
+	that frame. Repeating stops once no contact is down.
 
-            WdfTimerStop(Timer, FALSE);
-		goto exit;
-      }
+Arguments:
 
-	status = ReportObjectsInternal(
-		cachedReportContext,
-		objectData);
+	Timer - The continuous reporting timer
 
-	if (!NT_SUCCESS(status))
+Return Value:
+
+	None
+
+--*/
+{
+	PREPORT_CONTEXT ReportContext;
+	NTSTATUS status;
+	LONG64 elapsed;
+	LONG64 dueTime;
+	BOOLEAN rearm;
+
+	ReportContext = GetReportTimerContext(Timer)->ReportContext;
+	dueTime = ReportContext->ContinuousPeriod;
+
+	WdfSpinLockAcquire(ReportContext->ContinuousLock);
+
+	rearm = ReportContext->ContinuousActive;
+
+	if (rearm)
 	{
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_REPORTING,
-			"Error while reporting objects - 0x%08lX",
-			status);
+		elapsed = (LONG64)KeQueryInterruptTime() - ReportContext->ContinuousLastFrameTime;
 
-            WdfTimerStop(Timer, FALSE);
-            status = STATUS_SUCCESS;
-		goto exit;
+		if (elapsed < ReportContext->ContinuousPeriod)
+		{
+			dueTime = ReportContext->ContinuousPeriod - elapsed;
+
+			TchTraceContinuousRepeat(ReportContext->ContinuousFrame.ContactCount, FALSE);
+		}
+		else
+		{
+			TchTraceContinuousRepeat(ReportContext->ContinuousFrame.ContactCount, TRUE);
+
+			//
+			// No interrupt raised a repeat, it takes the current time as
+			// its scan time and stays out of the latency histograms
+			//
+			ReportContext->ContinuousFrame.Timestamp = 0;
+
+			status = ReportObjectsInternal(
+				ReportContext,
+				&ReportContext->ContinuousFrame);
+
+			if (!NT_SUCCESS(status))
+			{
+				Trace(
+					TRACE_LEVEL_VERBOSE,
+					TRACE_REPORTING,
+					"Stopped repeating objects - 0x%08lX",
+					status);
+
+				ReportContext->ContinuousActive = FALSE;
+				rearm = FALSE;
+			}
+		}
 	}
 
-exit:
-	Trace(
-            TRACE_LEVEL_ERROR,
-		TRACE_REPORTING,
-		"TchContinuousObjectInterruptServicingEvtTimerFunc EXIT - 0x%08lX",
-		status);
+	WdfSpinLockRelease(ReportContext->ContinuousLock);
 
-	return status;
+	if (rearm)
+	{
+		//
+		// Negative due times are relative, in 100ns units
+		//
+		WdfTimerStart(Timer, -dueTime);
+	}
 }
 
 NTSTATUS
 ReportConfigureContinuousSimulationTimer(
-	IN WDFDEVICE DeviceHandle
+	IN WDFDEVICE DeviceHandle,
+	IN PREPORT_CONTEXT ReportContext
 )
+/*++
+
+Routine Description:
+
+	Sets up continuous reporting for the device. The timer and its lock
+	are created once, the period is taken from the screen properties
+	every time the hardware is prepared.
+
+Arguments:
+
+	DeviceHandle - Framework device object
+	ReportContext - Report context of the device
+
+Return Value:
+
+	NTSTATUS indicating success or failure
+
+--*/
 {
 	NTSTATUS status = STATUS_SUCCESS;
+	WDF_TIMER_CONFIG timerConfig;
+	WDF_OBJECT_ATTRIBUTES attributes;
+	ULONG rate;
+
+	rate = ReportContext->Props.TouchContinuousReportRate;
+
+	if (rate == 0 || rate > TOUCH_MAX_CONTINUOUS_REPORT_RATE)
+	{
+		rate = TOUCH_DEFAULT_CONTINUOUS_REPORT_RATE;
+	}
 
-	WDF_TIMER_CONFIG  timerConfig;
-	WDF_OBJECT_ATTRIBUTES  timerAttributes;
+	ReportContext->ContinuousPeriod = 10000000LL / rate;
+
+	if (ReportContext->ContinuousTimer != NULL)
+	{
+		goto exit;
+	}
+
+	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+	attributes.ParentObject = DeviceHandle;
+
+	status = WdfSpinLockCreate(
+		&attributes,
+		&ReportContext->ContinuousLock);
+
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INIT,
+			"Error while creating the continuous reporting lock - 0x%08lX",
+			status);
+
+		goto exit;
+	}
 
+	//
+	// The timer is rearmed by hand so that its due time can follow the
+	// last real frame
+	//
 	WDF_TIMER_CONFIG_INIT(
-      	&timerConfig,
-      	TchContinuousObjectInterruptServicingEvtTimerFunc);
+		&timerConfig,
+		ReportContinuousTimerFunc);
 
-      timerConfig.Period = 50;
+	timerConfig.UseHighResolutionTimer = WdfTrue;
 
-      WDF_OBJECT_ATTRIBUTES_INIT(&timerAttributes);
-      timerAttributes.ParentObject = DeviceHandle;
+	WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&attributes, REPORT_TIMER_CONTEXT);
+	attributes.ParentObject = DeviceHandle;
 
 	status = WdfTimerCreate(
-      	&timerConfig,
-      	&timerAttributes,
-      	&timerHandle);
+		&timerConfig,
+		&attributes,
+		&ReportContext->ContinuousTimer);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -598,6 +1280,8 @@ ReportConfigureContinuousSimulationTimer(
 		goto exit;
 	}
 
+	GetReportTimerContext(ReportContext->ContinuousTimer)->ReportContext = ReportContext;
+
 exit:
 	return status;
 }
@@ -605,25 +1289,53 @@ exit:
 NTSTATUS
 ReportObjectsContinuous(
 	IN PREPORT_CONTEXT ReportContext,
-	IN DETECTED_OBJECTS data
+	IN PTOUCH_FRAME Frame
 )
-{
-      NTSTATUS status = STATUS_SUCCESS;
+/*++
+
+Routine Description:
 
-	Trace(
-            TRACE_LEVEL_ERROR,
-		TRACE_REPORTING,
-		"ReportObjectsContinuous ENTRY");
+	Reports a frame for panels that lack continuous reporting and keeps
+	it for the timer to repeat.
 
-      WdfTimerStop(timerHandle, TRUE);
+Arguments:
+
+	ReportContext - Report context
+	Frame - The frame read from hardware
+
+Return Value:
 
-      cachedReportContext = ReportContext;
+	NTSTATUS indicating whether the frame was reported
+
+--*/
+{
+	NTSTATUS status = STATUS_SUCCESS;
+	BOOLEAN start = FALSE;
 
-      RtlCopyMemory(&objectData, &data, sizeof(objectData));
+	WdfSpinLockAcquire(ReportContext->ContinuousLock);
+
+	//
+	// Keep the frame for the timer to replay, only the contacts it
+	// actually holds are copied
+	//
+	RtlCopyMemory(&ReportContext->ContinuousFrame, Frame, TOUCH_FRAME_SIZE(Frame));
+	ReportContext->ContinuousLastFrameTime = (LONG64)KeQueryInterruptTime();
 
 	status = ReportObjectsInternal(
 		ReportContext,
-		objectData);
+		&ReportContext->ContinuousFrame);
+
+	if (NT_SUCCESS(status))
+	{
+		start = !ReportContext->ContinuousActive;
+		ReportContext->ContinuousActive = TRUE;
+	}
+	else
+	{
+		ReportContext->ContinuousActive = FALSE;
+	}
+
+	WdfSpinLockRelease(ReportContext->ContinuousLock);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -636,34 +1348,34 @@ ReportObjectsContinuous(
 		goto exit;
 	}
 
-	WdfTimerStart(timerHandle, WDF_REL_TIMEOUT_IN_MS(50));
-
-exit:	
-      Trace(
-            TRACE_LEVEL_ERROR,
-		TRACE_REPORTING,
-		"ReportObjectsContinuous EXIT - 0x%08lX",
-		status);
+	//
+	// A timer already running picks the new frame up on its own
+	//
+	if (start)
+	{
+		WdfTimerStart(ReportContext->ContinuousTimer, -ReportContext->ContinuousPeriod);
+	}
 
+exit:
 	return status;
 }
 
 NTSTATUS
 ReportObjects(
 	IN PREPORT_CONTEXT ReportContext,
-	IN DETECTED_OBJECTS data
+	IN PTOUCH_FRAME Frame
 )
 {
 	if (ReportContext->Props.TouchHardwareLacksContinuousReporting)
       {
             return ReportObjectsContinuous(
 		      ReportContext,
-		      data);
+		      Frame);
       }
       else
       {
             return ReportObjectsInternal(
 		      ReportContext,
-		      data);
+		      Frame);
       }
 }
\ No newline at end of file
@@ -26,6 +26,10 @@
 #include <resolutions.h>
 #include <resolutions.tmh>
 
+#if defined(_M_ARM64)
+#include <arm64_neon.h>
+#endif
+
 //
 // Registry values explaining the relationship of the touch
 // controller coordinates to the physical LCD, as well as
@@ -35,7 +39,7 @@
 // aligned.
 //
 
-TOUCH_SCREEN_PROPERTIES gDefaultProperties =
+static const TOUCH_SCREEN_PROPERTIES gDefaultProperties =
 {
     0x0,
     0x0,
@@ -57,14 +61,14 @@ TOUCH_SCREEN_PROPERTIES gDefaultProperties =
 };
 
 
-RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
+static const RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
 {
     {
         NULL, RTL_QUERY_REGISTRY_DIRECT,
         L"TouchSwapAxes",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchSwapAxes)),
         REG_DWORD,
-        &gDefaultProperties.TouchSwapAxes,
+        (PVOID)&gDefaultProperties.TouchSwapAxes,
         sizeof(ULONG)
     },
     {
@@ -72,7 +76,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchInvertXAxis",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchInvertXAxis)),
         REG_DWORD,
-        &gDefaultProperties.TouchInvertXAxis,
+        (PVOID)&gDefaultProperties.TouchInvertXAxis,
         sizeof(ULONG)
     },
     {
@@ -80,7 +84,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchInvertYAxis",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchInvertYAxis)),
         REG_DWORD,
-        &gDefaultProperties.TouchInvertYAxis,
+        (PVOID)&gDefaultProperties.TouchInvertYAxis,
         sizeof(ULONG)
     },
     {
@@ -88,7 +92,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPhysicalWidth",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPhysicalWidth)),
         REG_DWORD,
-        &gDefaultProperties.TouchPhysicalWidth,
+        (PVOID)&gDefaultProperties.TouchPhysicalWidth,
         sizeof(ULONG)
     },
     {
@@ -96,7 +100,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPhysicalHeight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPhysicalHeight)),
         REG_DWORD,
-        &gDefaultProperties.TouchPhysicalHeight,
+        (PVOID)&gDefaultProperties.TouchPhysicalHeight,
         sizeof(ULONG)
     },
     {
@@ -104,7 +108,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPhysicalButtonHeight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPhysicalButtonHeight)),
         REG_DWORD,
-        &gDefaultProperties.TouchPhysicalButtonHeight,
+        (PVOID)&gDefaultProperties.TouchPhysicalButtonHeight,
         sizeof(ULONG)
     },
     {
@@ -112,7 +116,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPillarBoxWidthLeft",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPillarBoxWidthLeft)),
         REG_DWORD,
-        &gDefaultProperties.TouchPillarBoxWidthLeft,
+        (PVOID)&gDefaultProperties.TouchPillarBoxWidthLeft,
         sizeof(ULONG)
     },
     {
@@ -120,7 +124,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPillarBoxWidthRight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPillarBoxWidthRight)),
         REG_DWORD,
-        &gDefaultProperties.TouchPillarBoxWidthRight,
+        (PVOID)&gDefaultProperties.TouchPillarBoxWidthRight,
         sizeof(ULONG)
     },
     {
@@ -128,7 +132,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchLetterBoxHeightTop",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchLetterBoxHeightTop)),
         REG_DWORD,
-        &gDefaultProperties.TouchLetterBoxHeightTop,
+        (PVOID)&gDefaultProperties.TouchLetterBoxHeightTop,
         sizeof(ULONG)
     },
     {
@@ -136,7 +140,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchLetterBoxHeightBottom",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchLetterBoxHeightBottom)),
         REG_DWORD,
-        &gDefaultProperties.TouchLetterBoxHeightBottom,
+        (PVOID)&gDefaultProperties.TouchLetterBoxHeightBottom,
         sizeof(ULONG)
     },
     {
@@ -144,7 +148,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayPhysicalWidth",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayPhysicalWidth)),
         REG_DWORD,
-        &gDefaultProperties.DisplayPhysicalWidth,
+        (PVOID)&gDefaultProperties.DisplayPhysicalWidth,
         sizeof(ULONG)
     },
     {
@@ -152,7 +156,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayPhysicalHeight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayPhysicalHeight)),
         REG_DWORD,
-        &gDefaultProperties.DisplayPhysicalHeight,
+        (PVOID)&gDefaultProperties.DisplayPhysicalHeight,
         sizeof(ULONG)
     },
     {
@@ -160,7 +164,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayViewableWidth",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayViewableWidth)),
         REG_DWORD,
-        &gDefaultProperties.DisplayViewableWidth,
+        (PVOID)&gDefaultProperties.DisplayViewableWidth,
         sizeof(ULONG)
     },
     {
@@ -168,7 +172,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayViewableHeight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayViewableHeight)),
         REG_DWORD,
-        &gDefaultProperties.DisplayViewableHeight,
+        (PVOID)&gDefaultProperties.DisplayViewableHeight,
         sizeof(ULONG)
     },
     {
@@ -176,7 +180,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayPillarBoxWidthLeft",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayPillarBoxWidthLeft)),
         REG_DWORD,
-        &gDefaultProperties.DisplayPillarBoxWidthLeft,
+        (PVOID)&gDefaultProperties.DisplayPillarBoxWidthLeft,
         sizeof(ULONG)
     },
     {
@@ -184,7 +188,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayPillarBoxWidthRight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayPillarBoxWidthRight)),
         REG_DWORD,
-        &gDefaultProperties.DisplayPillarBoxWidthRight,
+        (PVOID)&gDefaultProperties.DisplayPillarBoxWidthRight,
         sizeof(ULONG)
     },
     {
@@ -192,7 +196,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayLetterBoxHeightTop",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayLetterBoxHeightTop)),
         REG_DWORD,
-        &gDefaultProperties.DisplayLetterBoxHeightTop,
+        (PVOID)&gDefaultProperties.DisplayLetterBoxHeightTop,
         sizeof(ULONG)
     },
     {
@@ -200,7 +204,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayLetterBoxHeightBottom",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayLetterBoxHeightBottom)),
         REG_DWORD,
-        &gDefaultProperties.DisplayLetterBoxHeightBottom,
+        (PVOID)&gDefaultProperties.DisplayLetterBoxHeightBottom,
         sizeof(ULONG)
     },
     {
@@ -208,7 +212,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayHeight10um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayHeight10um)),
         REG_DWORD,
-        &gDefaultProperties.DisplayHeight10um,
+        (PVOID)&gDefaultProperties.DisplayHeight10um,
         sizeof(ULONG)
     },
     {
@@ -216,7 +220,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayWidth10um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayWidth10um)),
         REG_DWORD,
-        &gDefaultProperties.DisplayWidth10um,
+        (PVOID)&gDefaultProperties.DisplayWidth10um,
         sizeof(ULONG)
     },
     {
@@ -224,7 +228,55 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchHardwareLacksContinuousReporting",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchHardwareLacksContinuousReporting)),
         REG_DWORD,
-        &gDefaultProperties.TouchHardwareLacksContinuousReporting,
+        (PVOID)&gDefaultProperties.TouchHardwareLacksContinuousReporting,
+        sizeof(ULONG)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"TouchContinuousReportRate",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchContinuousReportRate)),
+        REG_DWORD,
+        (PVOID)&gDefaultProperties.TouchContinuousReportRate,
+        sizeof(ULONG)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"TouchFilterEnabled",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchFilterEnabled)),
+        REG_DWORD,
+        (PVOID)&gDefaultProperties.TouchFilterEnabled,
+        sizeof(ULONG)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"TouchFilterMinCutoffMilliHz",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchFilterMinCutoffMilliHz)),
+        REG_DWORD,
+        (PVOID)&gDefaultProperties.TouchFilterMinCutoffMilliHz,
+        sizeof(ULONG)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"TouchFilterBeta",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchFilterBeta)),
+        REG_DWORD,
+        (PVOID)&gDefaultProperties.TouchFilterBeta,
+        sizeof(ULONG)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"TouchFilterDerivativeCutoffMilliHz",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchFilterDerivativeCutoffMilliHz)),
+        REG_DWORD,
+        (PVOID)&gDefaultProperties.TouchFilterDerivativeCutoffMilliHz,
+        sizeof(ULONG)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"TouchPredictionUs",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPredictionUs)),
+        REG_DWORD,
+        (PVOID)&gDefaultProperties.TouchPredictionUs,
         sizeof(ULONG)
     },
     //
@@ -245,6 +297,278 @@ static const ULONG gcRegistryTable =
     sizeof(gResParamsRegTable) / sizeof(gResParamsRegTable[0]);
 
 
+static FORCEINLINE
+ULONG
+TchTransformAxis(
+    IN const TOUCH_AXIS_TRANSFORM* Axis,
+    IN ULONG V
+    )
+{
+    ULONG scaled;
+
+    if (Axis->Invert)
+    {
+        V = Axis->InvertBase - min(V, Axis->InvertBase);
+    }
+
+    V = max(V, Axis->ClipLow) - Axis->ClipLow;
+    V = min(V, Axis->ClipHigh) + Axis->ClipBias;
+
+    scaled = (ULONG) (((ULONG64) (V * Axis->Scale) * Axis->Reciprocal) >> Axis->Shift);
+
+    scaled = max(scaled, Axis->DisplayClipLow) - Axis->DisplayClipLow;
+    return min(scaled, Axis->DisplayClipHigh) + Axis->DisplayClipBias;
+}
+
+static
+BOOLEAN
+TchCompileAxisTransform(
+    IN PTOUCH_AXIS_TRANSFORM Axis,
+    IN ULONG Invert,
+    IN ULONG TouchExtent,
+    IN ULONG ClipLow,
+    IN ULONG ClipHigh,
+    IN ULONG Divisor,
+    IN ULONG DisplayExtent,
+    IN ULONG DisplayClipLow,
+    IN ULONG DisplayClipHigh
+    )
+/*++
+ 
+  Routine Description:
+
+    Folds the invert, clip and scale stages of one axis into a
+    TOUCH_AXIS_TRANSFORM. Unsigned arithmetic wraps exactly as it
+    does in TchTranslateToDisplayCoordinatesReference.
+
+  Arguments:
+
+    Axis - receives the compiled transform
+    Invert - non-zero if the axis is inverted
+    TouchExtent - touch controller extent of the axis
+    ClipLow, ClipHigh - touch clipping boundaries
+    Divisor - touch extent the display extent is scaled over
+    DisplayExtent - display extent of the axis
+    DisplayClipLow, DisplayClipHigh - display clipping boundaries
+
+  Return Value:
+
+    FALSE if the axis cannot be represented, for instance because the
+    reference routine would divide by zero
+
+--*/
+{
+    ULONG shift;
+    ULONG64 reciprocal;
+
+    if (TouchExtent == 0 || Divisor == 0)
+    {
+        return FALSE;
+    }
+
+    //
+    // floor(N / d) == (N * ceil(2^s / d)) >> s for every 32-bit N the
+    // axis can produce with s = 31 + ceil(log2(d)); the caller verifies
+    // this against the reference for every input coordinate
+    //
+    shift = 0;
+    while ((1ull << shift) < Divisor)
+    {
+        shift++;
+    }
+    shift += 31;
+
+    reciprocal = ((1ull << shift) + Divisor - 1) / Divisor;
+
+    if (reciprocal > MAXULONG)
+    {
+        return FALSE;
+    }
+
+    Axis->Invert = (Invert != 0);
+    Axis->InvertBase = TouchExtent - 1u;
+    Axis->ClipLow = ClipLow;
+    Axis->ClipHigh = TouchExtent - ClipHigh;
+    Axis->ClipBias = ClipHigh;
+    Axis->Scale = DisplayExtent;
+    Axis->Reciprocal = (UINT32) reciprocal;
+    Axis->Shift = shift;
+    Axis->DisplayClipLow = DisplayClipLow;
+    Axis->DisplayClipHigh = DisplayExtent - DisplayClipHigh;
+    Axis->DisplayClipBias = DisplayClipHigh;
+
+    return TRUE;
+}
+
+VOID
+TchCompileCoordinateTransform(
+    IN PTOUCH_SCREEN_PROPERTIES Props
+    )
+/*++
+ 
+  Routine Description:
+
+    This routine compiles the screen properties into the
+    coordinate transform used by TchTranslateToDisplayCoordinates.
+    The transform is checked against the reference routine for
+    every possible controller coordinate and left disabled if any
+    result differs.
+
+  Arguments:
+
+    Props - screen information, receives the compiled transform
+
+  Return Value:
+
+    None
+
+--*/
+{
+    PTOUCH_COORDINATE_TRANSFORM transform;
+    ULONG v;
+
+    transform = &Props->Transform;
+    RtlZeroMemory(transform, sizeof(TOUCH_COORDINATE_TRANSFORM));
+
+    transform->SwapAxes = (Props->TouchSwapAxes != 0);
+
+    if (!TchCompileAxisTransform(
+            &transform->X,
+            Props->TouchInvertXAxis,
+            Props->TouchPhysicalWidth,
+            Props->TouchPillarBoxWidthLeft,
+            Props->TouchPillarBoxWidthRight,
+            Props->TouchPhysicalWidth,
+            Props->DisplayPhysicalWidth,
+            Props->DisplayPillarBoxWidthLeft,
+            Props->DisplayPillarBoxWidthRight) ||
+        !TchCompileAxisTransform(
+            &transform->Y,
+            Props->TouchInvertYAxis,
+            Props->TouchPhysicalHeight,
+            Props->TouchLetterBoxHeightTop,
+            Props->TouchLetterBoxHeightBottom,
+            Props->TouchPhysicalHeight - Props->TouchPhysicalButtonHeight,
+            Props->DisplayPhysicalHeight,
+            Props->DisplayLetterBoxHeightTop,
+            Props->DisplayLetterBoxHeightBottom))
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_REGISTRY,
+            "Screen properties cannot be compiled, using reference coordinate translation");
+
+        goto exit;
+    }
+
+    //
+    // Feeding the same value to both axes makes the check independent of
+    // the axis swap
+    //
+    for (v = 0; v <= MAXUSHORT; v++)
+    {
+        USHORT referenceX = (USHORT) v;
+        USHORT referenceY = (USHORT) v;
+
+        TchTranslateToDisplayCoordinatesReference(
+            &referenceX,
+            &referenceY,
+            Props);
+
+        if ((USHORT) TchTransformAxis(&transform->X, v) != referenceX ||
+            (USHORT) TchTransformAxis(&transform->Y, v) != referenceY)
+        {
+            Trace(
+                TRACE_LEVEL_WARNING,
+                TRACE_REGISTRY,
+                "Compiled coordinate transform differs at %d, using reference coordinate translation",
+                v);
+
+            goto exit;
+        }
+    }
+
+    transform->Compiled = TRUE;
+
+exit:
+    return;
+}
+
+VOID
+TchCompileContactFilter(
+    IN PTOUCH_SCREEN_PROPERTIES Props
+    )
+/*++
+ 
+  Routine Description:
+
+    This routine compiles the contact filter settings of the
+    screen properties into the filter used by the reporting
+    code. Cutoffs and beta left at 0 take their defaults, values
+    out of range are clamped.
+
+  Arguments:
+
+    Props - screen information, receives the compiled filter
+
+  Return Value:
+
+    None
+
+--*/
+{
+    PTOUCH_CONTACT_FILTER filter;
+
+    filter = &Props->Filter;
+    RtlZeroMemory(filter, sizeof(TOUCH_CONTACT_FILTER));
+
+    if (Props->TouchFilterEnabled == 0)
+    {
+        return;
+    }
+
+    filter->MinCutoff = Props->TouchFilterMinCutoffMilliHz;
+    filter->Beta = Props->TouchFilterBeta;
+    filter->DerivativeCutoff = Props->TouchFilterDerivativeCutoffMilliHz;
+
+    if (filter->MinCutoff == 0)
+    {
+        filter->MinCutoff = TOUCH_FILTER_DEFAULT_MIN_CUTOFF;
+    }
+
+    if (filter->Beta == 0)
+    {
+        filter->Beta = TOUCH_FILTER_DEFAULT_BETA;
+    }
+
+    if (filter->DerivativeCutoff == 0)
+    {
+        filter->DerivativeCutoff = TOUCH_FILTER_DEFAULT_DERIVATIVE_CUTOFF;
+    }
+
+    filter->MinCutoff = min(filter->MinCutoff, TOUCH_FILTER_MAX_CUTOFF);
+    filter->Beta = min(filter->Beta, TOUCH_FILTER_MAX_BETA);
+    filter->DerivativeCutoff = min(filter->DerivativeCutoff, TOUCH_FILTER_MAX_CUTOFF);
+
+    //
+    // The horizon in seconds, Q16, multiplies the filtered velocity
+    //
+    filter->Prediction = (UINT32)(
+        ((ULONG64)min(Props->TouchPredictionUs, TOUCH_FILTER_MAX_PREDICTION_US) << 16) /
+        1000000);
+
+    filter->Enabled = TRUE;
+
+    Trace(
+        TRACE_LEVEL_INFORMATION,
+        TRACE_REGISTRY,
+        "Contact filter cutoff %lu mHz, beta %lu, derivative cutoff %lu mHz, prediction %lu us",
+        filter->MinCutoff,
+        filter->Beta,
+        filter->DerivativeCutoff,
+        min(Props->TouchPredictionUs, TOUCH_FILTER_MAX_PREDICTION_US));
+}
+
 VOID
 TchTranslateToDisplayCoordinates(
     IN PUSHORT PX,
@@ -257,7 +581,189 @@ TchTranslateToDisplayCoordinates(
 
     This routine performs translations on touch coordinates
     to ensure points reported to the OS match pixels on the
-    display.
+    display, using the transform compiled from the screen
+    properties.
+
+  Arguments:
+
+    X - pointer to the pre-processed X coordinate
+    Y - pointer the pre-processed Y coordinate
+    Props - pointer to screen information
+
+  Return Value:
+
+    None. The X/Y values will be modified by this function.
+
+--*/
+{
+    PTOUCH_COORDINATE_TRANSFORM transform;
+    ULONG X;
+    ULONG Y;
+#if DBG
+    USHORT referenceX = *PX;
+    USHORT referenceY = *PY;
+#endif
+
+    transform = &Props->Transform;
+
+    if (!transform->Compiled)
+    {
+        TchTranslateToDisplayCoordinatesReference(PX, PY, Props);
+        return;
+    }
+
+    if (transform->SwapAxes)
+    {
+        X = (ULONG) *PY;
+        Y = (ULONG) *PX;
+    }
+    else
+    {
+        X = (ULONG) *PX;
+        Y = (ULONG) *PY;
+    }
+
+    *PX = (USHORT) TchTransformAxis(&transform->X, X);
+    *PY = (USHORT) TchTransformAxis(&transform->Y, Y);
+
+#if DBG
+    TchTranslateToDisplayCoordinatesReference(
+        &referenceX,
+        &referenceY,
+        Props);
+
+    NT_ASSERT(*PX == referenceX && *PY == referenceY);
+#endif
+}
+
+#if defined(_M_ARM64)
+
+static FORCEINLINE
+uint32x4_t
+TchTransformAxisNeon(
+    IN const TOUCH_AXIS_TRANSFORM* Axis,
+    IN uint32x4_t V
+    )
+{
+    uint32x4_t scaled;
+    uint32x2_t reciprocal;
+    int64x2_t shift;
+
+    if (Axis->Invert)
+    {
+        uint32x4_t base = vdupq_n_u32(Axis->InvertBase);
+        V = vsubq_u32(base, vminq_u32(V, base));
+    }
+
+    V = vsubq_u32(vmaxq_u32(V, vdupq_n_u32(Axis->ClipLow)), vdupq_n_u32(Axis->ClipLow));
+    V = vaddq_u32(vminq_u32(V, vdupq_n_u32(Axis->ClipHigh)), vdupq_n_u32(Axis->ClipBias));
+
+    //
+    // 32-bit product, then widening multiply by the reciprocal and shift
+    //
+    V = vmulq_u32(V, vdupq_n_u32(Axis->Scale));
+
+    reciprocal = vdup_n_u32(Axis->Reciprocal);
+    shift = vdupq_n_s64(-(LONG64) Axis->Shift);
+
+    scaled = vcombine_u32(
+        vmovn_u64(vshlq_u64(vmull_u32(vget_low_u32(V), reciprocal), shift)),
+        vmovn_u64(vshlq_u64(vmull_u32(vget_high_u32(V), reciprocal), shift)));
+
+    scaled = vsubq_u32(vmaxq_u32(scaled, vdupq_n_u32(Axis->DisplayClipLow)), vdupq_n_u32(Axis->DisplayClipLow));
+    return vaddq_u32(vminq_u32(scaled, vdupq_n_u32(Axis->DisplayClipHigh)), vdupq_n_u32(Axis->DisplayClipBias));
+}
+
+#endif
+
+VOID
+TchTranslateToDisplayCoordinatesBatch(
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN ULONG Count,
+    IN PUSHORT X,
+    IN PUSHORT Y
+    )
+/*++
+ 
+  Routine Description:
+
+    This routine translates the coordinates of every contact of a
+    frame to display coordinates in one pass. On ARM64 four contacts
+    are transformed per iteration with NEON.
+
+  Arguments:
+
+    Props - pointer to screen information
+    Count - number of contacts
+    X - array of Count X coordinates, translated in place
+    Y - array of Count Y coordinates, translated in place
+
+  Return Value:
+
+    None. The X/Y arrays will be modified by this function.
+
+--*/
+{
+    PTOUCH_COORDINATE_TRANSFORM transform;
+    PUSHORT inX;
+    PUSHORT inY;
+    ULONG i;
+
+    transform = &Props->Transform;
+
+    if (!transform->Compiled)
+    {
+        for (i = 0; i < Count; i++)
+        {
+            TchTranslateToDisplayCoordinatesReference(&X[i], &Y[i], Props);
+        }
+
+        return;
+    }
+
+    //
+    // Swapping the axes only swaps which input feeds which axis
+    //
+    inX = transform->SwapAxes ? Y : X;
+    inY = transform->SwapAxes ? X : Y;
+
+    i = 0;
+
+#if defined(_M_ARM64)
+    for (; i + 4 <= Count; i += 4)
+    {
+        uint32x4_t vx = vmovl_u16(vld1_u16(&inX[i]));
+        uint32x4_t vy = vmovl_u16(vld1_u16(&inY[i]));
+
+        vst1_u16(&X[i], vmovn_u32(TchTransformAxisNeon(&transform->X, vx)));
+        vst1_u16(&Y[i], vmovn_u32(TchTransformAxisNeon(&transform->Y, vy)));
+    }
+#endif
+
+    for (; i < Count; i++)
+    {
+        ULONG vx = inX[i];
+        ULONG vy = inY[i];
+
+        X[i] = (USHORT) TchTransformAxis(&transform->X, vx);
+        Y[i] = (USHORT) TchTransformAxis(&transform->Y, vy);
+    }
+}
+
+VOID
+TchTranslateToDisplayCoordinatesReference(
+    IN PUSHORT PX,
+    IN PUSHORT PY,
+    IN PTOUCH_SCREEN_PROPERTIES Props
+    )
+/*++
+ 
+  Routine Description:
+
+    This routine performs translations on touch coordinates
+    to ensure points reported to the OS match pixels on the
+    display. It evaluates the screen properties directly and
+    serves as the reference for the compiled transform.
 
   Arguments:
 
@@ -406,7 +912,8 @@ TchTranslateToDisplayCoordinates(
 
 VOID
 TchGetScreenProperties(
-    IN PTOUCH_SCREEN_PROPERTIES Props
+    OUT PTOUCH_SCREEN_PROPERTIES Props,
+    IN const TOUCH_CONFIGURATION_BLOB_HEADER* ConfigurationBlob OPTIONAL
     )
 /*++
  
@@ -418,6 +925,8 @@ TchGetScreenProperties(
   Arguments:
 
     Props - receives the Props
+    ConfigurationBlob - Optional validated blob replacing the registry
+        values, as returned by TchLoadConfigurationBlob
 
   Return Value:
 
@@ -431,6 +940,20 @@ TchGetScreenProperties(
 
     regTable = NULL;
 
+    //
+    // A configuration blob replaces the per-value queries below, its
+    // values are still checked
+    //
+    if (ConfigurationBlob != NULL)
+    {
+        RtlCopyMemory(
+            Props,
+            (PUCHAR)(ConfigurationBlob + 1) + sizeof(TOUCH_SCREEN_SETTINGS),
+            TOUCH_CONFIGURATION_BLOB_PROPERTIES_SIZE);
+
+        goto check;
+    }
+
     //
     // Table passed to RtlQueryRegistryValues must be allocated 
     // from NonPagedPoolNx
@@ -487,6 +1010,8 @@ TchGetScreenProperties(
             status);
     }
 
+check:
+
     //
     // Sanity check values provided from the registry
     //
@@ -528,6 +1053,12 @@ TchGetScreenProperties(
             gDefaultProperties.TouchLetterBoxHeightBottom;
     }
 
+    //
+    // Precompute the coordinate transform for the reporting path
+    //
+    TchCompileCoordinateTransform(Props);
+    TchCompileContactFilter(Props);
+
     if (regTable != NULL)
     {
         ExFreePoolWithTag(regTable, TOUCH_POOL_TAG);
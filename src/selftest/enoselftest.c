@@ -258,6 +258,17 @@ Return Value:
         break;
     }
 
+    case IOCTL_TOUCH_ENOSELFTEST_BATCH:
+    {
+        status = TchSelfTestExecuteBatch(
+            devContext,
+            Request,
+            OutputBufferLength,
+            InputBufferLength);
+
+        break;
+    }
+
     default:
     {
         status = STATUS_NOT_IMPLEMENTED;
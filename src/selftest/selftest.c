@@ -30,6 +30,360 @@
 #include <selftest\selftest.h>
 #include <selftest.tmh>
 
+C_ASSERT(TOUCH_TEST_LATENCY_STAGES == REPORT_LATENCY_STAGES);
+C_ASSERT(TOUCH_TEST_LATENCY_BUCKETS == REPORT_LATENCY_BUCKETS);
+C_ASSERT(TOUCH_TEST_LATENCY_STAGE_SPB_READ == REPORT_LATENCY_STAGE_SPB_READ);
+C_ASSERT(TOUCH_TEST_LATENCY_STAGE_CACHE_UPDATE == REPORT_LATENCY_STAGE_CACHE_UPDATE);
+C_ASSERT(TOUCH_TEST_LATENCY_STAGE_REPORT_SENT == REPORT_LATENCY_STAGE_REPORT_SENT);
+C_ASSERT(sizeof(FOCAL_TECH_EVENT_DATA) <= TOUCH_TEST_RECORDED_FRAME_DATA_SIZE);
+
+EVT_WDF_REQUEST_CANCEL TchSelfTestRawStreamCanceled;
+
+static VOID
+TchSelfTestDetachRawStream(
+    IN TOUCH_RAW_STREAM* Stream
+    )
+/*++
+
+Routine Description:
+
+    Forgets the ring of the current stream, the caller holds the stream
+    lock and completes the request afterwards.
+
+Arguments:
+
+    Stream - Raw frame stream of the device
+
+Return Value:
+
+    None
+
+--*/
+{
+    Stream->Request = NULL;
+    Stream->FileObject = NULL;
+    Stream->Slots = NULL;
+    Stream->ProducerIndex = NULL;
+    Stream->ConsumerIndex = NULL;
+    Stream->DroppedFrames = NULL;
+    Stream->Canceled = FALSE;
+}
+
+static NTSTATUS
+TchSelfTestStartRawStream(
+    IN PDEVICE_EXTENSION DeviceContext,
+    IN WDFREQUEST Request
+    )
+/*++
+
+Routine Description:
+
+    Validates an IOCTL_TOUCH_SELFTEST_RAW_STREAM request, lays out the ring
+    in its output buffer and makes it the current stream. The output
+    buffer is described by an MDL locked for the life of the request, its
+    system mapping is what the interrupt routine reads frames into.
+
+Arguments:
+
+    DeviceContext - Touch device context
+    Request - Framework request object handle
+
+Return Value:
+
+    STATUS_SUCCESS if the request now belongs to the stream, otherwise
+    the status to complete it with
+
+--*/
+{
+    TOUCH_TEST_RAW_STREAM_PARAMETERS* parameters;
+    TOUCH_TEST_RAW_RING_HEADER* ring;
+    TOUCH_RAW_STREAM* stream;
+    PMDL mdl;
+    ULONG ringLength;
+    ULONG slotSize;
+    ULONG frameLength;
+    UCHAR address;
+    NTSTATUS status;
+
+    stream = &DeviceContext->RawStream;
+
+    //
+    // Validate parameters and memory
+    //
+    status = WdfRequestRetrieveInputBuffer(
+        Request,
+        sizeof(TOUCH_TEST_RAW_STREAM_PARAMETERS),
+        (PVOID) &parameters,
+        NULL);
+
+    if (!NT_SUCCESS(status))
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto exit;
+    }
+
+    address = parameters->Address;
+    frameLength = parameters->FrameLength;
+
+    if (frameLength == 0 ||
+        frameLength > TOUCH_TEST_RAW_STREAM_MAX_FRAME_LENGTH)
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto exit;
+    }
+
+    status = WdfRequestRetrieveOutputWdmMdl(Request, &mdl);
+
+    if (!NT_SUCCESS(status))
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto exit;
+    }
+
+    //
+    // Slots stay 8 byte aligned for the timestamps
+    //
+    slotSize = (ULONG) ALIGN_UP_BY(sizeof(TOUCH_TEST_RAW_FRAME) + frameLength, sizeof(ULONG64));
+    ringLength = MmGetMdlByteCount(mdl);
+
+    if (ringLength < sizeof(TOUCH_TEST_RAW_RING_HEADER) + 2 * slotSize)
+    {
+        status = STATUS_BUFFER_TOO_SMALL;
+        goto exit;
+    }
+
+    ring = (TOUCH_TEST_RAW_RING_HEADER*) MmGetSystemAddressForMdlSafe(
+        mdl,
+        NormalPagePriority | MdlMappingNoExecute);
+
+    if (ring == NULL)
+    {
+        status = STATUS_INSUFFICIENT_RESOURCES;
+        goto exit;
+    }
+
+    ring->HeaderSize = sizeof(TOUCH_TEST_RAW_RING_HEADER);
+    ring->SlotSize = slotSize;
+    ring->SlotCount = (ringLength - sizeof(TOUCH_TEST_RAW_RING_HEADER)) / slotSize;
+    ring->FrameLength = frameLength;
+    ring->ProducerIndex = 0;
+    ring->ConsumerIndex = 0;
+    ring->DroppedFrames = 0;
+    ring->Reserved = 0;
+
+    WdfSpinLockAcquire(stream->Lock);
+
+    if (stream->Request != NULL)
+    {
+        WdfSpinLockRelease(stream->Lock);
+        status = STATUS_DEVICE_BUSY;
+        goto exit;
+    }
+
+    status = WdfRequestMarkCancelableEx(Request, TchSelfTestRawStreamCanceled);
+
+    if (!NT_SUCCESS(status))
+    {
+        WdfSpinLockRelease(stream->Lock);
+        goto exit;
+    }
+
+    //
+    // The driver keeps its own copies of everything it indexes the ring
+    // with, the client only ever hands back ConsumerIndex
+    //
+    stream->Request = Request;
+    stream->FileObject = WdfRequestGetFileObject(Request);
+    stream->Slots = (PUCHAR) (ring + 1);
+    stream->ProducerIndex = &ring->ProducerIndex;
+    stream->ConsumerIndex = &ring->ConsumerIndex;
+    stream->DroppedFrames = &ring->DroppedFrames;
+    stream->SlotSize = slotSize;
+    stream->SlotCount = (ringLength - sizeof(TOUCH_TEST_RAW_RING_HEADER)) / slotSize;
+    stream->FrameLength = frameLength;
+    stream->Produced = 0;
+    stream->Sequence = 0;
+    stream->Address = address;
+    stream->InUse = FALSE;
+    stream->Canceled = FALSE;
+
+    WdfSpinLockRelease(stream->Lock);
+
+    Trace(
+        TRACE_LEVEL_INFORMATION,
+        TRACE_INIT,
+        "Streaming %lu byte raw frames from 0x%02X into %lu slots",
+        frameLength,
+        address,
+        stream->SlotCount);
+
+exit:
+
+    return status;
+}
+
+VOID
+TchSelfTestRawStreamCanceled(
+    IN WDFREQUEST Request
+    )
+/*++
+
+Routine Description:
+
+    Ends the stream owning the canceled request. A frame read into the
+    ring may be under way, in which case the interrupt routine completes
+    the request once it is done with the ring.
+
+Arguments:
+
+    Request - The pending IOCTL_TOUCH_SELFTEST_RAW_STREAM request
+
+Return Value:
+
+    None
+
+--*/
+{
+    PDEVICE_EXTENSION devContext;
+    TOUCH_RAW_STREAM* stream;
+    BOOLEAN complete;
+
+    devContext = GetDeviceContext(WdfPdoGetParent(WdfIoQueueGetDevice(WdfRequestGetIoQueue(Request))));
+    stream = &devContext->RawStream;
+    complete = FALSE;
+
+    WdfSpinLockAcquire(stream->Lock);
+
+    if (stream->Request == Request)
+    {
+        if (stream->InUse)
+        {
+            stream->Canceled = TRUE;
+        }
+        else
+        {
+            TchSelfTestDetachRawStream(stream);
+            complete = TRUE;
+        }
+    }
+
+    WdfSpinLockRelease(stream->Lock);
+
+    if (complete)
+    {
+        WdfRequestCompleteWithInformation(Request, STATUS_CANCELLED, 0);
+    }
+}
+
+VOID
+TchSelfTestServiceRawStream(
+    IN PDEVICE_EXTENSION DeviceContext
+    )
+/*++
+
+Routine Description:
+
+    Called from the interrupt routine in diagnostic mode, reads the frame
+    of the interrupt into the next free slot of the ring and publishes it.
+    The SPB read targets the ring itself so frames are never copied.
+
+Arguments:
+
+    DeviceContext - Touch device context
+
+Return Value:
+
+    None
+
+--*/
+{
+    TOUCH_RAW_STREAM* stream;
+    TOUCH_TEST_RAW_FRAME* frame;
+    WDFREQUEST request;
+    ULONG consumed;
+    NTSTATUS status;
+
+    stream = &DeviceContext->RawStream;
+    request = NULL;
+
+    //
+    // Most diagnostic sessions do not stream, skip the lock for them
+    //
+    if (stream->Request == NULL)
+    {
+        return;
+    }
+
+    WdfSpinLockAcquire(stream->Lock);
+
+    if (stream->Request == NULL || stream->Canceled)
+    {
+        WdfSpinLockRelease(stream->Lock);
+        return;
+    }
+
+    stream->InUse = TRUE;
+
+    WdfSpinLockRelease(stream->Lock);
+
+    consumed = (ULONG) ReadAcquire(stream->ConsumerIndex);
+
+    if (stream->Produced - consumed >= stream->SlotCount)
+    {
+        InterlockedIncrement(stream->DroppedFrames);
+        goto exit;
+    }
+
+    frame = (TOUCH_TEST_RAW_FRAME*) (stream->Slots +
+        (stream->Produced % stream->SlotCount) * stream->SlotSize);
+
+    status = SpbReadDataDirectSynchronously(
+        &DeviceContext->I2CContext,
+        stream->Address,
+        frame + 1,
+        stream->FrameLength);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_REPORTING,
+            "Error reading raw frame - 0x%08lX",
+            status);
+
+        InterlockedIncrement(stream->DroppedFrames);
+        goto exit;
+    }
+
+    frame->InterruptTime = (ULONG64) ReadNoFence64(&DeviceContext->ReportContext->InterruptTime);
+    frame->Sequence = stream->Sequence;
+    frame->Length = stream->FrameLength;
+
+    stream->Produced++;
+    WriteRelease(stream->ProducerIndex, (LONG) stream->Produced);
+
+exit:
+
+    stream->Sequence++;
+
+    WdfSpinLockAcquire(stream->Lock);
+
+    stream->InUse = FALSE;
+
+    if (stream->Canceled)
+    {
+        request = stream->Request;
+        TchSelfTestDetachRawStream(stream);
+    }
+
+    WdfSpinLockRelease(stream->Lock);
+
+    if (request != NULL)
+    {
+        WdfRequestCompleteWithInformation(request, STATUS_CANCELLED, 0);
+    }
+}
+
 VOID
 TchSelfTestOnDeviceControl(
     IN WDFQUEUE Queue,
@@ -68,6 +422,20 @@ Return Value:
     NTSTATUS status = STATUS_INVALID_PARAMETER;
     BOOLEAN *requestedDiagnosticMode;
     UCHAR *requestedPage;
+    TOUCH_TEST_INTERRUPT_STATS *interruptStats;
+    TOUCH_TEST_LATENCY_STATS *latencyStats;
+    REPORT_LATENCY_STATS *latency;
+    ULONG stage;
+    ULONG bucket;
+    PVOID blob;
+    size_t blobLength;
+    ULONG blobSize;
+    TOUCH_TEST_RECORDED_FRAMES *recordedFrames;
+    TOUCH_TEST_RECORDED_FRAME *recordedFrame;
+    FT5X_RECORDED_FRAME *frames;
+    FT5X_CONTROLLER_CONTEXT *controller;
+    ULONG frameCount;
+    ULONG frame;
 
 
     devContext = GetDeviceContext(WdfPdoGetParent(WdfIoQueueGetDevice(Queue)));
@@ -258,6 +626,222 @@ Return Value:
             break;
         }
 
+        case IOCTL_TOUCH_SELFTEST_INTERRUPT_STATS:
+        {
+            //
+            // Validate parameters and memory
+            //
+            status = WdfRequestRetrieveOutputBuffer(
+                Request,
+                sizeof(TOUCH_TEST_INTERRUPT_STATS),
+                (PVOID) &interruptStats,
+                NULL);
+
+            if (!NT_SUCCESS(status))
+            {
+                status = STATUS_INVALID_PARAMETER;
+                goto exit;
+            }
+
+            interruptStats->InterruptsReceived = (ULONG) devContext->InterruptsReceived;
+            interruptStats->InterruptsCollapsed = (ULONG) devContext->InterruptsCollapsed;
+            interruptStats->FramesServiced = (ULONG) devContext->FramesServiced;
+            interruptStats->WatchdogStalls = (ULONG) devContext->WatchdogStalls;
+            interruptStats->WatchdogPolls = (ULONG) devContext->WatchdogPolls;
+            interruptStats->StationaryFramesSuppressed =
+                (ULONG) devContext->ReportContext->StationaryFramesSuppressed;
+
+            WdfRequestSetInformation(Request, sizeof(TOUCH_TEST_INTERRUPT_STATS));
+
+            break;
+        }
+
+        case IOCTL_TOUCH_SELFTEST_LATENCY_STATS:
+        {
+            //
+            // Validate parameters and memory
+            //
+            status = WdfRequestRetrieveOutputBuffer(
+                Request,
+                sizeof(TOUCH_TEST_LATENCY_STATS),
+                (PVOID) &latencyStats,
+                NULL);
+
+            if (!NT_SUCCESS(status))
+            {
+                status = STATUS_INVALID_PARAMETER;
+                goto exit;
+            }
+
+            //
+            // The counters keep moving while they are copied, which the
+            // caller sees as samples landing between two polls
+            //
+            latency = &devContext->ReportContext->Latency;
+
+            for (stage = 0; stage < TOUCH_TEST_LATENCY_STAGES; stage++)
+            {
+                for (bucket = 0; bucket < TOUCH_TEST_LATENCY_BUCKETS; bucket++)
+                {
+                    latencyStats->Buckets[stage][bucket] =
+                        (ULONG) ReadNoFence(&latency->Buckets[stage][bucket]);
+                }
+
+                latencyStats->TotalMicroseconds[stage] =
+                    (ULONG64) ReadNoFence64(&latency->TotalMicroseconds[stage]);
+            }
+
+            latencyStats->CoalescedReports = (ULONG) devContext->ReportContext->ReportRing.CoalescedReports;
+            latencyStats->DroppedReports = (ULONG) devContext->ReportContext->ReportRing.DroppedReports;
+            latencyStats->FailedReads = (ULONG) latency->FailedReads;
+
+            WdfRequestSetInformation(Request, sizeof(TOUCH_TEST_LATENCY_STATS));
+
+            break;
+        }
+
+        case IOCTL_TOUCH_SELFTEST_CONFIGURATION_BLOB:
+        {
+            //
+            // Validate parameters and memory
+            //
+            status = WdfRequestRetrieveOutputBuffer(
+                Request,
+                sizeof(TOUCH_CONFIGURATION_BLOB_HEADER),
+                &blob,
+                &blobLength);
+
+            if (!NT_SUCCESS(status))
+            {
+                status = STATUS_INVALID_PARAMETER;
+                goto exit;
+            }
+
+            blobSize = TchBuildConfigurationBlob(
+                &((FT5X_CONTROLLER_CONTEXT*) devContext->TouchContext)->TouchSettings,
+                &devContext->ReportContext->Props,
+                blob,
+                (ULONG) min(blobLength, MAXULONG));
+
+            if (blobLength < blobSize)
+            {
+                //
+                // Only the header was filled in, it sizes the next buffer
+                //
+                WdfRequestSetInformation(Request, sizeof(TOUCH_CONFIGURATION_BLOB_HEADER));
+
+                status = STATUS_BUFFER_OVERFLOW;
+                break;
+            }
+
+            WdfRequestSetInformation(Request, blobSize);
+
+            break;
+        }
+
+        case IOCTL_TOUCH_SELFTEST_RAW_STREAM:
+        {
+            status = TchSelfTestStartRawStream(devContext, Request);
+
+            if (NT_SUCCESS(status))
+            {
+                //
+                // The request stays pending for the length of the stream
+                //
+                return;
+            }
+
+            break;
+        }
+
+        case IOCTL_TOUCH_SELFTEST_RECORDED_FRAMES:
+        {
+            controller = (FT5X_CONTROLLER_CONTEXT*) devContext->TouchContext;
+
+            if (!controller->Recorder.Enabled)
+            {
+                status = STATUS_NOT_SUPPORTED;
+                goto exit;
+            }
+
+            //
+            // Validate parameters and memory
+            //
+            status = WdfRequestRetrieveOutputBuffer(
+                Request,
+                sizeof(TOUCH_TEST_RECORDED_FRAMES),
+                (PVOID) &recordedFrames,
+                NULL);
+
+            if (!NT_SUCCESS(status))
+            {
+                status = STATUS_INVALID_PARAMETER;
+                goto exit;
+            }
+
+            frameCount = (ULONG) min(
+                (OutputBufferLength - sizeof(TOUCH_TEST_RECORDED_FRAMES)) / sizeof(TOUCH_TEST_RECORDED_FRAME),
+                FT5X_FRAME_RECORDER_DEPTH);
+
+            frames = NULL;
+
+            if (frameCount != 0)
+            {
+                frames = ExAllocatePoolWithTag(
+                    PagedPool,
+                    frameCount * sizeof(FT5X_RECORDED_FRAME),
+                    TOUCH_POOL_TAG);
+
+                if (frames == NULL)
+                {
+                    status = STATUS_INSUFFICIENT_RESOURCES;
+                    goto exit;
+                }
+
+                frameCount = Ft5xCopyRecordedFrames(controller, frames, frameCount);
+            }
+
+            recordedFrame = (TOUCH_TEST_RECORDED_FRAME*) (recordedFrames + 1);
+
+            for (frame = 0; frame < frameCount; frame++)
+            {
+                RtlZeroMemory(&recordedFrame[frame], sizeof(TOUCH_TEST_RECORDED_FRAME));
+                recordedFrame[frame].InterruptTime = frames[frame].Timestamp;
+                recordedFrame[frame].Sequence = (ULONG) frames[frame].Sequence;
+                recordedFrame[frame].Length = frames[frame].Length;
+
+                RtlCopyMemory(
+                    recordedFrame[frame].Data,
+                    &frames[frame].EventData,
+                    frames[frame].Length);
+            }
+
+            if (frames != NULL)
+            {
+                ExFreePoolWithTag(frames, TOUCH_POOL_TAG);
+            }
+
+            recordedFrames->FrameCount = frameCount;
+            recordedFrames->Reserved = 0;
+
+            WdfRequestSetInformation(
+                Request,
+                sizeof(TOUCH_TEST_RECORDED_FRAMES) + frameCount * sizeof(TOUCH_TEST_RECORDED_FRAME));
+
+            break;
+        }
+
+        case IOCTL_TOUCH_SELFTEST_BATCH:
+        {
+            status = TchSelfTestExecuteBatch(
+                devContext,
+                Request,
+                OutputBufferLength,
+                InputBufferLength);
+
+            break;
+        }
+
         default:
         {
             status = STATUS_NOT_IMPLEMENTED;
@@ -272,6 +856,274 @@ exit:
         status);
 }
 
+NTSTATUS
+TchSelfTestExecuteBatch(
+    IN PDEVICE_EXTENSION DeviceContext,
+    IN WDFREQUEST Request,
+    IN size_t OutputBufferLength,
+    IN size_t InputBufferLength
+    )
+/*++
+
+Routine Description:
+
+    This routine validates a batched I2C request and runs its reads and
+    writes as one SPB batch, delays being folded into the transfer that
+    follows them. Reads land straight in the output buffer, which is
+    non-paged and free for it once the input has been copied out.
+
+Arguments:
+
+    DeviceContext - Touch device context
+    Request - Framework request object handle
+    OutputBufferLength - self-explanatory
+    InputBufferLength - self-explanatory
+
+Return Value:
+
+    NTSTATUS indicating whether the request was accepted
+
+--*/
+{
+    TOUCH_TEST_BATCH_HEADER* header;
+    TOUCH_TEST_BATCH_OPERATION* operations;
+    TOUCH_TEST_BATCH_RESULT* result;
+    SPB_BATCH_TRANSFER* transfers;
+    PUCHAR writeBuffer;
+    PUCHAR payload;
+    PUCHAR scratch;
+    PUCHAR readData;
+    LARGE_INTEGER delay;
+    ULONG operationCount;
+    ULONG transferCount;
+    ULONG writeCount;
+    ULONG writeBytes;
+    ULONG readBytes;
+    ULONG pendingDelay;
+    ULONG totalDelay;
+    ULONG completed;
+    ULONG i;
+    NTSTATUS status;
+
+    scratch = NULL;
+
+    //
+    // Validate parameters and memory
+    //
+    status = WdfRequestRetrieveInputBuffer(
+        Request,
+        sizeof(TOUCH_TEST_BATCH_HEADER),
+        (PVOID) &header,
+        NULL);
+
+    if (!NT_SUCCESS(status))
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto exit;
+    }
+
+    operationCount = header->OperationCount;
+
+    if (operationCount == 0 ||
+        operationCount > TOUCH_TEST_BATCH_MAX_OPERATIONS ||
+        InputBufferLength < sizeof(TOUCH_TEST_BATCH_HEADER) +
+            operationCount * sizeof(TOUCH_TEST_BATCH_OPERATION))
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto exit;
+    }
+
+    operations = (TOUCH_TEST_BATCH_OPERATION*) (header + 1);
+    transferCount = 0;
+    writeCount = 0;
+    writeBytes = 0;
+    readBytes = 0;
+    totalDelay = 0;
+
+    for (i = 0; i < operationCount; i++)
+    {
+        switch (operations[i].Operation)
+        {
+            case TOUCH_TEST_BATCH_OP_READ:
+            case TOUCH_TEST_BATCH_OP_WRITE:
+            {
+                if (operations[i].Length == 0 ||
+                    operations[i].Length > TOUCH_TEST_BATCH_MAX_LENGTH)
+                {
+                    status = STATUS_INVALID_PARAMETER;
+                    goto exit;
+                }
+
+                if (operations[i].Operation == TOUCH_TEST_BATCH_OP_READ)
+                {
+                    readBytes += operations[i].Length;
+                }
+                else
+                {
+                    writeBytes += operations[i].Length;
+                    writeCount++;
+                }
+
+                transferCount++;
+                break;
+            }
+
+            case TOUCH_TEST_BATCH_OP_DELAY:
+            {
+                if (operations[i].Length > TOUCH_TEST_BATCH_MAX_DELAY_US)
+                {
+                    status = STATUS_INVALID_PARAMETER;
+                    goto exit;
+                }
+
+                //
+                // Touch servicing waits for the SPB lock through all of
+                // the batch's delays
+                //
+                totalDelay += operations[i].Length;
+
+                if (totalDelay > TOUCH_TEST_BATCH_MAX_TOTAL_DELAY_US)
+                {
+                    status = STATUS_INVALID_PARAMETER;
+                    goto exit;
+                }
+
+                break;
+            }
+
+            default:
+            {
+                status = STATUS_INVALID_PARAMETER;
+                goto exit;
+            }
+        }
+    }
+
+    if (InputBufferLength != sizeof(TOUCH_TEST_BATCH_HEADER) +
+            operationCount * sizeof(TOUCH_TEST_BATCH_OPERATION) + writeBytes ||
+        OutputBufferLength < sizeof(TOUCH_TEST_BATCH_RESULT) + readBytes)
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto exit;
+    }
+
+    status = WdfRequestRetrieveOutputBuffer(
+        Request,
+        sizeof(TOUCH_TEST_BATCH_RESULT) + readBytes,
+        (PVOID) &result,
+        NULL);
+
+    if (!NT_SUCCESS(status))
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto exit;
+    }
+
+    //
+    // The transfers and the written bytes, each write led by its register
+    // address, go to non-paged memory the controller driver can use. The
+    // input shares the system buffer with the output so nothing may be
+    // read from it past this point.
+    //
+    if (transferCount != 0)
+    {
+        scratch = ExAllocatePoolWithTag(
+            NonPagedPoolNx,
+            transferCount * sizeof(SPB_BATCH_TRANSFER) + writeCount + writeBytes,
+            TOUCH_POOL_TAG);
+
+        if (scratch == NULL)
+        {
+            status = STATUS_INSUFFICIENT_RESOURCES;
+            goto exit;
+        }
+    }
+
+    transfers = (SPB_BATCH_TRANSFER*) scratch;
+    writeBuffer = scratch + transferCount * sizeof(SPB_BATCH_TRANSFER);
+    payload = (PUCHAR) (operations + operationCount);
+    readData = (PUCHAR) (result + 1);
+    pendingDelay = 0;
+    transferCount = 0;
+
+    for (i = 0; i < operationCount; i++)
+    {
+        if (operations[i].Operation == TOUCH_TEST_BATCH_OP_DELAY)
+        {
+            pendingDelay += operations[i].Length;
+            continue;
+        }
+
+        transfers[transferCount].DelayInUs = pendingDelay;
+        transfers[transferCount].Address = operations[i].Address;
+        pendingDelay = 0;
+
+        if (operations[i].Operation == TOUCH_TEST_BATCH_OP_READ)
+        {
+            transfers[transferCount].Type = SPB_BATCH_TRANSFER_READ;
+            transfers[transferCount].Buffer = readData;
+            transfers[transferCount].Length = operations[i].Length;
+
+            readData += operations[i].Length;
+        }
+        else
+        {
+            transfers[transferCount].Type = SPB_BATCH_TRANSFER_WRITE;
+            transfers[transferCount].Buffer = writeBuffer;
+            transfers[transferCount].Length = operations[i].Length + 1;
+
+            writeBuffer[0] = operations[i].Address;
+            RtlCopyMemory(writeBuffer + 1, payload, operations[i].Length);
+
+            writeBuffer += operations[i].Length + 1;
+            payload += operations[i].Length;
+        }
+
+        transferCount++;
+    }
+
+    status = SpbExecuteBatchSynchronously(
+        &DeviceContext->I2CContext,
+        transfers,
+        transferCount,
+        &completed);
+
+    //
+    // Trailing delays have no transfer to ride on
+    //
+    if (NT_SUCCESS(status) && pendingDelay != 0)
+    {
+        delay.QuadPart = -10 * (LONGLONG) pendingDelay;
+        KeDelayExecutionThread(KernelMode, FALSE, &delay);
+    }
+
+    readBytes = 0;
+
+    for (i = 0; i < completed; i++)
+    {
+        if (transfers[i].Type == SPB_BATCH_TRANSFER_READ)
+        {
+            readBytes += transfers[i].Length;
+        }
+    }
+
+    result->TransfersCompleted = completed;
+    result->Status = status;
+
+    WdfRequestSetInformation(Request, sizeof(TOUCH_TEST_BATCH_RESULT) + readBytes);
+
+    status = STATUS_SUCCESS;
+
+exit:
+
+    if (scratch != NULL)
+    {
+        ExFreePoolWithTag(scratch, TOUCH_POOL_TAG);
+    }
+
+    return status;
+}
+
 VOID 
 TchSelfTestOnCreate(
     IN WDFDEVICE Device,
@@ -312,6 +1164,66 @@ Return Value:
         STATUS_SUCCESS);
 }
 
+VOID
+TchSelfTestOnCleanup(
+    IN WDFFILEOBJECT FileObject
+    )
+/*++
+
+Routine Description:
+
+    This dispatch routine is invoked when the last handle of a test
+    session is closed. A stream started on it is ended so its ring can go
+    away with the session.
+
+Arguments:
+
+    FileObject - File object of the test session
+
+Return Value:
+
+    None
+
+--*/
+
+{
+    PDEVICE_EXTENSION devContext;
+    TOUCH_RAW_STREAM* stream;
+    WDFREQUEST request;
+
+    devContext = GetDeviceContext(WdfPdoGetParent(WdfFileObjectGetDevice(FileObject)));
+    stream = &devContext->RawStream;
+    request = NULL;
+
+    WdfSpinLockAcquire(stream->Lock);
+
+    //
+    // A request already being canceled is left to the cancel routine
+    //
+    if (stream->Request != NULL &&
+        stream->FileObject == FileObject &&
+        !stream->Canceled &&
+        WdfRequestUnmarkCancelable(stream->Request) != STATUS_CANCELLED)
+    {
+        if (stream->InUse)
+        {
+            stream->Canceled = TRUE;
+        }
+        else
+        {
+            request = stream->Request;
+            TchSelfTestDetachRawStream(stream);
+        }
+    }
+
+    WdfSpinLockRelease(stream->Lock);
+
+    if (request != NULL)
+    {
+        WdfRequestCompleteWithInformation(request, STATUS_CANCELLED, 0);
+    }
+}
+
 VOID 
 TchSelfTestOnClose(
     IN WDFFILEOBJECT FileObject
@@ -385,6 +1297,24 @@ Return Value:
 
     devContext = GetDeviceContext(Device);
 
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = Device;
+
+    status = WdfSpinLockCreate(
+        &objectAttributes,
+        &devContext->RawStream.Lock);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_INIT,
+            "Error creating raw stream lock - %!STATUS!",
+            status);
+
+        goto exit;
+    }
+
     //
     // Create a child test PDO, the touch device is the parent
     //
@@ -483,7 +1413,7 @@ Return Value:
         &fileConfig,
         TchSelfTestOnCreate,
         TchSelfTestOnClose,
-        WDF_NO_EVENT_CALLBACK);
+        TchSelfTestOnCleanup);
 
     WdfDeviceInitSetFileObjectConfig(
         deviceInit,
@@ -22,10 +22,72 @@
 #include <internal.h>
 #include <controller.h>
 #include "spb.h"
+
+//
+// The SpbCx interface header shares its name with spb.h above, reach
+// it through the kit include directory instead
+//
+#include <..\km\spb.h>
 #include <spb.tmh>
 
 #define I2C_VERBOSE_LOGGING 0
 
+//
+// Transfer list sent by an asynchronous read, together with the address
+// byte it points at since both must outlive the send
+//
+typedef struct _SPB_ASYNC_READ_SEQUENCE
+{
+    SPB_TRANSFER_LIST_AND_ENTRIES(2) Sequence;
+    UCHAR Address;
+} SPB_ASYNC_READ_SEQUENCE;
+
+EVT_WDF_REQUEST_COMPLETION_ROUTINE SpbAsyncReadCompletionRoutine;
+
+NTSTATUS
+SpbReuseRequest(
+    IN WDFREQUEST Request
+)
+/*++
+
+  Routine Description:
+
+    This helper routine returns one of the preallocated SPB requests to its
+    initial state so it can carry the next transfer. Callers must hold the
+    SPB lock, which serializes use of the requests.
+
+  Arguments:
+
+    Request - One of the requests owned by the SPB context
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    WDF_REQUEST_REUSE_PARAMS reuseParams;
+    NTSTATUS status;
+
+    WDF_REQUEST_REUSE_PARAMS_INIT(
+        &reuseParams,
+        WDF_REQUEST_REUSE_NO_FLAGS,
+        STATUS_SUCCESS);
+
+    status = WdfRequestReuse(Request, &reuseParams);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_SPB,
+            "Error reusing Spb request - 0x%08lX",
+            status);
+    }
+
+    return status;
+}
+
 NTSTATUS
 SpbDoWriteDataSynchronously(
     IN SPB_CONTEXT* SpbContext,
@@ -56,6 +118,7 @@ SpbDoWriteDataSynchronously(
     PUCHAR buffer;
     ULONG length;
     WDFMEMORY memory;
+    WDFMEMORY_OFFSET writeOffset;
     WDF_MEMORY_DESCRIPTOR memoryDescriptor;
     NTSTATUS status;
 
@@ -95,10 +158,13 @@ SpbDoWriteDataSynchronously(
     {
         buffer = (PUCHAR)WdfMemoryGetBuffer(SpbContext->WriteMemory, NULL);
 
-        WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
+        writeOffset.BufferOffset = 0;
+        writeOffset.BufferLength = length;
+
+        WDF_MEMORY_DESCRIPTOR_INIT_HANDLE(
             &memoryDescriptor,
-            (PVOID)buffer,
-            length);
+            SpbContext->WriteMemory,
+            &writeOffset);
     }
 
     //
@@ -121,9 +187,16 @@ SpbDoWriteDataSynchronously(
     DbgPrintEx(DPFLTR_IHVDRIVER_ID, DPFLTR_ERROR_LEVEL, "\n");
 #endif
 
+    status = SpbReuseRequest(SpbContext->WriteRequest);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
     status = WdfIoTargetSendWriteSynchronously(
         SpbContext->SpbIoTarget,
-        NULL,
+        SpbContext->WriteRequest,
         &memoryDescriptor,
         NULL,
         NULL,
@@ -150,25 +223,25 @@ exit:
 }
 
 NTSTATUS
-SpbWriteDataSynchronously(
+SpbDoReadDataSequence(
     IN SPB_CONTEXT* SpbContext,
     IN UCHAR Address,
-    IN PVOID Data,
+    _Out_writes_bytes_(Length) PVOID Buffer,
     IN ULONG Length
 )
 /*++
 
   Routine Description:
 
-    This routine abstracts creating and sending an I/O
-    request (I2C Write) to the Spb I/O target and utilizes
-    a helper routine to do work inside of locked code.
+    This helper routine sends the address write and the data read as a
+    single IOCTL_SPB_EXECUTE_SEQUENCE request, so the controller issues a
+    repeated start between them instead of a STOP and a second transfer.
 
   Arguments:
 
     SpbContext - Pointer to the current device context
-    Address    - The I2C register address to write to
-    Data       - A buffer to receive the data at at the above address
+    Address    - The I2C register address to read from
+    Buffer     - A non-paged buffer to receive the data
     Length     - The amount of data to be read from the above address
 
   Return Value:
@@ -177,40 +250,84 @@ SpbWriteDataSynchronously(
 
 --*/
 {
+    SPB_TRANSFER_LIST_AND_ENTRIES(2) sequence;
+    WDF_MEMORY_DESCRIPTOR memoryDescriptor;
+    PUCHAR addressBuffer;
+    ULONG_PTR bytesTransferred;
     NTSTATUS status;
 
-    WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
+    bytesTransferred = 0;
 
-    status = SpbDoWriteDataSynchronously(
-        SpbContext,
-        Address,
-        Data,
+    addressBuffer = (PUCHAR)WdfMemoryGetBuffer(SpbContext->WriteMemory, NULL);
+    *addressBuffer = Address;
+
+    SPB_TRANSFER_LIST_INIT(&(sequence.List), 2);
+
+    sequence.List.Transfers[0] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+        SpbTransferDirectionToDevice,
+        0,
+        addressBuffer,
+        sizeof(Address));
+
+    sequence.List.Transfers[1] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+        SpbTransferDirectionFromDevice,
+        0,
+        Buffer,
         Length);
 
-    WdfWaitLockRelease(SpbContext->SpbLock);
+    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
+        &memoryDescriptor,
+        (PVOID)&sequence,
+        sizeof(sequence));
+
+    status = SpbReuseRequest(SpbContext->ReadRequest);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    status = WdfIoTargetSendIoctlSynchronously(
+        SpbContext->SpbIoTarget,
+        SpbContext->ReadRequest,
+        IOCTL_SPB_EXECUTE_SEQUENCE,
+        &memoryDescriptor,
+        NULL,
+        NULL,
+        &bytesTransferred);
+
+    if (NT_SUCCESS(status) &&
+        bytesTransferred != sizeof(Address) + Length)
+    {
+        status = STATUS_DEVICE_PROTOCOL_ERROR;
+    }
+
+exit:
 
     return status;
 }
 
 NTSTATUS
-SpbReadDataSynchronously(
+SpbDoReadDataSynchronously(
     IN SPB_CONTEXT* SpbContext,
     IN UCHAR Address,
-    _In_reads_bytes_(Length) PVOID Data,
+    _Out_writes_bytes_(Length) PVOID Buffer,
     IN ULONG Length
 )
 /*++
 
   Routine Description:
 
-    This helper routine abstracts creating and sending an I/O
-    request (I2C Read) to the Spb I/O target.
+    This helper routine reads from the Spb I/O target into a non-paged
+    buffer. The combined write-read sequence is used unless the controller
+    driver has already rejected it, in which case the address pointer is
+    written and the data read as two separate transfers.
 
   Arguments:
 
     SpbContext - Pointer to the current device context
     Address    - The I2C register address to read from
-    Data       - A buffer to receive the data at at the above address
+    Buffer     - A non-paged buffer to receive the data
     Length     - The amount of data to be read from the above address
 
   Return Value:
@@ -219,18 +336,45 @@ SpbReadDataSynchronously(
 
 --*/
 {
-    PUCHAR buffer;
-    WDFMEMORY memory;
     WDF_MEMORY_DESCRIPTOR memoryDescriptor;
     NTSTATUS status;
     ULONG_PTR bytesRead;
 
-    WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
-
-    memory = NULL;
-    status = STATUS_INVALID_PARAMETER;
     bytesRead = 0;
 
+    if (SpbContext->SequenceSupported)
+    {
+        status = SpbDoReadDataSequence(
+            SpbContext,
+            Address,
+            Buffer,
+            Length);
+
+        if (status != STATUS_NOT_SUPPORTED &&
+            status != STATUS_NOT_IMPLEMENTED &&
+            status != STATUS_INVALID_DEVICE_REQUEST)
+        {
+            if (!NT_SUCCESS(status))
+            {
+                Trace(
+                    TRACE_LEVEL_ERROR,
+                    TRACE_SPB,
+                    "Error executing Spb read sequence - 0x%08lX",
+                    status);
+            }
+
+            goto exit;
+        }
+
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_SPB,
+            "Spb controller rejected read sequence, using separate transfers - 0x%08lX",
+            status);
+
+        SpbContext->SequenceSupported = FALSE;
+    }
+
     //
     // Read transactions start by writing an address pointer
     //
@@ -250,45 +394,21 @@ SpbReadDataSynchronously(
         goto exit;
     }
 
-    if (Length > DEFAULT_SPB_BUFFER_SIZE)
-    {
-        status = WdfMemoryCreate(
-            WDF_NO_OBJECT_ATTRIBUTES,
-            NonPagedPool,
-            TOUCH_POOL_TAG,
-            Length,
-            &memory,
-            &buffer);
+    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
+        &memoryDescriptor,
+        Buffer,
+        Length);
 
-        if (!NT_SUCCESS(status))
-        {
-            Trace(
-                TRACE_LEVEL_ERROR,
-                TRACE_SPB,
-                "Error allocating memory for Spb read - 0x%08lX",
-                status);
-            goto exit;
-        }
+    status = SpbReuseRequest(SpbContext->ReadRequest);
 
-        WDF_MEMORY_DESCRIPTOR_INIT_HANDLE(
-            &memoryDescriptor,
-            memory,
-            NULL);
-    }
-    else
+    if (!NT_SUCCESS(status))
     {
-        buffer = (PUCHAR)WdfMemoryGetBuffer(SpbContext->ReadMemory, NULL);
-
-        WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
-            &memoryDescriptor,
-            (PVOID)buffer,
-            Length);
+        goto exit;
     }
 
-
     status = WdfIoTargetSendReadSynchronously(
         SpbContext->SpbIoTarget,
-        NULL,
+        SpbContext->ReadRequest,
         &memoryDescriptor,
         NULL,
         NULL,
@@ -302,52 +422,41 @@ SpbReadDataSynchronously(
             TRACE_SPB,
             "Error reading from Spb - 0x%08lX",
             status);
-        goto exit;
-    }
-
-#if I2C_VERBOSE_LOGGING
-    DbgPrintEx(DPFLTR_IHVDRIVER_ID, DPFLTR_ERROR_LEVEL, "I2CREAD: LENGTH=%d", Length);
-    for (ULONG j = 0; j < Length; j++)
-    {
-        UCHAR byte = *(buffer + j);
-        DbgPrintEx(DPFLTR_IHVDRIVER_ID, DPFLTR_ERROR_LEVEL, " %02hhX", byte);
-    }
-    DbgPrintEx(DPFLTR_IHVDRIVER_ID, DPFLTR_ERROR_LEVEL, "\n");
-#endif
 
-    //
-    // Copy back to the caller's buffer
-    //
-    RtlCopyMemory(Data, buffer, Length);
+        if (NT_SUCCESS(status))
+        {
+            status = STATUS_DEVICE_PROTOCOL_ERROR;
+        }
 
-exit:
-    if (NULL != memory)
-    {
-        WdfObjectDelete(memory);
+        goto exit;
     }
 
-    WdfWaitLockRelease(SpbContext->SpbLock);
+exit:
 
     return status;
 }
 
-VOID
-SpbTargetDeinitialize(
-    IN WDFDEVICE FxDevice,
-    IN SPB_CONTEXT* SpbContext
+NTSTATUS
+SpbWriteDataSynchronously(
+    IN SPB_CONTEXT* SpbContext,
+    IN UCHAR Address,
+    IN PVOID Data,
+    IN ULONG Length
 )
 /*++
 
   Routine Description:
 
-    This helper routine is used to free any members added to the SPB_CONTEXT,
-    note the SPB I/O target is parented to the device and will be
-    closed and free'd when the device is removed.
+    This routine abstracts creating and sending an I/O
+    request (I2C Write) to the Spb I/O target and utilizes
+    a helper routine to do work inside of locked code.
 
   Arguments:
 
-    FxDevice   - Handle to the framework device object
     SpbContext - Pointer to the current device context
+    Address    - The I2C register address to write to
+    Data       - A buffer to receive the data at at the above address
+    Length     - The amount of data to be read from the above address
 
   Return Value:
 
@@ -355,45 +464,42 @@ SpbTargetDeinitialize(
 
 --*/
 {
-    UNREFERENCED_PARAMETER(FxDevice);
-    UNREFERENCED_PARAMETER(SpbContext);
+    NTSTATUS status;
 
-    //
-    // Free any SPB_CONTEXT allocations here
-    //
-    if (SpbContext->SpbLock != NULL)
-    {
-        WdfObjectDelete(SpbContext->SpbLock);
-    }
+    WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
 
-    if (SpbContext->ReadMemory != NULL)
-    {
-        WdfObjectDelete(SpbContext->ReadMemory);
-    }
+    status = SpbDoWriteDataSynchronously(
+        SpbContext,
+        Address,
+        Data,
+        Length);
 
-    if (SpbContext->WriteMemory != NULL)
-    {
-        WdfObjectDelete(SpbContext->WriteMemory);
-    }
+    WdfWaitLockRelease(SpbContext->SpbLock);
+
+    return status;
 }
 
 NTSTATUS
-SpbTargetInitialize(
-    IN WDFDEVICE FxDevice,
-    IN SPB_CONTEXT* SpbContext
+SpbWriteRegistersSynchronously(
+    IN SPB_CONTEXT* SpbContext,
+    IN const SPB_REGISTER_WRITE* Writes,
+    IN ULONG Count
 )
 /*++
 
   Routine Description:
 
-    This helper routine opens the Spb I/O target and
-    initializes a request object used for the lifetime
-    of communication between this driver and Spb.
+    This routine writes a list of single byte registers. They are sent as
+    one IOCTL_SPB_EXECUTE_SEQUENCE request, one write transfer each, so the
+    whole list costs a single round trip to the controller driver. If the
+    controller driver rejects sequences the registers are written one by
+    one instead.
 
   Arguments:
 
-    FxDevice   - Handle to the framework device object
     SpbContext - Pointer to the current device context
+    Writes     - Register addresses and the values to write to them
+    Count      - Number of entries in Writes, at most SPB_MAX_REGISTER_WRITES
 
   Return Value:
 
@@ -401,46 +507,914 @@ SpbTargetInitialize(
 
 --*/
 {
-    WDF_OBJECT_ATTRIBUTES objectAttributes;
-    WDF_IO_TARGET_OPEN_PARAMS openParams;
-    UNICODE_STRING spbDeviceName;
-    WCHAR spbDeviceNameBuffer[RESOURCE_HUB_PATH_SIZE];
+    SPB_TRANSFER_LIST_AND_ENTRIES(SPB_MAX_REGISTER_WRITES) sequence;
+    WDF_MEMORY_DESCRIPTOR memoryDescriptor;
+    PUCHAR buffer;
+    ULONG_PTR bytesTransferred;
     NTSTATUS status;
+    ULONG i;
 
-    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
-    objectAttributes.ParentObject = FxDevice;
-
-    status = WdfIoTargetCreate(
-        FxDevice,
-        &objectAttributes,
-        &SpbContext->SpbIoTarget);
+    C_ASSERT(SPB_MAX_REGISTER_WRITES * sizeof(SPB_REGISTER_WRITE) <= DEFAULT_SPB_BUFFER_SIZE);
 
-    if (!NT_SUCCESS(status))
+    if (Count == 0)
     {
-        Trace(
-            TRACE_LEVEL_ERROR,
-            TRACE_SPB,
-            "Error creating IoTarget object - 0x%08lX",
-            status);
-
-        WdfObjectDelete(SpbContext->SpbIoTarget);
-        goto exit;
+        return STATUS_SUCCESS;
     }
 
-    RtlInitEmptyUnicodeString(
-        &spbDeviceName,
-        spbDeviceNameBuffer,
-        sizeof(spbDeviceNameBuffer));
+    if (Count > SPB_MAX_REGISTER_WRITES)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
 
-    status = RESOURCE_HUB_CREATE_PATH_FROM_ID(
-        &spbDeviceName,
-        SpbContext->I2cResHubId.LowPart,
-        SpbContext->I2cResHubId.HighPart);
+    WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
 
-    if (!NT_SUCCESS(status))
+    if (SpbContext->SequenceSupported)
     {
-        Trace(
-            TRACE_LEVEL_ERROR,
+        bytesTransferred = 0;
+
+        //
+        // The transfers point into the preallocated non-paged write buffer,
+        // each entry being the address byte followed by the value
+        //
+        buffer = (PUCHAR)WdfMemoryGetBuffer(SpbContext->WriteMemory, NULL);
+        RtlCopyMemory(buffer, Writes, Count * sizeof(SPB_REGISTER_WRITE));
+
+        SPB_TRANSFER_LIST_INIT(&(sequence.List), Count);
+
+        for (i = 0; i < Count; i++)
+        {
+            sequence.List.Transfers[i] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+                SpbTransferDirectionToDevice,
+                0,
+                buffer + i * sizeof(SPB_REGISTER_WRITE),
+                sizeof(SPB_REGISTER_WRITE));
+        }
+
+        WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
+            &memoryDescriptor,
+            (PVOID)&sequence,
+            FIELD_OFFSET(SPB_TRANSFER_LIST, Transfers[Count]));
+
+        status = SpbReuseRequest(SpbContext->WriteRequest);
+
+        if (!NT_SUCCESS(status))
+        {
+            goto exit;
+        }
+
+        status = WdfIoTargetSendIoctlSynchronously(
+            SpbContext->SpbIoTarget,
+            SpbContext->WriteRequest,
+            IOCTL_SPB_EXECUTE_SEQUENCE,
+            &memoryDescriptor,
+            NULL,
+            NULL,
+            &bytesTransferred);
+
+        if (NT_SUCCESS(status) &&
+            bytesTransferred != Count * sizeof(SPB_REGISTER_WRITE))
+        {
+            status = STATUS_DEVICE_PROTOCOL_ERROR;
+        }
+
+        if (status != STATUS_NOT_SUPPORTED &&
+            status != STATUS_NOT_IMPLEMENTED &&
+            status != STATUS_INVALID_DEVICE_REQUEST)
+        {
+            if (!NT_SUCCESS(status))
+            {
+                Trace(
+                    TRACE_LEVEL_ERROR,
+                    TRACE_SPB,
+                    "Error executing Spb write sequence - 0x%08lX",
+                    status);
+            }
+
+            goto exit;
+        }
+
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_SPB,
+            "Spb controller rejected write sequence, using separate transfers - 0x%08lX",
+            status);
+
+        SpbContext->SequenceSupported = FALSE;
+    }
+
+    status = STATUS_SUCCESS;
+
+    for (i = 0; i < Count; i++)
+    {
+        status = SpbDoWriteDataSynchronously(
+            SpbContext,
+            Writes[i].Address,
+            (PVOID)&Writes[i].Value,
+            sizeof(Writes[i].Value));
+
+        if (!NT_SUCCESS(status))
+        {
+            goto exit;
+        }
+    }
+
+exit:
+
+    WdfWaitLockRelease(SpbContext->SpbLock);
+
+    return status;
+}
+
+NTSTATUS
+SpbExecuteBatchSynchronously(
+    IN SPB_CONTEXT* SpbContext,
+    IN SPB_BATCH_TRANSFER* Transfers,
+    IN ULONG Count,
+    OUT ULONG* Completed
+)
+/*++
+
+  Routine Description:
+
+    This routine runs a list of register reads and writes under a single
+    acquisition of the SPB lock. They are sent as one
+    IOCTL_SPB_EXECUTE_SEQUENCE request, with the delay of each transfer
+    taken by the controller before it. If the controller driver rejects
+    the sequence the transfers are sent one by one instead.
+
+  Arguments:
+
+    SpbContext - Pointer to the current device context
+    Transfers  - Non-paged list of transfers, see SPB_BATCH_TRANSFER
+    Count      - Number of entries in Transfers, at most SPB_MAX_BATCH_TRANSFERS
+    Completed  - Receives the number of transfers that went through, all
+                 or none of them when sent as a sequence
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    PSPB_TRANSFER_LIST sequence;
+    WDF_MEMORY_DESCRIPTOR memoryDescriptor;
+    LARGE_INTEGER delay;
+    ULONG_PTR bytesExpected;
+    ULONG_PTR bytesTransferred;
+    ULONG entries;
+    ULONG entry;
+    NTSTATUS status;
+    ULONG i;
+
+    *Completed = 0;
+    sequence = NULL;
+    status = STATUS_SUCCESS;
+
+    if (Count == 0)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    if (Count > SPB_MAX_BATCH_TRANSFERS)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    entries = 0;
+
+    for (i = 0; i < Count; i++)
+    {
+        if (Transfers[i].Buffer == NULL ||
+            Transfers[i].Length == 0 ||
+            (Transfers[i].Type != SPB_BATCH_TRANSFER_READ &&
+             Transfers[i].Type != SPB_BATCH_TRANSFER_WRITE))
+        {
+            return STATUS_INVALID_PARAMETER;
+        }
+
+        //
+        // A read is the address write followed by the data read
+        //
+        entries += (Transfers[i].Type == SPB_BATCH_TRANSFER_READ) ? 2 : 1;
+    }
+
+    WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
+
+    if (SpbContext->SequenceSupported)
+    {
+        sequence = ExAllocatePoolWithTag(
+            NonPagedPoolNx,
+            FIELD_OFFSET(SPB_TRANSFER_LIST, Transfers[entries]),
+            TOUCH_POOL_TAG);
+
+        if (sequence == NULL)
+        {
+            status = STATUS_INSUFFICIENT_RESOURCES;
+            goto exit;
+        }
+
+        SPB_TRANSFER_LIST_INIT(sequence, entries);
+
+        bytesExpected = 0;
+        bytesTransferred = 0;
+        entry = 0;
+
+        for (i = 0; i < Count; i++)
+        {
+            if (Transfers[i].Type == SPB_BATCH_TRANSFER_READ)
+            {
+                sequence->Transfers[entry++] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+                    SpbTransferDirectionToDevice,
+                    Transfers[i].DelayInUs,
+                    &Transfers[i].Address,
+                    sizeof(Transfers[i].Address));
+
+                sequence->Transfers[entry++] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+                    SpbTransferDirectionFromDevice,
+                    0,
+                    Transfers[i].Buffer,
+                    Transfers[i].Length);
+
+                bytesExpected += sizeof(Transfers[i].Address) + Transfers[i].Length;
+            }
+            else
+            {
+                sequence->Transfers[entry++] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+                    SpbTransferDirectionToDevice,
+                    Transfers[i].DelayInUs,
+                    Transfers[i].Buffer,
+                    Transfers[i].Length);
+
+                bytesExpected += Transfers[i].Length;
+            }
+        }
+
+        WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
+            &memoryDescriptor,
+            (PVOID)sequence,
+            FIELD_OFFSET(SPB_TRANSFER_LIST, Transfers[entries]));
+
+        status = SpbReuseRequest(SpbContext->WriteRequest);
+
+        if (!NT_SUCCESS(status))
+        {
+            goto exit;
+        }
+
+        status = WdfIoTargetSendIoctlSynchronously(
+            SpbContext->SpbIoTarget,
+            SpbContext->WriteRequest,
+            IOCTL_SPB_EXECUTE_SEQUENCE,
+            &memoryDescriptor,
+            NULL,
+            NULL,
+            &bytesTransferred);
+
+        if (NT_SUCCESS(status) &&
+            bytesTransferred != bytesExpected)
+        {
+            status = STATUS_DEVICE_PROTOCOL_ERROR;
+        }
+
+        if (status != STATUS_NOT_SUPPORTED &&
+            status != STATUS_NOT_IMPLEMENTED &&
+            status != STATUS_INVALID_DEVICE_REQUEST)
+        {
+            if (NT_SUCCESS(status))
+            {
+                *Completed = Count;
+            }
+            else
+            {
+                Trace(
+                    TRACE_LEVEL_ERROR,
+                    TRACE_SPB,
+                    "Error executing Spb batch sequence - 0x%08lX",
+                    status);
+            }
+
+            goto exit;
+        }
+
+        //
+        // A controller may only refuse sequences this long, so the short
+        // sequences of the reporting path are left enabled
+        //
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_SPB,
+            "Spb controller rejected batch sequence, using separate transfers - 0x%08lX",
+            status);
+    }
+
+    for (i = 0; i < Count; i++)
+    {
+        if (Transfers[i].DelayInUs != 0)
+        {
+            delay.QuadPart = -10 * (LONGLONG)Transfers[i].DelayInUs;
+            KeDelayExecutionThread(KernelMode, FALSE, &delay);
+        }
+
+        if (Transfers[i].Type == SPB_BATCH_TRANSFER_READ)
+        {
+            status = SpbDoReadDataSynchronously(
+                SpbContext,
+                Transfers[i].Address,
+                Transfers[i].Buffer,
+                Transfers[i].Length);
+        }
+        else
+        {
+            status = SpbDoWriteDataSynchronously(
+                SpbContext,
+                Transfers[i].Buffer[0],
+                Transfers[i].Buffer + 1,
+                Transfers[i].Length - 1);
+        }
+
+        if (!NT_SUCCESS(status))
+        {
+            goto exit;
+        }
+
+        (*Completed)++;
+    }
+
+exit:
+
+    WdfWaitLockRelease(SpbContext->SpbLock);
+
+    if (sequence != NULL)
+    {
+        ExFreePoolWithTag(sequence, TOUCH_POOL_TAG);
+    }
+
+    return status;
+}
+
+NTSTATUS
+SpbReadDataSynchronously(
+    IN SPB_CONTEXT* SpbContext,
+    IN UCHAR Address,
+    _In_reads_bytes_(Length) PVOID Data,
+    IN ULONG Length
+)
+/*++
+
+  Routine Description:
+
+    This helper routine abstracts creating and sending an I/O
+    request (I2C Read) to the Spb I/O target.
+
+  Arguments:
+
+    SpbContext - Pointer to the current device context
+    Address    - The I2C register address to read from
+    Data       - A buffer to receive the data at at the above address
+    Length     - The amount of data to be read from the above address
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    PUCHAR buffer;
+    WDFMEMORY memory;
+    NTSTATUS status;
+
+    WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
+
+    memory = NULL;
+    status = STATUS_INVALID_PARAMETER;
+
+    if (Length > DEFAULT_SPB_BUFFER_SIZE)
+    {
+        status = WdfMemoryCreate(
+            WDF_NO_OBJECT_ATTRIBUTES,
+            NonPagedPool,
+            TOUCH_POOL_TAG,
+            Length,
+            &memory,
+            &buffer);
+
+        if (!NT_SUCCESS(status))
+        {
+            Trace(
+                TRACE_LEVEL_ERROR,
+                TRACE_SPB,
+                "Error allocating memory for Spb read - 0x%08lX",
+                status);
+            goto exit;
+        }
+    }
+    else
+    {
+        buffer = (PUCHAR)WdfMemoryGetBuffer(SpbContext->ReadMemory, NULL);
+    }
+
+    status = SpbDoReadDataSynchronously(
+        SpbContext,
+        Address,
+        buffer,
+        Length);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+#if I2C_VERBOSE_LOGGING
+    DbgPrintEx(DPFLTR_IHVDRIVER_ID, DPFLTR_ERROR_LEVEL, "I2CREAD: LENGTH=%d", Length);
+    for (ULONG j = 0; j < Length; j++)
+    {
+        UCHAR byte = *(buffer + j);
+        DbgPrintEx(DPFLTR_IHVDRIVER_ID, DPFLTR_ERROR_LEVEL, " %02hhX", byte);
+    }
+    DbgPrintEx(DPFLTR_IHVDRIVER_ID, DPFLTR_ERROR_LEVEL, "\n");
+#endif
+
+    //
+    // Copy back to the caller's buffer
+    //
+    RtlCopyMemory(Data, buffer, Length);
+
+exit:
+    if (NULL != memory)
+    {
+        WdfObjectDelete(memory);
+    }
+
+    WdfWaitLockRelease(SpbContext->SpbLock);
+
+    return status;
+}
+
+NTSTATUS
+SpbReadDataDirectSynchronously(
+    IN SPB_CONTEXT* SpbContext,
+    IN UCHAR Address,
+    _Out_writes_bytes_(Length) PVOID Data,
+    IN ULONG Length
+)
+/*++
+
+  Routine Description:
+
+    This routine reads from the Spb I/O target straight into the caller's
+    buffer, skipping the default read buffer and the copy out of it. The
+    caller's buffer must be non-paged and stay valid for the duration of
+    the call.
+
+  Arguments:
+
+    SpbContext - Pointer to the current device context
+    Address    - The I2C register address to read from
+    Data       - A non-paged buffer to receive the data
+    Length     - The amount of data to be read from the above address
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    NTSTATUS status;
+
+    WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
+
+    status = SpbDoReadDataSynchronously(
+        SpbContext,
+        Address,
+        Data,
+        Length);
+
+    WdfWaitLockRelease(SpbContext->SpbLock);
+
+    return status;
+}
+
+VOID
+SpbAsyncReadCompletionRoutine(
+    IN WDFREQUEST Request,
+    IN WDFIOTARGET Target,
+    IN PWDF_REQUEST_COMPLETION_PARAMS Params,
+    IN WDFCONTEXT Context
+)
+/*++
+
+  Routine Description:
+
+    Completion routine for asynchronous reads, runs at IRQL <= DISPATCH_LEVEL
+    and hands the result to the owner of the read.
+
+  Arguments:
+
+    Request - The request that completed
+    Target  - The Spb I/O target
+    Params  - Completion parameters of the request
+    Context - The SPB_ASYNC_READ the request belongs to
+
+  Return Value:
+
+    None
+
+--*/
+{
+    SPB_ASYNC_READ* asyncRead;
+    NTSTATUS status;
+
+    UNREFERENCED_PARAMETER(Request);
+    UNREFERENCED_PARAMETER(Target);
+
+    asyncRead = (SPB_ASYNC_READ*)Context;
+    status = Params->IoStatus.Status;
+
+    if (status == STATUS_NOT_SUPPORTED ||
+        status == STATUS_NOT_IMPLEMENTED ||
+        status == STATUS_INVALID_DEVICE_REQUEST)
+    {
+        asyncRead->SpbContext->SequenceSupported = FALSE;
+    }
+    else if (NT_SUCCESS(status) &&
+        Params->IoStatus.Information != sizeof(UCHAR) + asyncRead->Length)
+    {
+        status = STATUS_DEVICE_PROTOCOL_ERROR;
+    }
+
+    asyncRead->Completion(asyncRead, status, asyncRead->Context);
+}
+
+NTSTATUS
+SpbReadDataAsynchronously(
+    IN SPB_ASYNC_READ* AsyncRead,
+    IN UCHAR Address
+)
+/*++
+
+  Routine Description:
+
+    This routine starts a combined write-read sequence into the buffer bound
+    to the asynchronous read and returns without waiting for it. The
+    completion callback is invoked only if this routine returns success.
+    Asynchronous reads require sequence support from the controller driver,
+    as a separate address write could interleave with other transfers.
+
+  Arguments:
+
+    AsyncRead - An idle asynchronous read set up with SpbAsyncReadInitialize
+    Address   - The I2C register address to read from
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    SPB_ASYNC_READ_SEQUENCE* sequence;
+    WDFMEMORY_OFFSET sequenceOffset;
+    SPB_CONTEXT* spbContext;
+    NTSTATUS status;
+
+    spbContext = AsyncRead->SpbContext;
+
+    if (!spbContext->SequenceSupported)
+    {
+        status = STATUS_NOT_SUPPORTED;
+        goto exit;
+    }
+
+    sequence = (SPB_ASYNC_READ_SEQUENCE*)WdfMemoryGetBuffer(
+        AsyncRead->SequenceMemory,
+        NULL);
+
+    sequence->Address = Address;
+
+    sequenceOffset.BufferOffset = 0;
+    sequenceOffset.BufferLength = sizeof(sequence->Sequence);
+
+    status = SpbReuseRequest(AsyncRead->Request);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    status = WdfIoTargetFormatRequestForIoctl(
+        spbContext->SpbIoTarget,
+        AsyncRead->Request,
+        IOCTL_SPB_EXECUTE_SEQUENCE,
+        AsyncRead->SequenceMemory,
+        &sequenceOffset,
+        NULL,
+        NULL);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_SPB,
+            "Error formatting Spb async read - 0x%08lX",
+            status);
+        goto exit;
+    }
+
+    WdfRequestSetCompletionRoutine(
+        AsyncRead->Request,
+        SpbAsyncReadCompletionRoutine,
+        AsyncRead);
+
+    if (WdfRequestSend(
+        AsyncRead->Request,
+        spbContext->SpbIoTarget,
+        WDF_NO_SEND_OPTIONS) == FALSE)
+    {
+        status = WdfRequestGetStatus(AsyncRead->Request);
+
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_SPB,
+            "Error sending Spb async read - 0x%08lX",
+            status);
+        goto exit;
+    }
+
+exit:
+
+    return status;
+}
+
+VOID
+SpbAsyncReadDeinitialize(
+    IN SPB_ASYNC_READ* AsyncRead
+)
+/*++
+
+  Routine Description:
+
+    This routine frees the objects owned by an asynchronous read, which
+    must not be in flight.
+
+  Arguments:
+
+    AsyncRead - The asynchronous read to tear down
+
+  Return Value:
+
+    None
+
+--*/
+{
+    if (AsyncRead->SequenceMemory != NULL)
+    {
+        WdfObjectDelete(AsyncRead->SequenceMemory);
+        AsyncRead->SequenceMemory = NULL;
+    }
+
+    if (AsyncRead->Request != NULL)
+    {
+        WdfObjectDelete(AsyncRead->Request);
+        AsyncRead->Request = NULL;
+    }
+}
+
+NTSTATUS
+SpbAsyncReadInitialize(
+    IN WDFDEVICE FxDevice,
+    IN SPB_CONTEXT* SpbContext,
+    IN SPB_ASYNC_READ* AsyncRead,
+    IN PVOID Buffer,
+    IN ULONG Length,
+    IN PFN_SPB_ASYNC_READ_COMPLETION Completion,
+    IN PVOID Context
+)
+/*++
+
+  Routine Description:
+
+    This routine creates the request and transfer list of an asynchronous
+    read and binds it to a fixed non-paged destination buffer.
+
+  Arguments:
+
+    FxDevice   - Handle to the framework device object
+    SpbContext - Pointer to the current device context
+    AsyncRead  - The asynchronous read to set up
+    Buffer     - Non-paged buffer every read of this instance fills
+    Length     - Number of bytes to read
+    Completion - Callback invoked when a read completes
+    Context    - Context passed to the callback
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    SPB_ASYNC_READ_SEQUENCE* sequence;
+    NTSTATUS status;
+
+    RtlZeroMemory(AsyncRead, sizeof(SPB_ASYNC_READ));
+
+    AsyncRead->SpbContext = SpbContext;
+    AsyncRead->Buffer = Buffer;
+    AsyncRead->Length = Length;
+    AsyncRead->Completion = Completion;
+    AsyncRead->Context = Context;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = FxDevice;
+
+    status = WdfRequestCreate(
+        &objectAttributes,
+        SpbContext->SpbIoTarget,
+        &AsyncRead->Request);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_SPB,
+            "Error creating Spb async read request - 0x%08lX",
+            status);
+        goto exit;
+    }
+
+    status = WdfMemoryCreate(
+        &objectAttributes,
+        NonPagedPoolNx,
+        TOUCH_POOL_TAG,
+        sizeof(SPB_ASYNC_READ_SEQUENCE),
+        &AsyncRead->SequenceMemory,
+        (PVOID*)&sequence);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_SPB,
+            "Error allocating Spb async read sequence - 0x%08lX",
+            status);
+        goto exit;
+    }
+
+    //
+    // The transfer list never changes, only the address byte it points
+    // at is updated per read
+    //
+    SPB_TRANSFER_LIST_INIT(&(sequence->Sequence.List), 2);
+
+    sequence->Sequence.List.Transfers[0] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+        SpbTransferDirectionToDevice,
+        0,
+        &sequence->Address,
+        sizeof(sequence->Address));
+
+    sequence->Sequence.List.Transfers[1] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+        SpbTransferDirectionFromDevice,
+        0,
+        Buffer,
+        Length);
+
+exit:
+
+    if (!NT_SUCCESS(status))
+    {
+        SpbAsyncReadDeinitialize(AsyncRead);
+    }
+
+    return status;
+}
+
+VOID
+SpbTargetDeinitialize(
+    IN WDFDEVICE FxDevice,
+    IN SPB_CONTEXT* SpbContext
+)
+/*++
+
+  Routine Description:
+
+    This helper routine is used to free any members added to the SPB_CONTEXT,
+    note the SPB I/O target is parented to the device and will be
+    closed and free'd when the device is removed.
+
+  Arguments:
+
+    FxDevice   - Handle to the framework device object
+    SpbContext - Pointer to the current device context
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    UNREFERENCED_PARAMETER(FxDevice);
+    UNREFERENCED_PARAMETER(SpbContext);
+
+    //
+    // Free any SPB_CONTEXT allocations here
+    //
+    if (SpbContext->ReadRequest != NULL)
+    {
+        WdfObjectDelete(SpbContext->ReadRequest);
+        SpbContext->ReadRequest = NULL;
+    }
+
+    if (SpbContext->WriteRequest != NULL)
+    {
+        WdfObjectDelete(SpbContext->WriteRequest);
+        SpbContext->WriteRequest = NULL;
+    }
+
+    if (SpbContext->SpbLock != NULL)
+    {
+        WdfObjectDelete(SpbContext->SpbLock);
+    }
+
+    if (SpbContext->ReadMemory != NULL)
+    {
+        WdfObjectDelete(SpbContext->ReadMemory);
+    }
+
+    if (SpbContext->WriteMemory != NULL)
+    {
+        WdfObjectDelete(SpbContext->WriteMemory);
+    }
+}
+
+NTSTATUS
+SpbTargetInitialize(
+    IN WDFDEVICE FxDevice,
+    IN SPB_CONTEXT* SpbContext
+)
+/*++
+
+  Routine Description:
+
+    This helper routine opens the Spb I/O target and
+    initializes a request object used for the lifetime
+    of communication between this driver and Spb.
+
+  Arguments:
+
+    FxDevice   - Handle to the framework device object
+    SpbContext - Pointer to the current device context
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    WDF_OBJECT_ATTRIBUTES objectAttributes;
+    WDF_IO_TARGET_OPEN_PARAMS openParams;
+    UNICODE_STRING spbDeviceName;
+    WCHAR spbDeviceNameBuffer[RESOURCE_HUB_PATH_SIZE];
+    NTSTATUS status;
+
+    //
+    // Assume the controller driver handles combined sequences until
+    // it tells us otherwise
+    //
+    SpbContext->SequenceSupported = TRUE;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = FxDevice;
+
+    status = WdfIoTargetCreate(
+        FxDevice,
+        &objectAttributes,
+        &SpbContext->SpbIoTarget);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_SPB,
+            "Error creating IoTarget object - 0x%08lX",
+            status);
+
+        WdfObjectDelete(SpbContext->SpbIoTarget);
+        goto exit;
+    }
+
+    RtlInitEmptyUnicodeString(
+        &spbDeviceName,
+        spbDeviceNameBuffer,
+        sizeof(spbDeviceNameBuffer));
+
+    status = RESOURCE_HUB_CREATE_PATH_FROM_ID(
+        &spbDeviceName,
+        SpbContext->I2cResHubId.LowPart,
+        SpbContext->I2cResHubId.HighPart);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
             TRACE_SPB,
             "Error creating Spb resource hub path string - 0x%08lX",
             status);
@@ -468,6 +1442,44 @@ SpbTargetInitialize(
         goto exit;
     }
 
+    //
+    // Create the requests used for every transfer up front, so the hot
+    // path only recycles them instead of having the framework allocate
+    // a request per transfer
+    //
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
+    objectAttributes.ParentObject = FxDevice;
+
+    status = WdfRequestCreate(
+        &objectAttributes,
+        SpbContext->SpbIoTarget,
+        &SpbContext->WriteRequest);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_SPB,
+            "Error creating Spb write request - 0x%08lX",
+            status);
+        goto exit;
+    }
+
+    status = WdfRequestCreate(
+        &objectAttributes,
+        SpbContext->SpbIoTarget,
+        &SpbContext->ReadRequest);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_SPB,
+            "Error creating Spb read request - 0x%08lX",
+            status);
+        goto exit;
+    }
+
     //
     // Allocate some fixed-size buffers from NonPagedPool for typical
     // Spb transaction sizes to avoid pool fragmentation in most cases
@@ -137,7 +137,7 @@ PowerIoRegPnPNotification(
         status = WdfIoTargetCreate(
             deviceContext->FxDevice,
             WDF_NO_OBJECT_ATTRIBUTES,
-            &deviceContext->TouchPowerContext.TouchPowerIOTarget
+            &deviceContext->Configuration.TouchPowerContext.TouchPowerIOTarget
         );
 
         if (!NT_SUCCESS(status))
@@ -148,13 +148,13 @@ PowerIoRegPnPNotification(
                 "PowerIoRegPnPNotification: Creating IO Target to Touch Power driver failed"
             );
 
-            deviceContext->TouchPowerContext.TouchPowerOpen = FALSE;
+            deviceContext->Configuration.TouchPowerContext.TouchPowerOpen = FALSE;
             goto exit;
         }
 
         WDF_IO_TARGET_OPEN_PARAMS_INIT_OPEN_BY_NAME(&openParams, NotificationStruct->SymbolicLinkName, STANDARD_RIGHTS_ALL);
 
-        status = WdfIoTargetOpen(deviceContext->TouchPowerContext.TouchPowerIOTarget, &openParams);
+        status = WdfIoTargetOpen(deviceContext->Configuration.TouchPowerContext.TouchPowerIOTarget, &openParams);
         if (!NT_SUCCESS(status))
         {
             Trace(
@@ -163,16 +163,16 @@ PowerIoRegPnPNotification(
                 "PowerIoRegPnPNotification: Opening IO Target to Touch Power driver failed"
             );
 
-            deviceContext->TouchPowerContext.TouchPowerOpen = FALSE;
+            deviceContext->Configuration.TouchPowerContext.TouchPowerOpen = FALSE;
             goto exit;
         }
 
-        deviceContext->TouchPowerContext.TouchPowerOpen = TRUE;
+        deviceContext->Configuration.TouchPowerContext.TouchPowerOpen = TRUE;
     }
     else
     {
-        WdfIoTargetClose(deviceContext->TouchPowerContext.TouchPowerIOTarget);
-        deviceContext->TouchPowerContext.TouchPowerOpen = FALSE;
+        WdfIoTargetClose(deviceContext->Configuration.TouchPowerContext.TouchPowerIOTarget);
+        deviceContext->Configuration.TouchPowerContext.TouchPowerOpen = FALSE;
     }
 
 exit:
@@ -206,7 +206,7 @@ PowerInitialize(
         WdfDriverWdmGetDriverObject(WdfDeviceGetDriver(Device)),
         PowerIoRegPnPNotification,
         deviceContext,
-        &deviceContext->TouchPowerContext.TouchPowerNotify);
+        &deviceContext->Configuration.TouchPowerContext.TouchPowerNotify);
 
     if (!NT_SUCCESS(status))
     {
@@ -237,14 +237,14 @@ PowerDeInitialize(
         "PowerDeInitialize: Entry"
     );
 
-    if (deviceContext->TouchPowerContext.TouchPowerOpen == TRUE)
+    if (deviceContext->Configuration.TouchPowerContext.TouchPowerOpen == TRUE)
     {
-        WdfIoTargetClose(deviceContext->TouchPowerContext.TouchPowerIOTarget);
+        WdfIoTargetClose(deviceContext->Configuration.TouchPowerContext.TouchPowerIOTarget);
     }
 
-    if (deviceContext->TouchPowerContext.TouchPowerNotify)
+    if (deviceContext->Configuration.TouchPowerContext.TouchPowerNotify)
     {
-        status = IoUnregisterPlugPlayNotificationEx(deviceContext->TouchPowerContext.TouchPowerNotify);
+        status = IoUnregisterPlugPlayNotificationEx(deviceContext->Configuration.TouchPowerContext.TouchPowerNotify);
         if (!NT_SUCCESS(status))
         {
             goto exit;